@@ -17,7 +17,9 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/range.h"
 #include "vcml/core/fifo.h"
+#include "vcml/core/timewheel.h"
 #include "vcml/core/peq.h"
+#include "vcml/core/replay.h"
 #include "vcml/core/command.h"
 #include "vcml/core/module.h"
 #include "vcml/core/component.h"
@@ -49,6 +51,10 @@
 #include "vcml/debugging/loader.h"
 #include "vcml/debugging/subscriber.h"
 #include "vcml/debugging/suspender.h"
+#include "vcml/debugging/profiler.h"
+#include "vcml/debugging/coverage.h"
+#include "vcml/debugging/bbtrace.h"
+#include "vcml/debugging/startup.h"
 #include "vcml/debugging/rspserver.h"
 #include "vcml/debugging/gdbarch.h"
 #include "vcml/debugging/gdbserver.h"
@@ -147,6 +153,7 @@
 #include "vcml/models/meta/loader.h"
 #include "vcml/models/meta/simdev.h"
 #include "vcml/models/meta/throttle.h"
+#include "vcml/models/meta/cosim.h"
 
 #include "vcml/models/opencores/ompic.h"
 #include "vcml/models/opencores/ockbd.h"
@@ -16,40 +16,115 @@
 
 namespace vcml {
 
+// Fixed-capacity ring buffer; storage is allocated once on construction or
+// resize, bulk push and pop copy at most two contiguous chunks each.
 template <typename T>
 class fifo
 {
 private:
-    size_t m_capacity;
-    std::queue<T> m_queue;
+    size_t m_head;
+    size_t m_used;
+    vector<T> m_data;
+
+    template <typename FN>
+    void chunks(size_t pos, size_t n, FN&& fn) const;
 
 public:
-    fifo(size_t capacity): m_capacity(capacity), m_queue() {}
+    fifo(size_t capacity): m_head(0), m_used(0), m_data(capacity) {}
     ~fifo() = default;
 
-    size_t capacity() const { return m_capacity; }
-    size_t num_used() const { return m_queue.size(); }
-    size_t num_free() const { return m_capacity - m_queue.size(); }
+    size_t capacity() const { return m_data.size(); }
+    size_t num_used() const { return m_used; }
+    size_t num_free() const { return m_data.size() - m_used; }
+
+    bool empty() const { return m_used == 0; }
+    bool full() const { return m_used == m_data.size(); }
 
-    bool empty() const { return m_queue.empty(); }
-    bool full() const { return m_queue.size() == m_capacity; }
+    const T& front() const { return m_data[m_head]; }
 
     T pop() {
-        T top = m_queue.front();
-        m_queue.pop();
+        if (empty())
+            return T();
+        T top = m_data[m_head];
+        m_head = (m_head + 1) % m_data.size();
+        m_used--;
         return top;
     }
 
     bool push(const T& val) {
-        if (m_queue.size() >= m_capacity)
+        if (full())
             return false;
-        m_queue.push(val);
+        m_data[(m_head + m_used) % m_data.size()] = val;
+        m_used++;
         return true;
     }
 
-    void reset() { std::queue<T>().swap(m_queue); }
+    size_t push(const T* vals, size_t n);
+    size_t pop(T* vals, size_t n);
+    size_t drop(size_t n);
+
+    void resize(size_t capacity); // keeps the oldest elements that fit
+    void reset() { m_head = m_used = 0; }
 };
 
+template <typename T>
+template <typename FN>
+void fifo<T>::chunks(size_t pos, size_t n, FN&& fn) const {
+    size_t first = min(n, m_data.size() - pos);
+    fn(pos, 0, first);
+    if (first < n)
+        fn(0, first, n - first);
+}
+
+template <typename T>
+size_t fifo<T>::push(const T* vals, size_t n) {
+    n = min(n, num_free());
+    if (n == 0)
+        return 0;
+
+    size_t tail = (m_head + m_used) % m_data.size();
+    chunks(tail, n, [&](size_t pos, size_t off, size_t len) {
+        std::copy(vals + off, vals + off + len, m_data.begin() + pos);
+    });
+
+    m_used += n;
+    return n;
+}
+
+template <typename T>
+size_t fifo<T>::pop(T* vals, size_t n) {
+    n = min(n, m_used);
+    if (n == 0)
+        return 0;
+
+    chunks(m_head, n, [&](size_t pos, size_t off, size_t len) {
+        std::copy(m_data.begin() + pos, m_data.begin() + pos + len,
+                  vals + off);
+    });
+
+    return drop(n);
+}
+
+template <typename T>
+size_t fifo<T>::drop(size_t n) {
+    n = min(n, m_used);
+    if (n > 0) {
+        m_head = (m_head + n) % m_data.size();
+        m_used -= n;
+    }
+
+    return n;
+}
+
+template <typename T>
+void fifo<T>::resize(size_t capacity) {
+    vector<T> data(capacity);
+    size_t n = pop(data.data(), min(m_used, capacity));
+    m_data.swap(data);
+    m_head = 0;
+    m_used = n;
+}
+
 } // namespace vcml
 
 #endif
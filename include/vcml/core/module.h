@@ -31,6 +31,11 @@ private:
     bool cmd_abort(const vector<string>& args, ostream& os);
     bool cmd_version(const vector<string>& args, ostream& os);
 
+protected:
+    virtual void before_end_of_elaboration() override;
+    virtual void end_of_elaboration() override;
+    virtual void start_of_simulation() override;
+
 public:
     property<bool> trace_all;
     property<bool> trace_errors;
@@ -13,21 +13,53 @@
 
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
+#include "vcml/core/timewheel.h"
 
 namespace vcml {
 
+// Payloads must be hashable and comparable, since every pending notification
+// is indexed by its payload; this allows cancel to unlink all notifications
+// of a payload directly instead of searching all pending groups for it.
 template <typename T>
 class peq : public sc_object
 {
 private:
+    struct group;
+
+    // linked into its group in notification order and into the chain of all
+    // pending notifications of the same payload
+    struct entry {
+        T payload;
+        group* owner;
+        entry* prev;
+        entry* next;
+        entry* prev_same;
+        entry* next_same;
+    };
+
+    struct group : timewheel::node {
+        entry* head = nullptr;
+        entry* tail = nullptr;
+        group* prev_ready = nullptr;
+        group* next_ready = nullptr;
+        bool ready = false;
+    };
+
     sc_event m_event;
-    std::multimap<sc_time, T> m_schedule;
+    timewheel m_wheel;
+    unordered_map<u64, group*> m_groups;
+    unordered_map<T, entry*> m_entries;
+    group* m_ready_head;
+    group* m_ready_tail;
 
     void update();
+    void fetch();
+    void remove(entry* e);
+    void release(group* g);
 
 public:
     peq(const char* nm);
-    virtual ~peq() = default;
+    virtual ~peq();
     VCML_KIND(peq);
 
     void notify(const T& payload, double t, sc_time_unit tu);
@@ -38,22 +70,95 @@ public:
 
 template <typename T>
 inline void peq<T>::update() {
-    if (m_schedule.empty()) {
+    if (m_ready_head != nullptr) {
+        m_event.notify(SC_ZERO_TIME);
+    } else if (m_wheel.empty()) {
         m_event.cancel();
     } else {
-        sc_time next = m_schedule.begin()->first;
-        m_event.notify(next - sc_time_stamp());
+        u64 next = m_wheel.next_timeout();
+        u64 now = sc_time_stamp().value();
+        if (next > now)
+            m_event.notify(time_from_value(next - now));
+        else
+            m_event.notify(SC_ZERO_TIME);
+    }
+}
+
+template <typename T>
+inline void peq<T>::fetch() {
+    vector<timewheel::node*> expired;
+    m_wheel.advance(sc_time_stamp().value(), expired);
+    for (timewheel::node* node : expired) {
+        group* g = static_cast<group*>(node);
+        g->ready = true;
+        g->prev_ready = m_ready_tail;
+        (m_ready_tail ? m_ready_tail->next_ready : m_ready_head) = g;
+        m_ready_tail = g;
+    }
+}
+
+template <typename T>
+inline void peq<T>::remove(entry* e) {
+    group* g = e->owner;
+    (e->prev ? e->prev->next : g->head) = e->next;
+    (e->next ? e->next->prev : g->tail) = e->prev;
+
+    if (e->next_same)
+        e->next_same->prev_same = e->prev_same;
+    if (e->prev_same)
+        e->prev_same->next_same = e->next_same;
+    else if (e->next_same)
+        m_entries[e->payload] = e->next_same;
+    else
+        m_entries.erase(e->payload);
+
+    delete e;
+
+    if (g->head == nullptr)
+        release(g);
+}
+
+template <typename T>
+inline void peq<T>::release(group* g) {
+    if (g->ready) {
+        (g->prev_ready ? g->prev_ready->next_ready : m_ready_head) =
+            g->next_ready;
+        (g->next_ready ? g->next_ready->prev_ready : m_ready_tail) =
+            g->prev_ready;
+    } else {
+        m_wheel.remove(g);
     }
+
+    m_groups.erase(g->timeout);
+    delete g;
 }
 
 template <typename T>
 inline peq<T>::peq(const char* nm):
     sc_object(nm),
     m_event(mkstr("%s_event", basename()).c_str()),
-    m_schedule() {
+    m_wheel(),
+    m_groups(),
+    m_entries(),
+    m_ready_head(nullptr),
+    m_ready_tail(nullptr) {
     // nothing to do
 }
 
+template <typename T>
+inline peq<T>::~peq() {
+    for (auto& it : m_groups) {
+        entry* e = it.second->head;
+        while (e != nullptr) {
+            entry* next = e->next;
+            delete e;
+            e = next;
+        }
+
+        delete it.second;
+    }
+}
+
 template <typename T>
 inline void peq<T>::notify(const T& payload, double t, sc_time_unit tu) {
     notify(payload, sc_time(t, tu));
@@ -61,36 +166,60 @@ inline void peq<T>::notify(const T& payload, double t, sc_time_unit tu) {
 
 template <typename T>
 inline void peq<T>::notify(const T& payload, const sc_time& delta) {
-    sc_time t = sc_time_stamp() + delta;
-    auto range = m_schedule.equal_range(t);
-    for (auto it = range.first; it != range.second; it++)
-        if (it->second == payload)
+    u64 t = (sc_time_stamp() + delta).value();
+
+    entry*& first = m_entries[payload];
+    for (entry* e = first; e != nullptr; e = e->next_same) {
+        if (e->owner->timeout == t)
             return;
+    }
+
+    group*& g = m_groups[t];
+    if (g == nullptr) {
+        g = new group();
+        m_wheel.insert(g, t);
+    }
+
+    entry* e = new entry{ payload, g, g->tail, nullptr, nullptr, first };
+    (g->tail ? g->tail->next : g->head) = e;
+    g->tail = e;
+
+    if (first != nullptr)
+        first->prev_same = e;
+    first = e;
 
-    m_schedule.emplace(t, payload);
     update();
 }
 
 template <typename T>
 inline void peq<T>::cancel(const T& payload) {
-    if (m_schedule.empty())
+    auto it = m_entries.find(payload);
+    if (it == m_entries.end())
         return;
 
-    mwr::stl_remove(m_schedule, payload);
+    entry* e = it->second;
+    while (e != nullptr) {
+        entry* next = e->next_same;
+        remove(e);
+        e = next;
+    }
+
     update();
 }
 
 template <typename T>
 inline void peq<T>::wait(T& obj) {
-    auto it = m_schedule.find(sc_time_stamp());
-    while (it == m_schedule.end()) {
+    fetch();
+    while (m_ready_head == nullptr) {
         sc_core::wait(m_event);
-        it = m_schedule.find(sc_time_stamp());
+        fetch();
         update();
     }
 
-    obj = it->second;
-    m_schedule.erase(it);
+    entry* e = m_ready_head->head;
+    obj = e->payload;
+    remove(e);
+
     update();
 }
 
@@ -28,8 +28,17 @@ class reg_base;
 class peripheral : public component
 {
 private:
+    struct shadow {
+        address_space as;
+        range addr;
+        vector<u8> data;
+    };
+
     int m_current_cpu;
     unordered_map<address_space, vector<reg_base*>> m_registers;
+    vector<shadow> m_shadows;
+
+    void update_shadow(shadow& s);
 
     bool cmd_mmap(const vector<string>& args, ostream& os);
 
@@ -57,6 +66,9 @@ public:
     int current_cpu() const { return m_current_cpu; }
     void set_current_cpu(int cpu) { m_current_cpu = cpu; }
 
+    sc_time access_time_stamp();
+    bool sync_horizon(const sc_time& horizon);
+
     void aligned_accesses_only(bool only = true);
     void aligned_accesses_only(address_space as, bool only = true);
 
@@ -86,6 +98,14 @@ public:
     void map_dmi(const tlm_dmi& dmi);
     void map_dmi(unsigned char* ptr, u64 start, u64 end, vcml_access a);
 
+    // Exposes the given address range as read-only DMI backed by a shadow
+    // copy of its registers, which all must be shadowable. Writes still go
+    // through TLM and refresh the shadow if they hit it. Call update_shadows
+    // after changing shadowed registers any other way, e.g. from callbacks
+    // of registers outside of the shadow range.
+    void map_shadow(const range& addr, address_space as = VCML_AS_DEFAULT);
+    void update_shadows();
+
     virtual unsigned int transport(tlm_generic_payload& tx,
                                    const tlm_sbi& info,
                                    address_space as) override;
@@ -14,6 +14,7 @@
 #include "vcml/core/types.h"
 #include "vcml/core/range.h"
 #include "vcml/core/component.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/logging/logger.h"
 #include "vcml/properties/property.h"
@@ -23,6 +24,9 @@
 
 #include "vcml/debugging/target.h"
 #include "vcml/debugging/gdbserver.h"
+#include "vcml/debugging/profiler.h"
+#include "vcml/debugging/coverage.h"
+#include "vcml/debugging/bbtrace.h"
 
 namespace vcml {
 
@@ -35,6 +39,31 @@ struct irq_stats {
     sc_time irq_longest;
 };
 
+// Counts interrupt latencies in power-of-two buckets: bucket 0 holds all
+// latencies below 1ns, bucket n those between 2^(n-1)ns and 2^n ns.
+struct irq_histogram {
+    static constexpr size_t NBUCKETS = 48;
+
+    u64 count;
+    sc_time total;
+    sc_time longest;
+    u64 buckets[NBUCKETS];
+
+    irq_histogram();
+    void record(const sc_time& latency);
+    sc_time average() const;
+    void write(ostream& os, const string& name) const;
+};
+
+struct quantum_stats {
+    sc_time quantum;
+    u64 windows;
+    u64 syncs;
+    u64 grown;
+    u64 shrunk;
+    sc_time irq_latency_max;
+};
+
 class processor : public component, public debugging::target
 {
 private:
@@ -42,6 +71,30 @@ private:
     u64 m_cycle_count;
 
     debugging::gdbserver* m_gdb;
+    debugging::profiler* m_profiler;
+    u64 m_profile_last;
+
+    debugging::coverage* m_coverage;
+    debugging::bbtrace* m_bbtrace;
+
+    quantum_stats m_qstats;
+    sc_time m_qwindow;
+    u64 m_qsyncs;
+    atomic<u64> m_irq_raised;
+
+    struct irq_update {
+        u64 irq;
+        u64 state;
+        u64 vector;
+    };
+
+    mutable mutex m_irq_mtx;
+    vector<irq_update> m_irq_pending;
+    vector<gpio_origin> m_irq_origins;
+    irq_histogram m_irq_hist;
+    unordered_map<const sc_object*, irq_histogram> m_irq_sources;
+    replay_channel m_irq_replay;
+    u64 m_irq_cycles;
 
     unordered_map<size_t, irq_stats> m_irq_stats;
     unordered_map<u64, property<void>*> m_regprops;
@@ -54,6 +107,10 @@ private:
     bool cmd_v2p(const vector<string>& args, ostream& os);
     bool cmd_stack(const vector<string>& args, ostream& os);
     bool cmd_gdb(const vector<string>& args, ostream& os);
+    bool cmd_profile(const vector<string>& args, ostream& os);
+    bool cmd_coverage(const vector<string>& args, ostream& os);
+    bool cmd_quantum(const vector<string>& args, ostream& os);
+    bool cmd_irq_latency(const vector<string>& args, ostream& os);
 
     virtual bool read_cpureg_dbg(const debugging::cpureg& reg, void* buf,
                                  size_t len) override;
@@ -61,6 +118,15 @@ private:
                                   size_t len) override;
 
     void sample_callstack();
+    void sample_profile();
+
+    void quantum_bounds(sc_time& lo, sc_time& hi) const;
+    void resize_quantum(const sc_time& quantum);
+    void update_quantum(u64 cycles, u64 syncs);
+    void update_irq_latency(const sc_time& raised);
+    void update_irq_histograms(const sc_time& now);
+    void write_irq_histograms(ostream& os) const;
+    size_t replay_interrupts(size_t cycles);
 
     u64 simulate_cycles(size_t cycles);
     void processor_thread();
@@ -79,9 +145,26 @@ public:
     property<bool> async;
     property<unsigned int> async_rate;
     property<int> async_affinity;
+    property<string> async_domain;
+    property<bool> async_deterministic;
 
     property<bool> trace_callstack;
 
+    property<sc_time> profile_interval;
+    property<string> profile_output;
+
+    property<size_t> bbtrace_batch;
+    property<string> bbtrace_output;
+
+    property<size_t> coverage_size;
+    property<string> coverage_shm;
+
+    property<bool> quantum_adaptive;
+    property<sc_time> quantum_min;
+    property<sc_time> quantum_max;
+    property<sc_time> irq_latency;
+    property<string> irq_histograms;
+
     gpio_target_array irq;
 
     tlm_initiator_socket insn;
@@ -106,6 +189,15 @@ public:
 
     bool get_irq_stats(size_t irq, irq_stats& stats) const;
 
+    const debugging::profiler* get_profiler() const { return m_profiler; }
+    debugging::coverage* get_coverage() const { return m_coverage; }
+
+    sc_time current_quantum() const;
+    const quantum_stats& get_quantum_stats() const { return m_qstats; }
+
+    const irq_histogram& get_irq_histogram() const { return m_irq_hist; }
+    bool get_irq_histogram(const sc_object& src, irq_histogram& hist) const;
+
     template <typename T>
     inline tlm_response_status fetch(u64 addr, T& data);
 
@@ -32,12 +32,14 @@ private:
     vcml_access m_access;
     bool m_rsync;
     bool m_wsync;
+    bool m_tderived;
     bool m_wback;
     bool m_aligned;
     bool m_secure;
     u64 m_privilege;
     u64 m_minsize;
     u64 m_maxsize;
+    sc_time m_horizon;
     peripheral* m_host;
 
     tlm_response_status check_access(const tlm_generic_payload& tx,
@@ -80,6 +82,20 @@ public:
     void sync_always() { m_rsync = m_wsync = true; }
     void sync_never() { m_rsync = m_wsync = false; }
 
+    // Time-derived registers compute their read value from the local time
+    // of the initiator instead of synchronizing it first. Reads only cause
+    // a sync once that local time reaches the time horizon, which should be
+    // set to the next pending event that changes state visible to the guest.
+    bool is_time_derived() const { return m_tderived; }
+    void time_derived(bool td = true) { m_tderived = td; }
+
+    // Shadowable registers can be read without side effects and may thus be
+    // served from a read-only DMI shadow page, see peripheral::map_shadow.
+    virtual bool is_shadowable() const;
+
+    const sc_time& get_time_horizon() const { return m_horizon; }
+    void set_time_horizon(const sc_time& t) { m_horizon = t; }
+
     bool is_writeback() const { return m_wback; }
     void writeback(bool wb = true) { m_wback = wb; }
     void no_writeback() { m_wback = false; }
@@ -191,6 +207,8 @@ public:
 
     virtual void reset() override;
 
+    virtual bool is_shadowable() const override;
+
     virtual void do_read(const range& addr, void* ptr, bool dbg) override;
     virtual void do_write(const range& addr, const void*, bool dbg) override;
 
@@ -455,6 +473,11 @@ void reg<DATA, N>::reset() {
     }
 }
 
+template <typename DATA, size_t N>
+bool reg<DATA, N>::is_shadowable() const {
+    return reg_base::is_shadowable() && !m_banked && !m_read && !m_read_tagged;
+}
+
 template <typename DATA, size_t N>
 void reg<DATA, N>::do_read(const range& txaddr, void* ptr, bool debug) {
     range addr(txaddr);
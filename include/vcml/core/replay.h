@@ -0,0 +1,87 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_CORE_REPLAY_H
+#define VCML_CORE_REPLAY_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+enum replay_mode {
+    REPLAY_OFF = 0,
+    REPLAY_RECORD = 1,
+    REPLAY_PLAYBACK = 2,
+};
+
+replay_mode replay_get_mode();
+
+// Starts recording all replay channels into the given log file, or loads a
+// previously recorded log for playback. Both must happen before simulation
+// starts; replay_finish flushes the log and reports unconsumed events.
+// Besides the model channels, async workers record the order in which their
+// sc_sync requests complete and playback enforces that order again. How far
+// async processors run ahead between two sync points (sc_progress) is not
+// recorded, so only models that interact with async processors through
+// sc_sync or recorded interrupts are reproduced exactly.
+void replay_record(const string& path);
+void replay_playback(const string& path);
+void replay_finish();
+
+struct replay_event {
+    u64 stamp;
+    vector<u8> data;
+};
+
+// A replay channel logs the events that one model receives from the host,
+// e.g. serial input or network frames, together with a stamp that tells
+// when they took effect, usually the simulation time. During playback, the
+// model takes its events from the channel instead of the host, which must
+// happen at the same stamps to reproduce the recorded run.
+class replay_channel
+{
+private:
+    string m_name;
+    u64 m_id;
+    u64 m_stamp;
+    deque<replay_event>* m_queue;
+
+    deque<replay_event>* queue();
+
+public:
+    const char* name() const { return m_name.c_str(); }
+
+    bool is_recording() const { return replay_get_mode() == REPLAY_RECORD; }
+    bool is_replaying() const { return replay_get_mode() == REPLAY_PLAYBACK; }
+    bool is_active() const { return replay_get_mode() != REPLAY_OFF; }
+
+    replay_channel(const string& name);
+    replay_channel(const replay_channel&) = delete;
+    ~replay_channel();
+
+    void record(u64 stamp, const void* data, size_t size);
+    void record(const void* data, size_t size);
+
+    bool peek(u64& stamp);
+    bool fetch(u64& stamp, vector<u8>& data);
+
+    // waits until the next event is due and returns it, or returns false
+    // immediately if the channel holds no more events
+    bool wait_fetch(vector<u8>& data);
+};
+
+inline void replay_channel::record(const void* data, size_t size) {
+    record(sc_time_stamp().value(), data, size);
+}
+
+} // namespace vcml
+
+#endif
@@ -38,6 +38,7 @@ private:
     mwr::option<bool> m_log_errors_only;
     mwr::option<bool> m_log_stdout;
     mwr::option<bool> m_log_inscight;
+    mwr::option<bool> m_log_deferred;
     mwr::option<string> m_log_files;
 
     mwr::option<bool> m_trace_stdout;
@@ -66,6 +67,7 @@ public:
     bool is_logging_debug() const { return m_log_debug; }
     bool is_logging_errors_only() const { return m_log_errors_only; }
     bool is_logging_stdout() const { return m_log_stdout; }
+    bool is_logging_deferred() const { return m_log_deferred; }
     bool is_tracing_stdout() const { return m_trace_stdout; }
 
     const vector<string>& log_files() const;
@@ -14,6 +14,7 @@
 #include "vcml/core/types.h"
 #include "vcml/core/module.h"
 #include "vcml/core/register.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/debugging/vspserver.h"
 
@@ -23,6 +24,7 @@ class system : public module
 {
 private:
     void timeout();
+    void startup_done();
 
 public:
     property<string> name;
@@ -37,6 +39,11 @@ public:
     property<sc_time> quantum;
     property<sc_time> duration;
 
+    property<string> record;
+    property<string> replay;
+
+    property<string> startup_profile;
+
     system() = delete;
     system(const system&) = delete;
     explicit system(const sc_module_name& name);
@@ -25,6 +25,7 @@
 #include <tlm_utils/simple_target_socket.h>
 
 #include "vcml/core/types.h"
+#include "vcml/core/timewheel.h"
 
 #define SYSTEMC_VERSION_2_3_0a 20120701 // NOLINT
 #define SYSTEMC_VERSION_2_3_1a 20140417 // NOLINT
@@ -348,9 +349,10 @@ void on_each_time_step(function<void(void)> callback);
 class async_timer
 {
 public:
-    struct event {
+    struct event : timewheel::node {
         async_timer* owner;
         sc_time timeout;
+        event* pending;
     };
 
     size_t count() const { return m_triggers; }
@@ -382,16 +384,28 @@ private:
     function<void(async_timer&)> m_cb;
 };
 
-void sc_async(function<void(void)> job, int affinity = -1);
+// deterministic jobs run in lockstep with the SystemC thread: it sleeps while
+// the job executes until the job calls sc_sync or releases its domain
+void sc_async(function<void(void)> job, int affinity = -1,
+              const string& domain = "", bool deterministic = false);
 void sc_progress(const sc_time& delta);
+// called on async threads with their current time stamp whenever they make
+// progress, e.g. to pace them against the host clock; set before simulation
+void sc_set_async_pacer(function<void(const sc_time&)> pacer);
 void sc_sync(function<void(void)> job);
 void sc_join_async();
 
+void sc_release_domain();
+void sc_acquire_domain();
+
 bool sc_is_async();
 
 sc_time async_time_stamp();
 sc_time async_time_offset();
 
+// number of times the current async thread had to wait for SystemC
+u64 async_sync_count();
+
 bool is_thread(sc_process_b* proc = nullptr);
 bool is_method(sc_process_b* proc = nullptr);
 
@@ -0,0 +1,79 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_TIMEWHEEL_H
+#define VCML_TIMEWHEEL_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// Hierarchical timing wheel with intrusive nodes. Each level resolves BITS
+// bits of the 64bit timeout, so that insertion and removal are O(1). Entries
+// are moved down one or more levels lazily when the wheel advances into
+// their slot. Timeouts are absolute and given in arbitrary ticks, typically
+// sc_time::value(). The wheel does not own its nodes.
+class timewheel
+{
+public:
+    static constexpr size_t BITS = 6;
+    static constexpr size_t SLOTS = 1ull << BITS;
+    static constexpr size_t LEVELS = (64 + BITS - 1) / BITS;
+
+    struct node {
+        node* prev;
+        node* next;
+        u64 timeout;
+        u32 level;
+        u32 slot;
+        bool scheduled;
+
+        node():
+            prev(nullptr),
+            next(nullptr),
+            timeout(0),
+            level(0),
+            slot(0),
+            scheduled(false) {}
+
+        bool is_scheduled() const { return scheduled; }
+    };
+
+private:
+    u64 m_now;
+    size_t m_count;
+    u64 m_used[LEVELS];
+    node* m_slots[LEVELS][SLOTS];
+
+    void link(node* n);
+    void unlink(node* n);
+    void set_now(u64 now);
+
+public:
+    u64 now() const { return m_now; }
+    size_t count() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    timewheel();
+    ~timewheel() = default;
+
+    timewheel(const timewheel&) = delete;
+    timewheel& operator=(const timewheel&) = delete;
+
+    void insert(node* n, u64 timeout);
+    void remove(node* n);
+
+    u64 next_timeout() const;
+    void advance(u64 now, vector<node*>& expired);
+};
+
+} // namespace vcml
+
+#endif
@@ -23,6 +23,7 @@
 #include <bitset>
 #include <iterator>
 #include <algorithm>
+#include <numeric>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_DEBUGGING_BBTRACE_H
+#define VCML_DEBUGGING_BBTRACE_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/debugging/subscriber.h"
+#include "vcml/debugging/target.h"
+
+namespace vcml {
+namespace debugging {
+
+// Writes the basic blocks executed by a target into a compact binary file.
+// Each block is stored as the zigzag-encoded distance of its address to the
+// end of the previous block, followed by its size and instruction count,
+// all as LEB128 variable length integers. Fall-through and short branches
+// therefore usually take three bytes per block.
+class bbtrace : public subscriber
+{
+private:
+    target& m_target;
+    ofstream m_file;
+    vector<u8> m_buffer;
+    u64 m_next;
+    u64 m_blocks;
+
+    void record(u64 pc, u64 size, u64 icount);
+
+public:
+    target& owner() const { return m_target; }
+    u64 blocks() const { return m_blocks; }
+
+    bbtrace(target& tgt, const string& path);
+    virtual ~bbtrace();
+
+    void flush();
+
+    virtual void notify_basic_block(target& tgt, u64 pc, size_t blksz,
+                                    size_t icount) override;
+    virtual void notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                     size_t count) override;
+
+    static bool load(const string& path, vector<basic_block>& blocks);
+};
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
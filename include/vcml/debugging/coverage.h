@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_DEBUGGING_COVERAGE_H
+#define VCML_DEBUGGING_COVERAGE_H
+
+#include "vcml/core/types.h"
+#include "vcml/protocols/tlm_memory.h"
+
+#include "vcml/debugging/subscriber.h"
+#include "vcml/debugging/target.h"
+
+namespace vcml {
+namespace debugging {
+
+// AFL-style coverage bitmap: every transition between two basic blocks
+// increments a byte counter indexed by the hashes of both block addresses.
+// If a shared memory name is given, the bitmap is placed in that shared
+// memory object, where fuzzers can inspect it while the simulation runs.
+class coverage : public subscriber
+{
+private:
+    target& m_target;
+    tlm_memory m_bitmap;
+    u64 m_mask;
+    u64 m_prev;
+
+    void hit(u64 pc);
+
+public:
+    target& owner() const { return m_target; }
+
+    u8* bitmap() const { return m_bitmap.data(); }
+    size_t size() const { return m_bitmap.size(); }
+
+    bool is_shared() const { return m_bitmap.is_shared(); }
+    const char* shared_name() const { return m_bitmap.shared_name(); }
+
+    coverage(target& tgt, size_t size, const string& shared = "");
+    virtual ~coverage();
+
+    size_t count() const;
+    void reset();
+
+    virtual void notify_basic_block(target& tgt, u64 pc, size_t blksz,
+                                    size_t icount) override;
+    virtual void notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                     size_t count) override;
+};
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
@@ -0,0 +1,57 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_DEBUGGING_PROFILER_H
+#define VCML_DEBUGGING_PROFILER_H
+
+#include "vcml/core/types.h"
+
+#include "vcml/debugging/symtab.h"
+#include "vcml/debugging/target.h"
+
+namespace vcml {
+namespace debugging {
+
+struct profile_entry {
+    string name;
+    u64 self;
+    u64 total;
+};
+
+// Aggregates sampled guest call stacks per function and as folded stacks,
+// i.e. one line per unique call stack "outer;...;inner <count>", which is
+// the input format of common flamegraph tools.
+class profiler
+{
+private:
+    mutable mutex m_mtx;
+    u64 m_samples;
+    unordered_map<string, u64> m_stacks;
+    unordered_map<string, profile_entry> m_functions;
+
+public:
+    profiler();
+    ~profiler() = default;
+
+    u64 samples() const;
+
+    void reset();
+    void sample(const vector<stackframe>& frames, u64 weight = 1);
+
+    vector<profile_entry> top(size_t limit) const;
+
+    void write_folded(ostream& os) const;
+    void write_top(ostream& os, size_t limit) const;
+};
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
@@ -30,12 +30,15 @@ private:
 
     atomic<bool> m_echo;
     atomic<bool> m_running;
+    atomic<time_t> m_idle_ms;
 
     mutex m_mutex;
     thread m_thread;
 
     std::map<string, handler> m_handlers;
 
+    bool poll_packet();
+
     // disabled
     rspserver();
     rspserver(const rspserver&);
@@ -51,11 +54,16 @@ public:
 
     void echo(bool e = true) { m_echo = e; }
 
+    // 0: block until the next packet arrives, otherwise handle_idle is
+    // invoked whenever no packet arrived within the given time
+    void set_idle_timeout(time_t ms) { m_idle_ms = ms; }
+
     rspserver(u16 port);
     virtual ~rspserver();
 
     void send_packet(const string& s);
     void send_packet(const char* format, ...);
+    void send_notification(const string& s);
     string recv_packet();
     int recv_signal(time_t timeoutms = ~0ull);
 
@@ -70,6 +78,7 @@ public:
     virtual string handle_command(const string& command);
     virtual void handle_connect(const char* peer);
     virtual void handle_disconnect();
+    virtual void handle_idle();
 
     template <typename T>
     void register_handler(const char* cmd, string (T::*func)(const string&));
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_DEBUGGING_STARTUP_H
+#define VCML_DEBUGGING_STARTUP_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+namespace debugging {
+
+struct startup_entry {
+    string name;
+    string phase;
+    string detail;
+    double start;
+    double total;
+    double self;
+    i64 alloc;
+    bool background;
+};
+
+// Records host wall time and heap allocations of everything that happens
+// before simulation starts: model construction, elaboration callbacks, image
+// and symbol loading and backend creation. Scoped operations nest, whereas
+// elaboration callbacks are measured as the time between the callbacks of
+// consecutive modules, since SystemC invokes them back-to-back.
+class startup_profiler
+{
+private:
+    static atomic<bool> s_enabled;
+
+    mutable mutex m_mtx;
+    double m_origin;
+    vector<startup_entry> m_entries;
+    vector<size_t> m_stack;
+    vector<i64> m_allocs;
+    bool m_checkpoint;
+
+    void pop(double now, i64 heap);
+
+public:
+    static bool enabled() { return s_enabled; }
+
+    startup_profiler();
+    ~startup_profiler() = default;
+
+    void enable();
+    void disable();
+    void finish();
+
+    size_t begin(const string& name, const string& phase,
+                 const string& detail = "");
+    void end(size_t id, const string& name = "");
+    void checkpoint(const string& name, const string& phase);
+
+    // records work that finished on another thread; such entries do not
+    // nest with scopes and are left out of the phase totals
+    void record(const string& name, const string& phase, double start,
+                const string& detail = "");
+
+    vector<startup_entry> entries() const;
+
+    void write_report(ostream& os, size_t limit) const;
+    void write_trace(ostream& os) const;
+
+    static startup_profiler& instance();
+};
+
+// Profiles the enclosing scope if startup profiling is enabled, otherwise
+// construction and destruction boil down to a single flag test.
+class startup_scope
+{
+private:
+    size_t m_id;
+    string m_name;
+
+public:
+    startup_scope(const char* name, const char* phase,
+                  const char* detail = "");
+    ~startup_scope();
+
+    void rename(const char* name);
+};
+
+inline startup_scope::startup_scope(const char* name, const char* phase,
+                                    const char* detail):
+    m_id(SIZE_MAX), m_name() {
+    if (startup_profiler::enabled())
+        m_id = startup_profiler::instance().begin(name, phase, detail);
+}
+
+inline void startup_scope::rename(const char* name) {
+    if (m_id != SIZE_MAX)
+        m_name = name;
+}
+
+inline startup_scope::~startup_scope() {
+    if (m_id != SIZE_MAX)
+        startup_profiler::instance().end(m_id, m_name);
+}
+
+} // namespace debugging
+} // namespace vcml
+
+#endif
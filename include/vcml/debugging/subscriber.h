@@ -24,6 +24,12 @@ class target;
 class breakpoint;
 class watchpoint;
 
+struct basic_block {
+    u64 pc;
+    u32 size;
+    u32 icount;
+};
+
 class subscriber
 {
 public:
@@ -34,6 +40,11 @@ public:
     virtual void notify_basic_block(target& tgt, u64 pc, size_t blksz,
                                     size_t icount);
 
+    // receives batched basic block traces, by default forwards each block
+    // to notify_basic_block individually
+    virtual void notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                     size_t count);
+
     virtual void notify_breakpoint_hit(const breakpoint& bp);
 
     virtual void notify_watchpoint_read(const watchpoint& wp,
@@ -61,6 +61,61 @@ public:
     range memory() const { return { m_virt, m_virt + m_size - 1 }; }
 };
 
+// Immutable symbol table of one ELF file, shared among all targets that use
+// the same file. Symbols are kept in flat arrays sorted by address and an
+// open addressing hash table indexes their names. Parsing happens once,
+// either on a worker thread after calling prefetch() or upon first use.
+class symfile
+{
+private:
+    string m_path;
+    string m_error;
+    u64 m_count;
+
+    vector<symbol> m_functions;
+    vector<symbol> m_objects;
+    vector<u32> m_function_names;
+    vector<u32> m_object_names;
+
+    mutable std::once_flag m_once;
+    mutable mutex m_mtx;
+    atomic<bool> m_ready;
+    thread m_worker;
+
+    void build();
+    void load() const;
+
+    static void index(const vector<symbol>& syms, const vector<u32>& order,
+                      vector<u32>& names);
+    static const symbol* lookup(const vector<symbol>& syms,
+                                const vector<u32>& names, const string& name);
+    static const symbol* lookup(const vector<symbol>& syms, u64 addr);
+
+public:
+    const char* path() const { return m_path.c_str(); }
+    bool is_ready() const { return m_ready; }
+
+    symfile(const string& path);
+    symfile(const symfile&) = delete;
+    ~symfile();
+
+    void prefetch();
+
+    const string& error() const;
+    u64 count() const;
+
+    const vector<symbol>& functions() const;
+    const vector<symbol>& objects() const;
+
+    const symbol* find_function(const string& name) const;
+    const symbol* find_function(u64 addr) const;
+
+    const symbol* find_object(const string& name) const;
+    const symbol* find_object(u64 addr) const;
+
+    static shared_ptr<symfile> open(const string& path);
+};
+
 class symtab
 {
 public:
@@ -72,14 +127,14 @@ public:
 
     typedef std::set<symbol, symbol_compare> symset;
 
-    size_t count_functions() const { return m_functions.size(); }
-    size_t count_objects() const { return m_objects.size(); }
+    size_t count_functions() const;
+    size_t count_objects() const;
 
     size_t count() const { return count_functions() + count_objects(); }
     bool empty() const { return count() == 0; }
 
-    const symset& functions() const { return m_functions; }
-    const symset& objects() const { return m_objects; }
+    symset functions() const;
+    symset objects() const;
 
     symtab() = default;
     ~symtab() = default;
@@ -99,8 +154,10 @@ public:
     const symbol* find_object(u64 addr) const;
 
     void merge(const symtab&);
+    void attach(const shared_ptr<symfile>& file);
 
     u64 load_elf(const string& filename);
+    void load_elf_async(const string& filename);
 
 private:
     std::set<symbol, symbol_compare> m_functions;
@@ -109,6 +166,8 @@ private:
     unordered_map<string, const symbol*> m_function_names;
     unordered_map<string, const symbol*> m_object_names;
 
+    vector<shared_ptr<symfile>> m_files;
+
     void insert_function(const symbol& sym);
     void insert_object(const symbol& sym);
 
@@ -86,6 +86,8 @@ private:
 
     vector<subscriber*> m_steppers;
     vector<subscriber*> m_bbtracer;
+    vector<basic_block> m_bbbatch;
+    size_t m_bbbatch_size;
 
     vector<breakpoint*> m_breakpoints;
     vector<watchpoint*> m_watchpoints;
@@ -132,6 +134,7 @@ public:
 
     const symtab& symbols() const;
     u64 load_symbols_from_elf(const string& file);
+    void load_symbols_from_elf_async(const string& file);
 
     const char* target_name() const { return m_name.c_str(); }
 
@@ -191,6 +194,13 @@ public:
     bool trace_basic_blocks(subscriber* subscr);
     bool untrace_basic_blocks(subscriber* subscr);
 
+    // Batched basic block tracing collects up to size blocks before passing
+    // them to subscribers at once; processors also flush pending blocks at
+    // the end of each quantum. Zero notifies subscribers per block.
+    size_t basic_block_batch() const { return m_bbbatch_size; }
+    void set_basic_block_batch(size_t size);
+    void flush_basic_blocks();
+
     static vector<target*> all();
     static target* find(const string& name);
 };
@@ -223,6 +233,10 @@ inline u64 target::load_symbols_from_elf(const string& file) {
     return m_symbols.load_elf(file);
 }
 
+inline void target::load_symbols_from_elf_async(const string& file) {
+    m_symbols.load_elf_async(file);
+}
+
 inline const vector<breakpoint*>& target::breakpoints() const {
     return m_breakpoints;
 }
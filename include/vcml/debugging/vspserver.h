@@ -19,6 +19,9 @@
 #include "vcml/debugging/subscriber.h"
 
 namespace vcml {
+
+class processor;
+
 namespace debugging {
 
 class vspserver : public rspserver, private suspender, private subscriber
@@ -30,6 +33,45 @@ private:
 
     unordered_map<u64, const breakpoint*> m_breakpoints;
 
+    enum probe_kind {
+        PROBE_ATTR,
+        PROBE_REG,
+        PROBE_CYCLES,
+        PROBE_CPS,
+        PROBE_IRQ,
+    };
+
+    struct probe {
+        probe_kind kind;
+        sc_attr_base* attr;
+        const cpureg* reg;
+        processor* cpu;
+        size_t irq;
+    };
+
+    struct subscription {
+        u64 id;
+        bool host_time;
+        u64 period;
+        u64 next;
+        vector<probe> probes;
+    };
+
+    mutex m_telemetry_mtx;
+    atomic<bool> m_telemetry;
+    u64 m_next_subscription;
+    vector<subscription> m_subscriptions;
+    deque<string> m_updates;
+
+    u64 m_list_hash;
+    string m_list_xml;
+    string m_list_json;
+
+    bool parse_probe(const string& desc, probe& p, string& err) const;
+    string read_probe(const probe& p) const;
+
+    void sample_telemetry();
+
     string handle_version(const string& command);
     string handle_status(const string& command);
     string handle_resume(const string& command);
@@ -50,6 +92,9 @@ private:
     string handle_vapa(const string& command);
     string handle_vread(const string& command);
     string handle_vwrite(const string& command);
+    string handle_xread(const string& command);
+    string handle_subscribe(const string& command);
+    string handle_unsubscribe(const string& command);
 
     bool is_running() const { return !is_suspending(); }
 
@@ -78,6 +123,7 @@ public:
 
     virtual void handle_connect(const char* peer) override;
     virtual void handle_disconnect() override;
+    virtual void handle_idle() override;
 
     static vspserver* instance();
 };
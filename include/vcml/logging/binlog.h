@@ -0,0 +1,109 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_LOGGING_BINLOG_H
+#define VCML_LOGGING_BINLOG_H
+
+#include "vcml/core/types.h"
+
+namespace vcml {
+
+// In binary logging mode, log calls only store the format string pointer,
+// the raw arguments, the SystemC time, the source location and the sender
+// into a per-thread ring buffer. Formatting and publishing happens later in
+// a background thread.
+enum binlog_tag : u8 {
+    BINLOG_SINT = 0,
+    BINLOG_UINT = 1,
+    BINLOG_REAL = 2,
+    BINLOG_PTR = 3,
+    BINLOG_STR = 4,
+};
+
+// the upper nibble of each tag holds the size of the argument after default
+// argument promotion, so that rendering can narrow it again like printf
+constexpr u8 BINLOG_TYPE_MASK = 0xf;
+constexpr unsigned int BINLOG_SIZE_SHIFT = 4;
+
+constexpr size_t BINLOG_MAX_STRLEN = 256;
+
+extern atomic<bool> g_binlog_enabled;
+
+inline bool binlog_enabled() {
+    return g_binlog_enabled.load(std::memory_order_relaxed);
+}
+
+void binlog_enable(bool enable = true);
+void binlog_flush();
+bool binlog_replay_time(u64& timestamp);
+
+string binlog_render(const char* format, const u8* args, size_t size);
+
+void binlog_commit(const mwr::logger& sender, log_level lvl, const char* file,
+                   int line, const char* format, const u8* args, size_t size);
+
+template <typename T>
+inline void binlog_encode_raw(vector<u8>& buf, binlog_tag tag, const T& val,
+                              size_t width = sizeof(T)) {
+    size_t pos = buf.size();
+    buf.resize(pos + 1 + sizeof(val));
+    buf[pos] = tag | (u8)(width << BINLOG_SIZE_SHIFT);
+    memcpy(buf.data() + pos + 1, &val, sizeof(val));
+}
+
+inline void binlog_encode_str(vector<u8>& buf, const char* str) {
+    if (str == nullptr)
+        str = "(null)";
+
+    size_t len = strnlen(str, BINLOG_MAX_STRLEN);
+    size_t pos = buf.size();
+    buf.resize(pos + 2 + len);
+    buf[pos] = BINLOG_STR;
+    memcpy(buf.data() + pos + 1, str, len);
+    buf[pos + 1 + len] = '\0';
+}
+
+template <typename T>
+inline void binlog_encode(vector<u8>& buf, const T& val) {
+    using U = std::decay_t<T>;
+    constexpr size_t width = max(sizeof(U), sizeof(int));
+    if constexpr (std::is_enum_v<U>) {
+        binlog_encode(buf, (std::underlying_type_t<U>)val);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        binlog_encode_raw(buf, BINLOG_SINT, (i64)val, width);
+    } else if constexpr (std::is_integral_v<U>) {
+        binlog_encode_raw(buf, BINLOG_UINT, (u64)val, width);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        binlog_encode_raw(buf, BINLOG_REAL, (double)val);
+    } else if constexpr (std::is_same_v<U, char*> ||
+                         std::is_same_v<U, const char*>) {
+        binlog_encode_str(buf, val);
+    } else if constexpr (std::is_pointer_v<U> ||
+                         std::is_null_pointer_v<U>) {
+        binlog_encode_raw(buf, BINLOG_PTR, (u64)(uintptr_t)val);
+    } else {
+        static_assert(std::is_pointer_v<U>, "unsupported log argument");
+    }
+}
+
+template <typename... ARGS>
+inline void binlog_record(const mwr::logger& sender, log_level lvl,
+                          const char* file, int line, const char* format,
+                          const ARGS&... args) {
+    static thread_local vector<u8> buffer;
+    buffer.clear();
+    (binlog_encode(buffer, args), ...);
+    binlog_commit(sender, lvl, file, line, format, buffer.data(),
+                  buffer.size());
+}
+
+} // namespace vcml
+
+#endif
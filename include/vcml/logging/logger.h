@@ -13,6 +13,33 @@
 
 #include "vcml/core/types.h"
 #include "vcml/core/systemc.h"
+#include "vcml/logging/binlog.h"
+
+// log calls above this level are removed at compile time, including the
+// evaluation of their arguments; e.g. -DVCML_MAX_LOG_LEVEL=LOG_INFO
+#ifndef VCML_MAX_LOG_LEVEL
+#define VCML_MAX_LOG_LEVEL LOG_DEBUG
+#endif
+
+#define VCML_LOG_ENABLED(lvl) ((lvl) <= ::mwr::VCML_MAX_LOG_LEVEL)
+
+// arguments are wrapped into a lambda, so that they are only evaluated if
+// the logger actually accepts messages of the given level
+#define VCML_LOG_CALL(lvl, ...)                                          \
+    log->*::vcml::make_log_call<lvl>(__FILE__, __LINE__,                \
+                                     [&](const auto& _vcml_log_sink) { \
+                                         _vcml_log_sink(__VA_ARGS__);  \
+                                     })
+
+#undef log_error
+#undef log_warn
+#undef log_info
+#undef log_debug
+
+#define log_error(...) VCML_LOG_CALL(::mwr::LOG_ERROR, __VA_ARGS__)
+#define log_warn(...) VCML_LOG_CALL(::mwr::LOG_WARN, __VA_ARGS__)
+#define log_info(...) VCML_LOG_CALL(::mwr::LOG_INFO, __VA_ARGS__)
+#define log_debug(...) VCML_LOG_CALL(::mwr::LOG_DEBUG, __VA_ARGS__)
 
 namespace vcml {
 
@@ -30,10 +57,57 @@ public:
 
     logger(logger&&) = default;
     logger(const logger&) = default;
+    virtual ~logger();
 };
 
 extern logger log;
 
+// In binary logging mode, info and debug messages are deferred. Errors and
+// warnings are published immediately, after all pending messages.
+template <log_level LVL>
+struct log_sink {
+    mwr::logger& sender;
+    const char* file;
+    int line;
+
+    template <typename... ARGS>
+    void operator()(const char* format, const ARGS&... args) const {
+        if constexpr (LVL > LOG_WARN) {
+            if (binlog_enabled()) {
+                binlog_record(sender, LVL, file, line, format, args...);
+                return;
+            }
+        } else {
+            if (binlog_enabled())
+                binlog_flush();
+        }
+
+        sender.log(LVL, file, line, format, args...);
+    }
+};
+
+template <log_level LVL, typename FN>
+struct log_call {
+    const char* file;
+    int line;
+    FN fn;
+};
+
+template <log_level LVL, typename FN>
+inline log_call<LVL, FN> make_log_call(const char* file, int line, FN fn) {
+    return { file, line, fn };
+}
+
+template <log_level LVL, typename FN>
+inline void operator->*(const mwr::logger& lg, const log_call<LVL, FN>& call) {
+    if constexpr (VCML_LOG_ENABLED(LVL)) {
+        if (lg.can_log(LVL)) {
+            mwr::logger& sender = const_cast<mwr::logger&>(lg);
+            call.fn(log_sink<LVL>{ sender, call.file, call.line });
+        }
+    }
+}
+
 } // namespace vcml
 
 #endif
@@ -380,6 +380,7 @@ public:
     };
 
     property<bool> secure;
+    property<bool> deferred_update;
 
     distif distif;
     cpuif cpuif;
@@ -449,9 +450,14 @@ private:
 
     irq_state m_irq_state[NIRQ + NRES];
 
+    sc_event m_update_ev;
+
+    void update_deferred();
+
     pair<size_t, u32> get_highest_pend_irq(size_t cpu, bool virt);
     u8 get_prio_mask(u32 n, bool alias, bool virt);
     pair<bool, bool> update_excp_state(size_t cpu, size_t& irq, bool virt);
+    gpio_origin irq_origin(size_t cpu, size_t irq);
 };
 
 inline gpio_target_socket& gic400::ppi(size_t cpu, size_t irq) {
@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/properties/property.h"
 #include "vcml/protocols/can.h"
@@ -35,6 +36,7 @@ private:
     mutable mutex m_mtx;
     queue<can_frame> m_rx;
     sc_event m_ev;
+    replay_channel m_replay;
 
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
@@ -43,6 +45,7 @@ private:
     virtual void can_receive(can_frame& frame) override;
 
     void can_transmit();
+    void can_replay();
 
     static unordered_map<string, bridge*>& bridges();
 
@@ -16,23 +16,65 @@
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
 
+#include "vcml/properties/property.h"
 #include "vcml/protocols/can.h"
 
 namespace vcml {
 namespace can {
 
+// In timed mode, frames are not forwarded immediately. Instead, all frames
+// pending when the bus becomes idle are arbitrated by their identifier and
+// the winner is delivered to all other nodes once its transmission, based on
+// frame format, payload length and (data phase) bitrate, has completed.
 class bus : public module, public can_host
 {
+public:
+    struct node_stats {
+        u64 tx_frames;
+        u64 rx_frames;
+        u64 tx_bits;
+        u64 arb_lost;
+        u64 errors;
+        sc_time busy;
+    };
+
 protected:
     size_t m_next_id;
 
+    struct pending {
+        can_frame frame;
+        size_t node;
+        u32 key;
+        u64 seq;
+    };
+
+    vector<pending> m_pending;
+    pending m_current;
+    bool m_transmitting;
+    u64 m_seq;
+
+    sc_time m_busy;
+    sc_event m_ev;
+
+    unordered_map<size_t, node_stats> m_stats;
+
     const can_initiator_socket& peer_of(const can_target_socket& rx) const {
         return can_tx[can_rx.index_of(rx)];
     }
 
+    void deliver(can_frame& frame, size_t node);
+    void transmit();
+
     void can_receive(const can_target_socket&, can_frame& frame) override;
 
+    bool cmd_stats(const vector<string>& args, ostream& os);
+
 public:
+    property<bool> timed;
+    property<u64> bitrate;
+    property<u64> data_bitrate;
+    property<bool> stuffing;
+
     can_initiator_array can_tx;
     can_target_array can_rx;
 
@@ -46,6 +88,15 @@ public:
     void connect(DEVICE& device) {
         bind(device.can_tx, device.can_rx);
     }
+
+    size_t frame_bits(const can_frame& frame, size_t& data_bits) const;
+    sc_time frame_duration(const can_frame& frame) const;
+
+    const node_stats& stats(size_t node) { return m_stats[node]; }
+    sc_time busy_time() const { return m_busy; }
+    double bus_load() const;
+
+    static u32 arbitration_key(const can_frame& frame);
 };
 
 } // namespace can
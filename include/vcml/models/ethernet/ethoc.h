@@ -63,6 +63,9 @@ private:
     void tx_poll();
     void rx_poll();
 
+    bool tx_next();
+    bool rx_next();
+
     bool tx_packet(u32 addr, u32 size);
     bool rx_packet(u32 addr, u32& size);
 
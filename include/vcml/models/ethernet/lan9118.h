@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/range.h"
 #include "vcml/core/model.h"
+#include "vcml/core/fifo.h"
 #include "vcml/core/peripheral.h"
 
 #include "vcml/protocols/tlm.h"
@@ -149,18 +150,17 @@ private:
 
     packet m_tx_pkt;
     deque<packet> m_tx_packets;
-    deque<u32> m_tx_status_fifo;
+    size_t m_tx_packets_dw;
+    fifo<u32> m_tx_status_fifo;
 
-    deque<u32> m_rx_data_fifo;
-    deque<u32> m_rx_status_fifo;
+    fifo<u32> m_rx_data_fifo;
+    fifo<u32> m_rx_status_fifo;
+    vector<u32> m_rx_words;
 
     void reset_fifo_size(size_t txff_size);
 
     size_t tx_data_used() const {
-        size_t ndw = m_tx_pkt.used_dw;
-        for (const auto& pkt : m_tx_packets)
-            ndw += pkt.used_dw;
-        return ndw;
+        return (m_tx_pkt.used_dw + m_tx_packets_dw) * 4;
     }
 
     size_t tx_data_free() const {
@@ -169,7 +169,9 @@ private:
 
     size_t tx_data_level() const { return ((fifo_int >> 24) & 0xff) * 64; }
 
-    size_t tx_status_used() const { return m_tx_status_fifo.size() * 4; }
+    size_t tx_status_used() const {
+        return m_tx_status_fifo.num_used() * 4;
+    }
 
     size_t tx_status_free() const {
         return m_tx_status_fifo_size - tx_status_used();
@@ -177,7 +179,9 @@ private:
 
     size_t tx_status_level() const { return ((fifo_int >> 16) & 0xff) * 4; }
 
-    size_t rx_status_used() const { return m_rx_status_fifo.size() * 4; }
+    size_t rx_status_used() const {
+        return m_rx_status_fifo.num_used() * 4;
+    }
 
     size_t rx_status_free() const {
         return m_rx_status_fifo_size - rx_status_used();
@@ -185,7 +189,9 @@ private:
 
     size_t rx_status_level() const { return (fifo_int & 0xff) * 4; }
 
-    size_t rx_data_used() const { return m_rx_data_fifo.size() * 4; }
+    size_t rx_data_used() const {
+        return m_rx_data_fifo.num_used() * 4;
+    }
 
     size_t rx_data_free() const {
         return m_rx_data_fifo_size - rx_data_used();
@@ -208,6 +214,9 @@ private:
     void rx_thread();
     void tx_thread();
 
+    size_t rx_data_pop(u32* data, size_t count);
+    void tx_data_push(const u32* data, size_t count);
+
     u32 read_rx_data_fifo();
     void write_tx_data_fifo(u32 val);
 
@@ -296,6 +305,10 @@ public:
 
     void update_irq();
 
+    virtual unsigned int transport(tlm_generic_payload& tx,
+                                   const tlm_sbi& info,
+                                   address_space as) override;
+
 protected:
     virtual void eth_link_up() override;
     virtual void eth_link_down() override;
@@ -29,11 +29,14 @@ private:
     tlm_memory m_memory;
 
     bool cmd_show(const vector<string>& args, ostream& os);
+    void check_image(u64 size, u64 offset) const;
 
     memory();
     memory(const memory&);
 
 protected:
+    virtual void load_bin(const string& filename, u64 offset) override;
+
     virtual u8* allocate_image(u64 size, u64 offset) override;
     virtual void copy_image(const u8* img, u64 size, u64 offset) override;
 
@@ -44,7 +47,13 @@ public:
     property<bool> readonly;
     property<string> shared;
     property<vector<string>> images;
+    property<bool> map_images;
+    property<bool> clear_on_reset;
     property<u8> poison;
+    property<string> hugepages;
+    property<bool> prefault;
+    property<int> numa_node;
+    property<bool> numa_interleave;
 
     tlm_target_socket in;
 
@@ -64,6 +73,10 @@ public:
                                      const tlm_sbi& info) override;
     virtual tlm_response_status write(const range& addr, const void* data,
                                       const tlm_sbi& info) override;
+
+    virtual bool get_direct_mem_ptr(tlm_target_socket& origin,
+                                    tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override;
 };
 
 } // namespace generic
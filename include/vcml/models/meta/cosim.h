@@ -0,0 +1,154 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#ifndef VCML_META_COSIM_H
+#define VCML_META_COSIM_H
+
+#include "vcml/core/types.h"
+#include "vcml/core/range.h"
+#include "vcml/core/systemc.h"
+#include "vcml/core/thctl.h"
+#include "vcml/core/component.h"
+#include "vcml/core/model.h"
+
+#include "vcml/logging/logger.h"
+#include "vcml/properties/property.h"
+
+#include "vcml/protocols/tlm.h"
+#include "vcml/protocols/gpio.h"
+#include "vcml/protocols/eth.h"
+#include "vcml/protocols/can.h"
+
+namespace vcml {
+namespace meta {
+
+// Connects two simulations running in separate host processes via a pair of
+// lock-free ring buffers in POSIX shared memory. Transactions received on the
+// target side (in, gpio_in, eth_rx, can_rx) are forwarded to the peer, which
+// replays them on its initiator side (out, gpio_out, eth_tx, can_tx). Both
+// simulations are kept within one quantum of each other.
+class cosim : public component, public eth_host, public can_host
+{
+private:
+    struct shm_header;
+    struct shm_ring;
+
+    struct mapping {
+        void* base;
+        size_t size;
+    };
+
+    int m_fd;
+    int m_side;
+    size_t m_shmsz;
+    shm_header* m_shm;
+    shm_ring* m_tx;
+    shm_ring* m_rx;
+
+    u64 m_next_id;
+    size_t m_max_data;
+    sc_time m_quantum;
+
+    unordered_map<u64, vector<u8>> m_responses;
+    deque<vector<u8>> m_deferred;
+    sc_event m_replay_ev;
+    bool m_debug;
+    unordered_map<string, mapping> m_mappings;
+    vector<range> m_nodmi;
+
+    void connect();
+    void disconnect();
+    void wait_peer();
+
+    u64 peer_time() const;
+    void publish_time(const sc_time& t);
+
+    bool ring_push(shm_ring* ring, const void* msg, size_t len);
+    bool ring_pop(shm_ring* ring, vector<u8>& msg);
+
+    bool timed_out(u64 start) const;
+
+    bool send(vector<u8>& msg);
+    bool poll();
+    bool receive(u64 id, vector<u8>& rsp);
+    void handle(vector<u8>& msg);
+
+    void handle_tlm(vector<u8>& msg);
+    void handle_dmi(const vector<u8>& msg);
+    void handle_dmi_invalidate(const vector<u8>& msg);
+    void handle_gpio(const vector<u8>& msg);
+    void handle_eth(const vector<u8>& msg);
+    void handle_can(const vector<u8>& msg);
+
+    u8* map_remote(const string& name, u64 offset, u64 size);
+    void unmap_remote();
+
+    tlm_response_status forward(tlm_generic_payload& tx, const tlm_sbi& info,
+                                unsigned int& bytes, sc_time& latency);
+
+    void sync();
+    void replay();
+
+public:
+    property<string> channel;
+    property<size_t> ring_size;
+    property<sc_time> quantum;
+    property<unsigned int> timeout; // ms, zero waits forever
+
+    tlm_target_socket in;
+    tlm_initiator_socket out;
+
+    gpio_target_array gpio_in;
+    gpio_initiator_array gpio_out;
+
+    eth_initiator_socket eth_tx;
+    eth_target_socket eth_rx;
+
+    can_initiator_socket can_tx;
+    can_target_socket can_rx;
+
+    cosim(const sc_module_name& nm);
+    virtual ~cosim();
+    VCML_KIND(meta::cosim);
+
+    bool is_connected() const { return m_shm != nullptr; }
+    bool is_creator() const { return m_side == 0; }
+    bool peer_attached() const;
+    bool peer_finished() const;
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& info) override;
+
+    virtual bool get_direct_mem_ptr(tlm_target_socket& origin,
+                                    tlm_generic_payload& tx,
+                                    tlm_dmi& dmi) override;
+
+    virtual void invalidate_direct_mem_ptr(tlm_initiator_socket& origin,
+                                           u64 start, u64 end) override;
+
+protected:
+    virtual void gpio_notify(const gpio_target_socket& socket, bool state,
+                             gpio_vector vector) override;
+
+    virtual void eth_receive(const eth_target_socket& socket,
+                             const eth_frame& frame) override;
+
+    virtual void can_receive(const can_target_socket& socket,
+                             can_frame& frame) override;
+
+    virtual void end_of_elaboration() override;
+    virtual void end_of_simulation() override;
+};
+
+} // namespace meta
+} // namespace vcml
+
+#endif
@@ -24,25 +24,70 @@ namespace meta {
 
 class throttle : public module
 {
+public:
+    struct stats {
+        u64 intervals;
+        u64 throttled;
+        u64 credit_drops;
+        double rtf_last;
+        double rtf_min;
+        double rtf_max;
+        double rtf_avg;
+        sc_time total_sleep;
+        sc_time max_overshoot;
+        sc_time drift;
+        sc_time total_drift;
+    };
+
 private:
     bool m_throttling;
 
     u64 m_start;
     u64 m_extra;
 
+    // precise mode: wall clock deadlines in ns relative to these origins
+    atomic<u64> m_host_origin;
+    atomic<u64> m_sim_origin;
+    atomic<double> m_rtf;
+    u64 m_host_last;
+    sc_time m_sim_last;
+    u64 m_suspended;
+    u64 m_sum_host;
+    u64 m_sum_sim;
+    u64 m_dropped;
+
+    stats m_stats;
+
+    u64 deadline(const sc_time& t) const;
+    void sleep_until(u64 deadline);
+    void rebase(u64 host, const sc_time& sim);
+
     void update();
+    void update_coarse(const sc_time& interval);
+    void update_precise();
+
+    void pace_async(const sc_time& t);
+
+    bool cmd_stats(const vector<string>& args, ostream& os);
 
 public:
     property<sc_time> update_interval;
     property<double> rtf;
 
+    property<bool> precise;
+    property<sc_time> spin_window;
+    property<sc_time> burst_credit;
+    property<bool> async_pacing;
+
     throttle(const sc_module_name& nm);
-    virtual ~throttle() = default;
+    virtual ~throttle();
     VCML_KIND(throttle);
 
     bool is_throttling() const { return m_throttling; }
+    const stats& get_stats() const { return m_stats; }
 
 protected:
+    virtual void end_of_elaboration() override;
     virtual void session_suspend() override;
     virtual void session_resume() override;
 };
@@ -29,7 +29,8 @@ private:
     sc_time m_time_reset;
     sc_event m_trigger;
 
-    u64 get_cycles() const;
+    u64 get_cycles(const sc_time& t) const;
+    u64 get_cycles() const { return get_cycles(sc_time_stamp()); }
 
     u64 read_mtime();
     void write_mtimecmp(u64 val, size_t hart);
@@ -90,8 +90,11 @@ private:
 
     void notify(size_t irq, bool level);
 
+    sc_event m_update_ev;
+
     void update();
     void update(irqinfo* irq);
+    void update_deferred();
 
     void send_msi(u32 hart, u32 guest, u32 eiid);
     void send_irq(u32 hart);
@@ -111,6 +114,7 @@ public:
     };
 
     property<bool> mmode;
+    property<bool> deferred_update;
 
     reg<u32> domaincfg;
     reg<u32, NIRQ> sourcecfg;
@@ -60,13 +60,18 @@ private:
     void write_threshold(u32 value, size_t ctxno);
     void write_complete(u32 value, size_t ctxno);
 
+    sc_event m_update_ev;
+
     void update();
+    void update_deferred();
 
     // disabled
     plic();
     plic(const plic&);
 
 public:
+    property<bool> deferred_update;
+
     reg<u32, NIRQ> priority;
     reg<u32, NIRQ / 32> pending;
 
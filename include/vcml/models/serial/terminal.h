@@ -15,6 +15,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/module.h"
 #include "vcml/core/model.h"
+#include "vcml/core/replay.h"
 
 #include "vcml/protocols/serial.h"
 #include "vcml/properties/property.h"
@@ -43,6 +44,7 @@ private:
     unordered_map<size_t, backend*> m_backends;
     vector<backend*> m_listeners;
     sc_event m_async_ev;
+    replay_channel m_replay;
 
     bool cmd_create_backend(const vector<string>& args, ostream& os);
     bool cmd_destroy_backend(const vector<string>& args, ostream& os);
@@ -50,6 +52,7 @@ private:
     bool cmd_history(const vector<string>& args, ostream& os);
 
     void serial_transmit();
+    void serial_replay();
 
     virtual void serial_receive(u8 data) override;
 
@@ -42,6 +42,7 @@ private:
 
     drive_mode m_mode;
     vector<u8> m_output;
+    size_t m_outpos;
     size_t m_len;
     u8 m_cmd;
     u8 m_sts;
@@ -95,6 +95,20 @@ public:
         ~runtime_regs() = default;
     };
 
+    struct ready_ep {
+        u64 mfindex;
+        u32 slotid;
+        u32 epid;
+
+        bool operator>(const ready_ep& other) const {
+            if (mfindex != other.mfindex)
+                return mfindex > other.mfindex;
+            if (slotid != other.slotid)
+                return slotid > other.slotid;
+            return epid > other.epid;
+        }
+    };
+
 private:
     sc_time m_mfstart;
 
@@ -108,6 +122,9 @@ private:
 
     devslot m_slots[MAX_SLOTS];
 
+    priority_queue<ready_ep, vector<ready_ep>, std::greater<ready_ep>> m_ready;
+    vector<u8> m_xferbuf;
+
     u64 get_mfindex() const;
 
     u32 read_hcsparams1();
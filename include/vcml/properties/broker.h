@@ -16,8 +16,17 @@
 
 namespace vcml {
 
+class broker_index;
+
+// Keys may contain the wildcards '*' and '?', which match within a single
+// hierarchy level, and '**', which matches any number of levels. Brokers are
+// consulted in order of their registration; within one broker, exact keys
+// take precedence over rules with wildcards, rules with more characters other
+// than '*' over less specific ones and later definitions over earlier ones.
 class broker
 {
+    friend class broker_index;
+
 protected:
     struct value {
         string value;
@@ -25,9 +34,12 @@ protected:
     };
 
     string m_name;
+    size_t m_rank;
+    bool m_dynamic; // lookup() provides values beyond m_values
     std::map<string, struct value> m_values;
 
     string expand(const string& s);
+    void insert(const string& key, const string& val, size_t uses);
 
 public:
     const char* name() const { return m_name.c_str(); }
@@ -70,7 +82,7 @@ inline void broker::define(const string& key, const T& val, size_t uses) {
 template <>
 inline void broker::define(const string& key, const string& val, size_t uses) {
     if (!key.empty())
-        m_values[expand(key)] = { expand(val), uses };
+        insert(expand(key), expand(val), uses);
 }
 
 template <typename T>
@@ -91,10 +103,6 @@ inline void broker::define(const string& key, initializer_list<T> list,
     define(key, expand(ss.str()), uses);
 }
 
-inline void broker::undefine(const string& key) {
-    m_values.erase(key);
-}
-
 template <typename T>
 inline broker* broker::init(const string& key, T& value) {
     string str;
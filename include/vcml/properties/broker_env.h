@@ -15,8 +15,13 @@
 
 namespace vcml {
 
+// Takes a snapshot of the environment at construction; hierarchy separators
+// in property names are looked up as underscores, e.g. system_cpu_async.
 class broker_env : public broker
 {
+private:
+    unordered_map<string, string> m_env;
+
 public:
     broker_env();
     virtual ~broker_env();
@@ -25,6 +25,9 @@ enum gpio_vectors : gpio_vector {
     GPIO_NO_VECTOR = SIZE_MAX,
 };
 
+// vectors below this limit are kept in a dense array instead of a hash map
+constexpr size_t GPIO_DENSE_VECTORS = 64;
+
 struct gpio_payload {
     gpio_vector vector;
     bool state;
@@ -32,6 +35,28 @@ struct gpio_payload {
 
 ostream& operator<<(ostream& os, const gpio_payload& gpio);
 
+// Identifies the socket that first asserted a line and when it did so. It is
+// passed along synchronously while interrupt controllers forward the line, so
+// that CPUs can attribute interrupt latency to the device that caused it.
+struct gpio_origin {
+    const sc_object* source;
+    u64 stamp;
+
+    bool is_valid() const { return source != nullptr; }
+};
+
+const gpio_origin* gpio_current_origin();
+
+class gpio_origin_scope
+{
+private:
+    const gpio_origin* m_prev;
+
+public:
+    gpio_origin_scope(const gpio_origin& origin);
+    ~gpio_origin_scope();
+};
+
 class gpio_fw_transport_if : public sc_core::sc_interface
 {
 public:
@@ -135,6 +160,8 @@ public:
     bool read(gpio_vector vector = GPIO_NO_VECTOR) const;
     operator bool() const { return read(GPIO_NO_VECTOR); }
     void write(bool state, gpio_vector vector = GPIO_NO_VECTOR);
+    void write(bool state, const vector<gpio_vector>& vectors);
+    void write_mask(u64 mask, u64 state, gpio_vector base = 0);
 
     void raise(gpio_vector vector = GPIO_NO_VECTOR);
     void lower(gpio_vector vector = GPIO_NO_VECTOR);
@@ -149,6 +176,8 @@ public:
 private:
     gpio_host* m_host;
     sc_event* m_event;
+    gpio_state_tracker m_novec;
+    gpio_state_tracker m_dense[GPIO_DENSE_VECTORS];
     unordered_map<gpio_vector, gpio_state_tracker> m_state;
 
     struct gpio_bw_transport : public gpio_bw_transport_if {
@@ -161,7 +190,11 @@ private:
         }
     } m_transport;
 
+    gpio_state_tracker* lookup(gpio_vector vector);
+    const gpio_state_tracker* lookup(gpio_vector vector) const;
+
     void gpio_transport(gpio_payload& tx);
+    void gpio_transport(gpio_payload* txs, size_t count);
 };
 
 class gpio_target_socket : public gpio_base_target_socket
@@ -184,9 +217,15 @@ public:
     bool operator==(const gpio_target_socket& o) const;
     bool operator!=(const gpio_target_socket& o) const;
 
+    const gpio_origin& origin() const { return m_origin; }
+
 private:
     gpio_host* m_host;
     sc_event* m_event;
+    u64 m_dense_valid;
+    u64 m_dense_state;
+    int m_novec;
+    gpio_origin m_origin;
     unordered_map<gpio_vector, bool> m_state;
     gpio_base_initiator_socket* m_initiator;
     vector<gpio_base_target_socket*> m_targets;
@@ -205,6 +244,7 @@ private:
         }
     } m_transport;
 
+    bool update_state(const gpio_payload& gpio);
     void gpio_transport_internal(gpio_payload& gpio);
 
 protected:
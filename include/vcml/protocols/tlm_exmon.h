@@ -47,6 +47,88 @@ public:
     bool override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi);
 };
 
+// Reservation of one initiator for an exclusive access performed directly on
+// a DMI pointer; only ever touched by the thread owning the initiator.
+struct dmi_reservation {
+    u8* ptr;
+    u64 data;
+    u64 version;
+    unsigned int size;
+
+    bool is_valid() const { return ptr != nullptr; }
+};
+
+// Global exclusive monitor for accesses made directly on DMI pointers. Host
+// memory is divided into cache lines, each of which hashes into a table of
+// version counters. Exclusive loads remember the version of their line and
+// exclusive stores only succeed if that version is unchanged and the memory
+// still holds the loaded value, in which case the store is carried out using
+// a host compare-and-swap operation. Regular writes through DMI or TLM break
+// the reservations of their lines; writes made directly on host pointers are
+// only detected by the value check and hence subject to ABA. Hash collisions
+// may cause spurious failures, which LL/SC semantics permit. All functions
+// are thread-safe.
+class dmi_exmon
+{
+public:
+    static constexpr size_t LINE_BITS = 6;
+    static constexpr size_t TABLE_BITS = 14;
+
+    static bool is_active() {
+        return s_active.load(std::memory_order_relaxed);
+    }
+
+    static bool can_access(const u8* ptr, unsigned int size);
+
+    static void load_exclusive(dmi_reservation& res, u8* ptr, void* data,
+                               unsigned int size);
+    static bool store_exclusive(dmi_reservation& res, u8* ptr,
+                                const void* data, unsigned int size);
+    static void clear_exclusive(dmi_reservation& res);
+
+    static void break_reservations(const u8* ptr, size_t size);
+
+    // atomically replaces the value at ptr with fn(value) and breaks any
+    // reservations for that cache line; returns the previous value
+    template <typename FN>
+    static u64 atomic_rmw(u8* ptr, unsigned int size, FN&& fn);
+
+private:
+    static atomic<bool> s_active;
+    static atomic<u64> s_lines[1ull << TABLE_BITS];
+
+    static atomic<u64>& line(const u8* ptr);
+
+    static u64 host_load(const u8* ptr, unsigned int size);
+    static bool host_cas(u8* ptr, unsigned int size, u64& expected,
+                         u64 desired);
+};
+
+inline atomic<u64>& dmi_exmon::line(const u8* ptr) {
+    u64 idx = (u64)(uintptr_t)ptr >> LINE_BITS;
+    idx ^= idx >> TABLE_BITS;
+    return s_lines[idx & ((1ull << TABLE_BITS) - 1)];
+}
+
+inline bool dmi_exmon::can_access(const u8* ptr, unsigned int size) {
+    if (size != 1 && size != 2 && size != 4 && size != 8)
+        return false;
+    return ((uintptr_t)ptr & (size - 1)) == 0;
+}
+
+template <typename FN>
+u64 dmi_exmon::atomic_rmw(u8* ptr, unsigned int size, FN&& fn) {
+    VCML_ERROR_ON(!can_access(ptr, size), "invalid atomic access");
+    u64 val = host_load(ptr, size);
+    while (!host_cas(ptr, size, val, fn(val))) {
+        // val has been refreshed by host_cas
+    }
+
+    if (is_active())
+        line(ptr).fetch_add(2, std::memory_order_release);
+    return val;
+}
+
 } // namespace vcml
 
 #endif
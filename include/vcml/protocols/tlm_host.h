@@ -30,7 +30,14 @@ private:
         sc_time time;
         tlm_generic_payload* tx;
         const tlm_sbi* sbi;
-        proc_data(): time(SC_ZERO_TIME), tx(nullptr), sbi(nullptr) {}
+        sc_time quantum;
+        u64 quantum_epoch;
+        proc_data():
+            time(SC_ZERO_TIME),
+            tx(nullptr),
+            sbi(nullptr),
+            quantum(SC_ZERO_TIME),
+            quantum_epoch(0) {}
     };
 
     mutable std::unordered_map<sc_process_b*, proc_data> m_processes;
@@ -80,6 +87,11 @@ public:
     bool needs_sync(sc_process_b* proc = current_process());
     void sync(sc_process_b* proc = current_process());
 
+    // Processes may run with their own quantum instead of the global one,
+    // setting SC_ZERO_TIME reverts a process back to the global quantum.
+    static sc_time process_quantum(sc_process_b* proc = current_process());
+    static void set_process_quantum(sc_process_b* proc, const sc_time& q);
+
     void map_dmi(const tlm_dmi& dmi);
     void map_dmi(unsigned char* ptr, u64 start, u64 end, vcml_access a,
                  const sc_time& read_latency = SC_ZERO_TIME,
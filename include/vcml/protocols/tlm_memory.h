@@ -22,6 +22,13 @@ namespace vcml {
 
 class tlm_memory : public tlm_dmi
 {
+public:
+    enum hugepage_mode {
+        HUGEPAGES_NONE = 0,
+        HUGEPAGES_TRANSPARENT = 1,
+        HUGEPAGES_EXPLICIT = 2,
+    };
+
 private:
     void* m_handle;
     void* m_base;
@@ -29,7 +36,22 @@ private:
     bool m_discard;
     string m_shared;
 
+    u8 m_poison;
+    size_t m_npending;
+    vector<u64> m_pending;
+
+    hugepage_mode m_hugepages;
+    bool m_prefault;
+    int m_numa_node;
+    bool m_numa_interleave;
+
     int init_shared(const string& shared, size_t size);
+    void register_shared();
+    void unregister_shared();
+    void init_policy();
+
+    void release();
+    void resolve(u64 start, u64 end, bool apply);
 
 public:
     u8* data() const { return get_dmi_ptr(); }
@@ -37,12 +59,27 @@ public:
 
     bool is_shared() const { return !m_shared.empty(); }
     const char* shared_name() const { return m_shared.c_str(); }
+    u64 shared_offset(const void* ptr) const;
 
     void allow_read_only() { allow_read(); }
     void allow_write_only() { allow_write(); }
 
     void discard_writes(bool discard = true) { m_discard = discard; }
 
+    // Backing store options, these must be set before init. Explicit huge
+    // pages fall back to transparent ones if none are available; use
+    // hugepages() after init to find out what the memory actually uses.
+    void set_hugepages(hugepage_mode mode) { m_hugepages = mode; }
+    void set_prefault(bool prefault = true) { m_prefault = prefault; }
+    void set_numa_node(int node) { m_numa_node = node; }
+    void set_numa_interleave(bool on = true) { m_numa_interleave = on; }
+
+    hugepage_mode hugepages() const { return m_hugepages; }
+    bool numa_bound() const { return m_numa_node >= 0 || m_numa_interleave; }
+
+    bool has_pending() const { return m_npending > 0; }
+    bool is_pending(u64 offset) const;
+
     tlm_memory();
     tlm_memory(size_t size);
     tlm_memory(size_t size, alignment al);
@@ -57,6 +94,16 @@ public:
     void free();
     void fill(u8 data);
 
+    // Lazily zeroes or poisons the memory in constant time by returning its
+    // pages to the host. Pending pages receive the poison value on their
+    // first access via read, write, touch or operator[]; users of the raw
+    // data pointer (e.g. DMI) must call touch before accessing them.
+    void clear();
+    void poison(u8 val);
+    void touch(const range& addr);
+
+    size_t map_file(const string& path, u64 offset, u64 size);
+
     tlm_response_status fill(u8 data, bool debug);
 
     tlm_response_status read(const range& addr, void* dest,
@@ -75,16 +122,33 @@ public:
 
     u8 operator[](size_t offset) const;
     u8& operator[](size_t offset);
+
+    static const tlm_memory* find_shared(const void* ptr);
 };
 
+inline u64 tlm_memory::shared_offset(const void* ptr) const {
+    VCML_ERROR_ON(!is_shared(), "memory is not shared");
+    return (const u8*)ptr - (const u8*)m_base;
+}
+
 inline void tlm_memory::init(size_t size, alignment al) {
     init("", size, al);
 }
 
 inline void tlm_memory::fill(u8 val) {
+    resolve(0, size() - 1, false);
     memset(data(), val, size());
 }
 
+inline void tlm_memory::clear() {
+    poison(0);
+}
+
+inline void tlm_memory::touch(const range& addr) {
+    if (m_npending > 0)
+        resolve(addr.start, addr.end, true);
+}
+
 template <typename T>
 tlm_response_status tlm_memory::read(u64 addr, T& data, bool dbg) {
     return read({ addr, addr + sizeof(data) - 1 }, &data, dbg);
@@ -98,12 +162,13 @@ tlm_response_status tlm_memory::write(u64 addr, const T& data, bool dbg) {
 inline u8 tlm_memory::operator[](size_t offset) const {
     VCML_ERROR_ON(data() == nullptr, "memory not initialized");
     VCML_ERROR_ON(offset >= size(), "offset out of bounds: %zu", offset);
-    return data()[offset];
+    return is_pending(offset) ? m_poison : data()[offset];
 }
 
 inline u8& tlm_memory::operator[](size_t offset) {
     VCML_ERROR_ON(data() == nullptr, "memory not initialized");
     VCML_ERROR_ON(offset >= size(), "offset out of bounds: %zu", offset);
+    touch({ offset, offset });
     return data()[offset];
 }
 
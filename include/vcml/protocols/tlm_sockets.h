@@ -31,6 +31,18 @@
 
 namespace vcml {
 
+// One element of a batched access. Elements that continue each other both in
+// target and host memory are merged into a single transaction or memcpy. The
+// outcome of each element is reported in resp and bytes.
+struct tlm_batch_op {
+    tlm_command cmd;
+    u64 addr;
+    void* data;
+    unsigned int size;
+    tlm_response_status resp;
+    unsigned int bytes;
+};
+
 class tlm_initiator_socket
     : public simple_initiator_socket<tlm_initiator_socket>,
       public hierarchy_element
@@ -40,6 +52,7 @@ private:
     tlm_generic_payload m_txd;
     tlm_sbi m_sbi;
     tlm_dmi_cache* m_dmi_cache;
+    dmi_reservation m_excl;
     tlm_target_stub* m_stub;
     tlm_host* m_host;
     module* m_parent;
@@ -52,6 +65,9 @@ private:
 
     tlm_generic_payload& allocate_payload(sc_process_b* p = current_process());
 
+    void complete_batch(tlm_batch_op* ops, size_t count,
+                        tlm_response_status rs, unsigned int bytes);
+
 protected:
     virtual void invalidate_direct_mem_ptr(u64 start, u64 end);
 
@@ -59,6 +75,7 @@ public:
     property<bool> trace_all;
     property<bool> trace_errors;
     property<bool> allow_dmi;
+    property<bool> allow_dmi_excl;
 
     int get_cpuid() const { return m_sbi.cpuid; }
     int get_privilege() const { return m_sbi.privilege; }
@@ -87,13 +104,20 @@ public:
 
     tlm_response_status access_dmi(tlm_command c, u64 addr, void* data,
                                    unsigned int size,
-                                   const tlm_sbi& info = SBI_NONE);
+                                   const tlm_sbi& info = SBI_NONE,
+                                   unsigned int* nbytes = nullptr);
 
     tlm_response_status access(tlm_command cmd, u64 addr, void* data,
                                unsigned int size,
                                const tlm_sbi& info = SBI_NONE,
                                unsigned int* nbytes = nullptr);
 
+    tlm_response_status access_batch(tlm_batch_op* ops, size_t count,
+                                     const tlm_sbi& info = SBI_NONE);
+
+    tlm_response_status access_batch(vector<tlm_batch_op>& ops,
+                                     const tlm_sbi& info = SBI_NONE);
+
     tlm_response_status read(u64 addr, void* data, unsigned int size,
                              const tlm_sbi& info = SBI_NONE,
                              unsigned int* nbytes = nullptr);
@@ -163,6 +187,11 @@ inline void tlm_initiator_socket::unmap_dmi(u64 start, u64 end) {
         m_dmi_cache->invalidate(start, end);
 }
 
+inline tlm_response_status tlm_initiator_socket::access_batch(
+    vector<tlm_batch_op>& ops, const tlm_sbi& info) {
+    return access_batch(ops.data(), ops.size(), info);
+}
+
 inline tlm_response_status tlm_initiator_socket::read(u64 addr, void* data,
                                                       unsigned int size,
                                                       const tlm_sbi& info,
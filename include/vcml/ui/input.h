@@ -12,6 +12,7 @@
 #define VCML_UI_INPUT_H
 
 #include "vcml/core/types.h"
+#include "vcml/core/replay.h"
 #include "vcml/logging/logger.h"
 #include "vcml/ui/codes.h"
 #include "vcml/ui/keymap.h"
@@ -37,6 +38,9 @@ private:
 
     mutable mutex m_mutex;
     queue<input_event> m_events;
+    mutable replay_channel m_replay;
+
+    bool fetch_replay(input_event* ev) const;
 
     static unordered_map<string, input*>& all_inputs();
 
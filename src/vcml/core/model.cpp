@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/core/model.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 
@@ -24,8 +25,10 @@ module* model::create(const string& type, const sc_module_name& name) {
 
     auto it = modeldb().find(kind);
     if (it != modeldb().end()) {
+        debugging::startup_scope scope(name, "construct", kind.c_str());
         module* mod(it->second(name, args));
         VCML_ERROR_ON(!mod, "failed to create instance of %s", kind.c_str());
+        scope.rename(mod->name());
         if (kind != mod->kind()) {
             mod->log.warn("module kind mismatch, expected %s, is %s",
                           kind.c_str(), mod->kind());
@@ -11,6 +11,8 @@
 #include "vcml/core/version.h"
 #include "vcml/core/module.h"
 
+#include "vcml/debugging/startup.h"
+
 namespace vcml {
 
 bool module::cmd_clist(const vector<string>& args, ostream& os) {
@@ -40,6 +42,30 @@ bool module::cmd_version(const vector<string>& args, ostream& os) {
     return true;
 }
 
+void module::before_end_of_elaboration() {
+    sc_module::before_end_of_elaboration();
+    if (debugging::startup_profiler::enabled()) {
+        debugging::startup_profiler::instance().checkpoint(
+            name(), "before_end_of_elaboration");
+    }
+}
+
+void module::end_of_elaboration() {
+    sc_module::end_of_elaboration();
+    if (debugging::startup_profiler::enabled()) {
+        debugging::startup_profiler::instance().checkpoint(
+            name(), "end_of_elaboration");
+    }
+}
+
+void module::start_of_simulation() {
+    sc_module::start_of_simulation();
+    if (debugging::startup_profiler::enabled()) {
+        debugging::startup_profiler::instance().checkpoint(
+            name(), "start_of_simulation");
+    }
+}
+
 // clang-format-15 seems to get confused when your class is named 'module', so
 // we need to disable formatting here. If we rename this to module1::module1,
 // no errors are reported. If we rename it back, the errors return...
@@ -42,11 +42,36 @@ bool peripheral::cmd_mmap(const vector<string>& args, ostream& os) {
     return true;
 }
 
+void peripheral::update_shadow(shadow& s) {
+    // registers are sorted by address, so skip straight to the shadow range
+    const vector<reg_base*>& regs = get_registers(s.as);
+    auto it = std::lower_bound(regs.begin(), regs.end(), s.addr.start,
+                               [](const reg_base* reg, u64 addr) -> bool {
+                                   return reg->get_range().end < addr;
+                               });
+
+    for (; it != regs.end(); it++) {
+        reg_base* reg = *it;
+        const range& r = reg->get_range();
+        if (r.start > s.addr.end)
+            break;
+
+        u8* ptr = s.data.data() + r.start - s.addr.start;
+        reg->do_read(range(0, r.length() - 1), ptr, true);
+
+        if (!is_host_endian()) {
+            for (u64 off = 0; off < r.length(); off += reg->get_cell_size())
+                memswap(ptr + off, reg->get_cell_size());
+        }
+    }
+}
+
 peripheral::peripheral(const sc_module_name& nm, endianess default_endian,
                        unsigned int rlatency, unsigned int wlatency):
     component(nm),
     m_current_cpu(SBI_NONE.cpuid),
     m_registers(),
+    m_shadows(),
     endian("endian", default_endian),
     read_latency("read_latency", rlatency),
     write_latency("write_latency", wlatency) {
@@ -58,12 +83,32 @@ peripheral::~peripheral() {
     // nothing to do
 }
 
+sc_time peripheral::access_time_stamp() {
+    if (!in_transaction() || in_debug_transaction())
+        return sc_time_stamp();
+    return local_time_stamp();
+}
+
+bool peripheral::sync_horizon(const sc_time& horizon) {
+    if (!in_transaction() || in_debug_transaction() || !is_thread())
+        return false;
+
+    sc_time now = local_time_stamp();
+    if (now < horizon || now == sc_time_stamp())
+        return false;
+
+    sync();
+    return true;
+}
+
 void peripheral::reset() {
     component::reset();
 
     for (auto& [as, regs] : m_registers)
         for (auto* r : regs)
             r->reset();
+
+    update_shadows();
 }
 
 void peripheral::add_register(reg_base* reg) {
@@ -101,6 +146,44 @@ const vector<reg_base*>& peripheral::get_registers(address_space as) const {
     return it->second;
 }
 
+void peripheral::map_shadow(const range& addr, address_space as) {
+    for (const shadow& s : m_shadows) {
+        if (s.as == as && s.addr.overlaps(addr))
+            VCML_ERROR("shadow %s already mapped", to_string(addr).c_str());
+    }
+
+    for (reg_base* reg : get_registers(as)) {
+        if (!reg->get_range().overlaps(addr))
+            continue;
+
+        if (!reg->get_range().inside(addr))
+            VCML_ERROR("register %s exceeds shadow %s", reg->name(),
+                       to_string(addr).c_str());
+        if (!reg->is_shadowable())
+            VCML_ERROR("register %s cannot be shadowed", reg->name());
+    }
+
+    m_shadows.push_back({ as, addr, vector<u8>(addr.length()) });
+    shadow& s = m_shadows.back();
+    update_shadow(s);
+
+    tlm_dmi dmi;
+    dmi.set_dmi_ptr(s.data.data());
+    dmi.set_start_address(addr.start);
+    dmi.set_end_address(addr.end);
+    dmi.set_read_latency(read_cycles());
+    dmi.set_write_latency(write_cycles());
+    dmi_set_access(dmi, VCML_ACCESS_READ);
+
+    for (tlm_target_socket* socket : find_tlm_target_sockets(as))
+        socket->map_dmi(dmi);
+}
+
+void peripheral::update_shadows() {
+    for (shadow& s : m_shadows)
+        update_shadow(s);
+}
+
 void peripheral::map_dmi(const tlm_dmi& dmi) {
     tlm_dmi copy(dmi);
     copy.set_read_latency(read_cycles());
@@ -171,6 +254,14 @@ unsigned int peripheral::transport(tlm_generic_payload& tx,
     tx.set_byte_enable_ptr(be_ptr);
     tx.set_byte_enable_length(be_length);
 
+    // refresh shadows that were written to, reads cannot change them
+    if (tx.is_write() && !m_shadows.empty()) {
+        for (shadow& s : m_shadows) {
+            if (s.as == as && s.addr.overlaps(tx))
+                update_shadow(s);
+        }
+    }
+
     // check for quantum overshoot
     if (!info.is_debug && needs_sync())
         sync();
@@ -19,6 +19,48 @@
 
 namespace vcml {
 
+static const u64 IRQ_IDLE = ~0ull;
+
+// origins waiting for the processor to run are dropped beyond this limit
+static const size_t IRQ_MAX_ORIGINS = 1024;
+
+irq_histogram::irq_histogram():
+    count(0), total(SC_ZERO_TIME), longest(SC_ZERO_TIME), buckets() {
+    // nothing to do
+}
+
+void irq_histogram::record(const sc_time& latency) {
+    u64 ns = time_to_ns(latency);
+    size_t idx = ns ? min<size_t>(64 - clz(ns), NBUCKETS - 1) : 0;
+
+    count++;
+    total += latency;
+    longest = max(longest, latency);
+    buckets[idx]++;
+}
+
+sc_time irq_histogram::average() const {
+    return count ? total / (double)count : SC_ZERO_TIME;
+}
+
+void irq_histogram::write(ostream& os, const string& name) const {
+    os << name << ": " << count << " interrupts, avg " << average()
+       << ", max " << longest << std::endl;
+
+    char line[64];
+    for (size_t i = 0; i < NBUCKETS; i++) {
+        if (buckets[i] == 0)
+            continue;
+
+        u64 lo = i ? 1ull << (i - 1) : 0;
+        u64 hi = 1ull << i;
+        snprintf(line, sizeof(line), "  %12lluns .. %12lluns %10llu",
+                 (unsigned long long)lo, (unsigned long long)hi,
+                 (unsigned long long)buckets[i]);
+        os << line << std::endl;
+    }
+}
+
 bool processor::cmd_dump(const vector<string>& args, ostream& os) {
     os << "Registers:" << std::endl
        << "  PC 0x" << HEX(program_counter(), 16) << std::endl
@@ -241,6 +283,74 @@ bool processor::cmd_gdb(const vector<string>& args, ostream& os) {
     return true;
 }
 
+bool processor::cmd_profile(const vector<string>& args, ostream& os) {
+    if (m_profiler == nullptr) {
+        os << "profiling disabled, set " << profile_interval.name();
+        return false;
+    }
+
+    if (!args.empty() && args[0] == "reset") {
+        m_profiler->reset();
+        os << "profile reset";
+        return true;
+    }
+
+    size_t limit = args.empty() ? 20 : from_string<size_t>(args[0]);
+    m_profiler->write_top(os, limit);
+    return true;
+}
+
+bool processor::cmd_coverage(const vector<string>& args, ostream& os) {
+    if (m_coverage == nullptr) {
+        os << "coverage disabled, set " << coverage_size.name();
+        return false;
+    }
+
+    if (!args.empty() && args[0] == "reset") {
+        m_coverage->reset();
+        os << "coverage reset";
+        return true;
+    }
+
+    os << m_coverage->count() << " of " << m_coverage->size()
+       << " coverage entries hit";
+    if (m_coverage->is_shared())
+        os << " (shared memory " << m_coverage->shared_name() << ")";
+    return true;
+}
+
+bool processor::cmd_quantum(const vector<string>& args, ostream& os) {
+    const quantum_stats& stats = m_qstats;
+    os << "quantum: " << current_quantum();
+    if (!quantum_adaptive) {
+        os << " (global)";
+        return true;
+    }
+
+    sc_time lo, hi;
+    quantum_bounds(lo, hi);
+    os << " (adaptive " << lo << " .. " << hi << ")" << std::endl
+       << "windows: " << stats.windows << std::endl
+       << "syncs:   " << stats.syncs << std::endl
+       << "grown:   " << stats.grown << std::endl
+       << "shrunk:  " << stats.shrunk << std::endl
+       << "max irq latency: " << stats.irq_latency_max;
+    return true;
+}
+
+bool processor::cmd_irq_latency(const vector<string>& args, ostream& os) {
+    if (!args.empty() && args[0] == "reset") {
+        lock_guard<mutex> guard(m_irq_mtx);
+        m_irq_hist = irq_histogram();
+        m_irq_sources.clear();
+        os << "irq latencies reset";
+        return true;
+    }
+
+    write_irq_histograms(os);
+    return true;
+}
+
 void processor::sample_callstack() {
 #if defined(HAVE_INSCIGHT) && defined(INSCIGHT_CPU_CALL_STACK)
     if (!trace_callstack)
@@ -259,22 +369,198 @@ void processor::sample_callstack() {
 #endif
 }
 
+void processor::sample_profile() {
+    u64 cycles = cycle_count();
+    if (cycles < m_profile_last) // cycle counter has been reset
+        m_profile_last = 0;
+
+    u64 period = max<u64>(profile_interval / clock_cycle(), 1);
+    u64 elapsed = cycles - m_profile_last;
+    if (elapsed < period)
+        return;
+
+    // a sample stands for all intervals that passed since the last one
+    u64 weight = elapsed / period;
+    m_profile_last += weight * period;
+
+    vector<debugging::stackframe> frames;
+    stacktrace(frames);
+    m_profiler->sample(frames, weight);
+}
+
+void processor::quantum_bounds(sc_time& lo, sc_time& hi) const {
+    lo = quantum_min;
+    if (lo == SC_ZERO_TIME)
+        lo = tlm_global_quantum::instance().get();
+    lo = max(lo, clock_cycle());
+
+    hi = quantum_max;
+    if (hi == SC_ZERO_TIME)
+        hi = lo * 16;
+    if (irq_latency > SC_ZERO_TIME)
+        hi = min(hi, irq_latency.get());
+    hi = max(hi, lo);
+}
+
+void processor::resize_quantum(const sc_time& quantum) {
+    sc_time lo, hi;
+    quantum_bounds(lo, hi);
+
+    sc_time q = min(max(quantum, lo), hi);
+    if (q > m_qstats.quantum)
+        m_qstats.grown++;
+    if (q < m_qstats.quantum)
+        m_qstats.shrunk++;
+
+    m_qstats.quantum = q;
+    set_process_quantum(current_process(), q);
+}
+
+void processor::update_quantum(u64 cycles, u64 syncs) {
+    m_qwindow += clock_cycles(cycles);
+    m_qsyncs += syncs;
+    if (m_qwindow < m_qstats.quantum)
+        return;
+
+    m_qstats.windows++;
+    m_qstats.syncs += m_qsyncs;
+
+    // running a whole quantum undisturbed suggests a compute-bound core
+    // that benefits from a longer quantum, whereas a core that is forced
+    // to sync repeatedly gains nothing from it and is held back instead
+    if (m_qsyncs == 0)
+        resize_quantum(m_qstats.quantum * 2);
+    else if (m_qsyncs > 1)
+        resize_quantum(m_qstats.quantum / 2);
+    else
+        resize_quantum(m_qstats.quantum);
+
+    m_qwindow = SC_ZERO_TIME;
+    m_qsyncs = 0;
+}
+
+void processor::update_irq_latency(const sc_time& raised) {
+    sc_time now = sc_is_async() ? async_time_stamp() : local_time_stamp();
+    sc_time latency = now > raised ? now - raised : SC_ZERO_TIME;
+    m_qstats.irq_latency_max = max(m_qstats.irq_latency_max, latency);
+
+    if (quantum_adaptive && irq_latency > SC_ZERO_TIME &&
+        latency > irq_latency) {
+        resize_quantum(m_qstats.quantum / 2);
+    }
+
+    update_irq_histograms(now);
+}
+
+void processor::update_irq_histograms(const sc_time& now) {
+    lock_guard<mutex> guard(m_irq_mtx);
+    for (const gpio_origin& origin : m_irq_origins) {
+        sc_time raised = time_from_value(origin.stamp);
+        sc_time latency = now > raised ? now - raised : SC_ZERO_TIME;
+        m_irq_hist.record(latency);
+        m_irq_sources[origin.source].record(latency);
+    }
+
+    m_irq_origins.clear();
+}
+
+void processor::write_irq_histograms(ostream& os) const {
+    lock_guard<mutex> guard(m_irq_mtx);
+    m_irq_hist.write(os, name());
+
+    std::map<string, const irq_histogram*> sources;
+    for (const auto& [source, hist] : m_irq_sources)
+        sources[source ? source->name() : "unknown"] = &hist;
+    for (const auto& [source, hist] : sources)
+        hist->write(os, source);
+}
+
+size_t processor::replay_interrupts(size_t cycles) {
+    if (m_irq_replay.is_replaying()) {
+        u64 stamp;
+        vector<u8> data;
+        while (m_irq_replay.peek(stamp) && stamp <= m_irq_cycles) {
+            irq_update upd;
+            m_irq_replay.fetch(stamp, data);
+            VCML_ERROR_ON(data.size() != sizeof(upd), "invalid irq replay");
+            memcpy(&upd, data.data(), sizeof(upd));
+            interrupt(upd.irq, upd.state, upd.vector);
+        }
+
+        // end this step exactly when the next interrupt is due
+        if (m_irq_replay.peek(stamp))
+            cycles = min<u64>(cycles, stamp - m_irq_cycles);
+        return cycles;
+    }
+
+    vector<irq_update> pending;
+    {
+        lock_guard<mutex> guard(m_irq_mtx);
+        pending.swap(m_irq_pending);
+    }
+
+    for (const irq_update& upd : pending) {
+        m_irq_replay.record(m_irq_cycles, &upd, sizeof(upd));
+        interrupt(upd.irq, upd.state, upd.vector);
+    }
+
+    return cycles;
+}
+
 u64 processor::simulate_cycles(size_t cycles) {
+    if (m_irq_replay.is_active())
+        cycles = replay_interrupts(cycles);
+
     if (trace_callstack)
         sample_callstack();
 
+    u64 raised = m_irq_raised.exchange(IRQ_IDLE);
+    if (raised != IRQ_IDLE)
+        update_irq_latency(time_from_value(raised));
+
+    // detect syncs forced upon us, e.g. by peripherals or sc_sync requests
+    bool is_async = sc_is_async();
+    u64 syncs = is_async ? async_sync_count() : 0;
+    sc_time now = is_async ? SC_ZERO_TIME : sc_time_stamp();
+
     u64 count = cycle_count();
     double start = mwr::timestamp();
     set_suspendable(false);
     simulate(cycles);
     set_suspendable(true);
     m_run_time += mwr::timestamp() - start;
-    return cycle_count() - count;
+
+    flush_basic_blocks();
+
+    if (m_profiler)
+        sample_profile();
+
+    u64 executed = cycle_count() - count;
+    m_irq_cycles += executed;
+
+    if (quantum_adaptive) {
+        if (is_async)
+            syncs = async_sync_count() - syncs;
+        else
+            syncs = sc_time_stamp() != now ? 1 : 0;
+        update_quantum(executed, syncs);
+    }
+
+    return executed;
 }
 
 void processor::processor_thread() {
     wait(SC_ZERO_TIME);
 
+    if (quantum_adaptive) {
+        sc_time lo, hi;
+        quantum_bounds(lo, hi);
+        m_qstats.quantum = lo;
+        set_process_quantum(current_process(), lo);
+        log_debug("using adaptive quantum between %s and %s",
+                  lo.to_string().c_str(), hi.to_string().c_str());
+    }
+
     bool running = true;
     while (running) {
         sc_time now = local_time_stamp();
@@ -284,7 +570,8 @@ void processor::processor_thread() {
 
         if (async && !is_stepping()) {
             vcml::sc_async([&]() { running = processor_thread_async(); },
-                           async_affinity);
+                           async_affinity, async_domain,
+                           async_deterministic);
         } else {
             running = processor_thread_sync();
         }
@@ -301,7 +588,6 @@ bool processor::processor_thread_async() {
         log_warn("async_rate is larger than 10 - value: %u", async_rate.get());
 
     sc_time& lt = local_time();
-    const sc_time& quantum = tlm::tlm_global_quantum::instance().get();
 
     sc_progress(lt);
     lt = SC_ZERO_TIME;
@@ -310,6 +596,8 @@ bool processor::processor_thread_async() {
         if (!sim_running())
             return false;
 
+        sc_time quantum = current_quantum();
+
         for (sc_time offset = async_time_offset(); offset < quantum;
              offset = async_time_offset()) {
             u64 step_size = (quantum / clock_cycle()) / async_rate;
@@ -332,8 +620,11 @@ bool processor::processor_thread_async() {
             lt = SC_ZERO_TIME;
         }
 
+        // let other processors of our domain run while we wait for SystemC
+        sc_release_domain();
         while (sim_running() && async_time_offset() >= quantum)
             mwr::cpu_yield();
+        sc_acquire_domain();
     }
 }
 
@@ -344,7 +635,7 @@ bool processor::processor_thread_sync() {
             return false;
 
         unsigned int num_cycles = 1;
-        sc_time quantum = tlm_global_quantum::instance().get();
+        sc_time quantum = current_quantum();
         if (quantum > clock_cycle() && quantum > local_time()) {
             sc_time time_left = quantum - local_time();
             num_cycles = time_left / clock_cycle();
@@ -379,6 +670,21 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     m_run_time(0),
     m_cycle_count(0),
     m_gdb(nullptr),
+    m_profiler(nullptr),
+    m_profile_last(0),
+    m_coverage(nullptr),
+    m_bbtrace(nullptr),
+    m_qstats(),
+    m_qwindow(SC_ZERO_TIME),
+    m_qsyncs(0),
+    m_irq_raised(IRQ_IDLE),
+    m_irq_mtx(),
+    m_irq_pending(),
+    m_irq_origins(),
+    m_irq_hist(),
+    m_irq_sources(),
+    m_irq_replay(mkstr("%s.irq", name())),
+    m_irq_cycles(0),
     m_irq_stats(),
     m_regprops(),
     cpuarch("arch", cpuarch),
@@ -390,27 +696,26 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
     async("async", false),
     async_rate("async_rate", 5),
     async_affinity("async_affinity", -1),
+    async_domain("async_domain", ""),
+    async_deterministic("async_deterministic", false),
     trace_callstack("trace_callstack", false),
+    profile_interval("profile_interval", SC_ZERO_TIME),
+    profile_output("profile_output", ""),
+    bbtrace_batch("bbtrace_batch", 0),
+    bbtrace_output("bbtrace_output", ""),
+    coverage_size("coverage_size", 0),
+    coverage_shm("coverage_shm", ""),
+    quantum_adaptive("quantum_adaptive", false),
+    quantum_min("quantum_min", SC_ZERO_TIME),
+    quantum_max("quantum_max", SC_ZERO_TIME),
+    irq_latency("irq_latency", SC_ZERO_TIME),
+    irq_histograms("irq_histograms", ""),
     irq("irq"),
     insn("insn"),
     data("data") {
     SC_HAS_PROCESS(processor);
     SC_THREAD(processor_thread);
 
-    for (const string& s : symbols) {
-        string symfile = trim(s);
-        if (symfile.empty())
-            continue;
-
-        if (!mwr::file_exists(symfile)) {
-            log_warn("cannot open file '%s'", symfile.c_str());
-            continue;
-        }
-
-        u64 n = load_symbols_from_elf(symfile);
-        log_debug("loaded %llu symbols from '%s'", n, symfile.c_str());
-    }
-
     register_command("dump", 0, &processor::cmd_dump,
                      "dump internal state of the processor");
     register_command("read", 3, &processor::cmd_read,
@@ -427,11 +732,35 @@ processor::processor(const sc_module_name& nm, const string& cpuarch):
                      "generates a stack trace for the current function");
     register_command("gdb", 0, &processor::cmd_gdb,
                      "opens a new gdb debug session");
+    register_command("profile", 0, &processor::cmd_profile,
+                     "shows the functions with the most profiling samples, "
+                     "usage: profile [limit|reset]");
+    register_command("coverage", 0, &processor::cmd_coverage,
+                     "shows or resets the basic block coverage bitmap, "
+                     "usage: coverage [reset]");
+    register_command("quantum", 0, &processor::cmd_quantum,
+                     "shows the quantum of this processor and how it "
+                     "adapted to synchronization pressure");
+    register_command("irq_latency", 0, &processor::cmd_irq_latency,
+                     "shows interrupt latency histograms of this processor "
+                     "and each interrupt source, usage: irq_latency [reset]");
+}
+
+sc_time processor::current_quantum() const {
+    if (quantum_adaptive && m_qstats.quantum > SC_ZERO_TIME)
+        return m_qstats.quantum;
+    return tlm_global_quantum::instance().get();
 }
 
 processor::~processor() {
     if (m_gdb)
         delete m_gdb;
+    if (m_coverage)
+        delete m_coverage;
+    if (m_bbtrace)
+        delete m_bbtrace;
+    if (m_profiler)
+        delete m_profiler;
     for (auto reg : m_regprops)
         delete reg.second;
 }
@@ -458,6 +787,17 @@ void processor::session_resume() {
     flush_cpuregs();
 }
 
+bool processor::get_irq_histogram(const sc_object& src,
+                                  irq_histogram& hist) const {
+    lock_guard<mutex> guard(m_irq_mtx);
+    auto it = m_irq_sources.find(&src);
+    if (it == m_irq_sources.end())
+        return false;
+
+    hist = it->second;
+    return true;
+}
+
 bool processor::get_irq_stats(size_t irq, irq_stats& stats) const {
     if (m_irq_stats.find(irq) == m_irq_stats.end())
         return false;
@@ -506,6 +846,17 @@ void processor::gpio_notify(const gpio_target_socket& socket, bool state,
     stats.irq_status = state;
 
     if (state) {
+        // latency is measured from when the source raised its line until
+        // this processor runs next, controllers in between pass the origin
+        {
+            lock_guard<mutex> guard(m_irq_mtx);
+            if (m_irq_origins.size() < IRQ_MAX_ORIGINS)
+                m_irq_origins.push_back(socket.origin());
+        }
+
+        u64 idle = IRQ_IDLE;
+        m_irq_raised.compare_exchange_strong(idle, sc_time_stamp().value());
+
         stats.irq_count++;
         stats.irq_last = sc_time_stamp();
     } else {
@@ -516,6 +867,18 @@ void processor::gpio_notify(const gpio_target_socket& socket, bool state,
     }
 
     log_debug("%sing IRQ %zu", state ? "sett" : "clear", irqno);
+
+    // async processors would see interrupts at arbitrary cycles, so during
+    // record and replay they are applied at the start of the next step and
+    // logged with the number of cycles executed so far
+    if (async && m_irq_replay.is_active()) {
+        if (m_irq_replay.is_recording()) {
+            lock_guard<mutex> guard(m_irq_mtx);
+            m_irq_pending.push_back({ irqno, state, vector });
+        }
+        return;
+    }
+
     interrupt(irqno, state, vector);
 }
 
@@ -544,6 +907,22 @@ void processor::before_end_of_elaboration() {
 void processor::end_of_elaboration() {
     component::end_of_elaboration();
 
+    // symbol tables are shared between processors and built in background,
+    // lookups wait for them to become ready upon first use
+    for (const string& s : symbols) {
+        string symfile = trim(s);
+        if (symfile.empty())
+            continue;
+
+        if (!mwr::file_exists(symfile)) {
+            log_warn("cannot open file '%s'", symfile.c_str());
+            continue;
+        }
+
+        load_symbols_from_elf_async(symfile);
+        log_debug("loading symbols from '%s'", symfile.c_str());
+    }
+
     for (auto it : irq) {
         irq_stats& stats = m_irq_stats[it.first];
         stats.irq = it.first;
@@ -565,12 +944,64 @@ void processor::end_of_elaboration() {
         log_info("%s for GDB connection on port %hu",
                  gdb_wait ? "waiting" : "listening", m_gdb->port());
     }
+
+    if (profile_interval > SC_ZERO_TIME) {
+        m_profiler = new debugging::profiler();
+        log_debug("sampling guest profile every %s",
+                  profile_interval.str());
+    }
+
+    set_basic_block_batch(bbtrace_batch);
+
+    if (coverage_size > 0u) {
+        m_coverage = new debugging::coverage(*this, coverage_size,
+                                             coverage_shm.get());
+        log_debug("recording coverage in %zu byte bitmap",
+                  m_coverage->size());
+    }
+
+    if (!bbtrace_output.get().empty()) {
+        m_bbtrace = new debugging::bbtrace(*this, bbtrace_output.get());
+        log_debug("tracing basic blocks to %s", bbtrace_output.str());
+    }
 }
 
 void processor::end_of_simulation() {
     if (async)
         sc_join_async();
 
+    flush_basic_blocks();
+
+    if (m_bbtrace) {
+        m_bbtrace->flush();
+        log_info("wrote %llu basic blocks to %s", m_bbtrace->blocks(),
+                 bbtrace_output.get().c_str());
+    }
+
+    if (m_profiler && !profile_output.get().empty()) {
+        ofstream os(profile_output.get());
+        if (os.good()) {
+            m_profiler->write_folded(os);
+            log_info("wrote %llu profiling samples to %s",
+                     m_profiler->samples(), profile_output.get().c_str());
+        } else {
+            log_warn("cannot write profile to %s",
+                     profile_output.get().c_str());
+        }
+    }
+
+    if (!irq_histograms.get().empty()) {
+        ofstream os(irq_histograms.get());
+        if (os.good()) {
+            write_irq_histograms(os);
+            log_info("wrote irq latency histograms to %s",
+                     irq_histograms.get().c_str());
+        } else {
+            log_warn("cannot write irq latency histograms to %s",
+                     irq_histograms.get().c_str());
+        }
+    }
+
     component::end_of_simulation();
 }
 
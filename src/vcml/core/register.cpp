@@ -20,6 +20,11 @@ void reg_base::set_access_size(u64 min, u64 max) {
     m_maxsize = max;
 }
 
+bool reg_base::is_shadowable() const {
+    return is_readable() && !m_rsync && !m_tderived && !m_secure &&
+           m_privilege == 0;
+}
+
 int reg_base::current_cpu() const {
     return m_host->current_cpu();
 }
@@ -33,12 +38,14 @@ reg_base::reg_base(address_space space, const string& regname, u64 addr,
     m_access(VCML_ACCESS_READ_WRITE),
     m_rsync(false),
     m_wsync(false),
+    m_tderived(false),
     m_wback(true),
     m_aligned(false),
     m_secure(false),
     m_privilege(0),
     m_minsize(0),
     m_maxsize(-1),
+    m_horizon(SC_MAX_TIME),
     m_host(hierarchy_search<peripheral>()),
     as(space),
     tag() {
@@ -113,6 +120,8 @@ unsigned int reg_base::receive(tlm_generic_payload& tx, const tlm_sbi& info) {
     if (!info.is_debug) {
         if (tx.is_read() && m_rsync)
             m_host->sync();
+        if (tx.is_read() && m_tderived)
+            m_host->sync_horizon(m_horizon);
         if (tx.is_write() && m_wsync)
             m_host->sync();
     }
@@ -0,0 +1,301 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/replay.h"
+#include "vcml/logging/logger.h"
+
+namespace vcml {
+
+// The log starts with a magic number followed by a sequence of entries. An
+// entry either defines a channel (id 0, channel id, name) or holds an event
+// (channel id, stamp delta to the previous event of that channel, data). All
+// integers are stored as LEB128 variable length integers.
+static const char REPLAY_MAGIC[8] = { 'V', 'C', 'M', 'L', 'R', 'P', 'L', 1 };
+
+static void encode(ostream& os, u64 val) {
+    do {
+        u8 byte = val & 0x7f;
+        val >>= 7;
+        os.put(val ? byte | 0x80 : byte);
+    } while (val);
+}
+
+static bool decode(istream& is, u64& val) {
+    val = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        int byte = is.get();
+        if (byte == EOF)
+            return false;
+
+        val |= (u64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+static bool decode(istream& is, vector<u8>& data) {
+    u64 size;
+    if (!decode(is, size))
+        return false;
+
+    data.resize(size);
+    is.read((char*)data.data(), size);
+    return (u64)is.gcount() == size;
+}
+
+class replay_log
+{
+private:
+    mutex m_mtx;
+    replay_mode m_mode;
+    string m_path;
+    ofstream m_file;
+    u64 m_next_id;
+    unordered_set<string> m_channels;
+    unordered_map<string, deque<replay_event>> m_events;
+
+    void write(const void* data, size_t size);
+
+public:
+    replay_mode mode() const { return m_mode; }
+
+    replay_log();
+    ~replay_log();
+
+    void record(const string& path);
+    void playback(const string& path);
+    void finish();
+
+    void add_channel(const string& name);
+    void remove_channel(const string& name);
+
+    u64 define(const string& name);
+    void write(u64 id, u64 delta, const void* data, size_t size);
+    deque<replay_event>* events(const string& name);
+
+    static replay_log& instance();
+};
+
+void replay_log::write(const void* data, size_t size) {
+    encode(m_file, size);
+    m_file.write((const char*)data, size);
+}
+
+replay_log::replay_log():
+    m_mtx(),
+    m_mode(REPLAY_OFF),
+    m_path(),
+    m_file(),
+    m_next_id(1),
+    m_channels(),
+    m_events() {
+}
+
+replay_log::~replay_log() {
+    if (m_file.is_open())
+        m_file.close();
+}
+
+void replay_log::record(const string& path) {
+    lock_guard<mutex> guard(m_mtx);
+    VCML_ERROR_ON(m_mode != REPLAY_OFF, "replay log already in use");
+
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    VCML_ERROR_ON(!m_file.good(), "cannot open replay log %s", path.c_str());
+    m_file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+
+    m_path = path;
+    m_next_id = 1;
+    m_mode = REPLAY_RECORD;
+}
+
+void replay_log::playback(const string& path) {
+    lock_guard<mutex> guard(m_mtx);
+    VCML_ERROR_ON(m_mode != REPLAY_OFF, "replay log already in use");
+
+    ifstream file(path, std::ios::binary);
+    VCML_ERROR_ON(!file.good(), "cannot open replay log %s", path.c_str());
+
+    char magic[sizeof(REPLAY_MAGIC)];
+    file.read(magic, sizeof(magic));
+    if (!file || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0)
+        VCML_ERROR("%s is not a replay log", path.c_str());
+
+    unordered_map<u64, pair<string, u64>> channels;
+    m_events.clear();
+
+    u64 id;
+    while (decode(file, id)) {
+        vector<u8> data;
+        if (id == 0) {
+            if (!decode(file, id) || !decode(file, data))
+                VCML_ERROR("%s: truncated channel definition", path.c_str());
+            channels[id] = { string(data.begin(), data.end()), 0 };
+            continue;
+        }
+
+        auto it = channels.find(id);
+        VCML_ERROR_ON(it == channels.end(), "%s: undefined channel %llu",
+                      path.c_str(), id);
+
+        u64 delta;
+        if (!decode(file, delta) || !decode(file, data))
+            VCML_ERROR("%s: truncated event", path.c_str());
+
+        auto& [name, stamp] = it->second;
+        stamp += delta;
+        m_events[name].push_back({ stamp, std::move(data) });
+    }
+
+    m_path = path;
+    m_mode = REPLAY_PLAYBACK;
+}
+
+void replay_log::finish() {
+    lock_guard<mutex> guard(m_mtx);
+    if (m_mode == REPLAY_RECORD) {
+        m_file.close();
+        log_debug("recorded replay log %s", m_path.c_str());
+    }
+
+    if (m_mode == REPLAY_PLAYBACK) {
+        for (const auto& [name, events] : m_events) {
+            if (!events.empty()) {
+                log_warn("replay of %s diverged, %zu events left",
+                         name.c_str(), events.size());
+            }
+        }
+
+        m_events.clear();
+    }
+
+    m_mode = REPLAY_OFF;
+}
+
+void replay_log::add_channel(const string& name) {
+    lock_guard<mutex> guard(m_mtx);
+    if (!m_channels.insert(name).second)
+        VCML_ERROR("replay channel %s already exists", name.c_str());
+}
+
+void replay_log::remove_channel(const string& name) {
+    lock_guard<mutex> guard(m_mtx);
+    m_channels.erase(name);
+}
+
+u64 replay_log::define(const string& name) {
+    lock_guard<mutex> guard(m_mtx);
+    u64 id = m_next_id++;
+    encode(m_file, 0);
+    encode(m_file, id);
+    write(name.c_str(), name.length());
+    return id;
+}
+
+void replay_log::write(u64 id, u64 delta, const void* data, size_t size) {
+    lock_guard<mutex> guard(m_mtx);
+    encode(m_file, id);
+    encode(m_file, delta);
+    write(data, size);
+}
+
+deque<replay_event>* replay_log::events(const string& name) {
+    lock_guard<mutex> guard(m_mtx);
+    return &m_events[name];
+}
+
+replay_log& replay_log::instance() {
+    static replay_log log;
+    return log;
+}
+
+replay_mode replay_get_mode() {
+    return replay_log::instance().mode();
+}
+
+void replay_record(const string& path) {
+    replay_log::instance().record(path);
+}
+
+void replay_playback(const string& path) {
+    replay_log::instance().playback(path);
+}
+
+void replay_finish() {
+    replay_log::instance().finish();
+}
+
+deque<replay_event>* replay_channel::queue() {
+    if (!is_replaying())
+        return nullptr;
+    if (m_queue == nullptr)
+        m_queue = replay_log::instance().events(m_name);
+    return m_queue;
+}
+
+replay_channel::replay_channel(const string& name):
+    m_name(name), m_id(0), m_stamp(0), m_queue(nullptr) {
+    replay_log::instance().add_channel(m_name);
+}
+
+replay_channel::~replay_channel() {
+    replay_log::instance().remove_channel(m_name);
+}
+
+void replay_channel::record(u64 stamp, const void* data, size_t size) {
+    if (!is_recording())
+        return;
+
+    VCML_ERROR_ON(stamp < m_stamp, "replay stamp of %s went backwards",
+                  name());
+
+    replay_log& log = replay_log::instance();
+    if (m_id == 0)
+        m_id = log.define(m_name);
+
+    log.write(m_id, stamp - m_stamp, data, size);
+    m_stamp = stamp;
+}
+
+bool replay_channel::peek(u64& stamp) {
+    deque<replay_event>* events = queue();
+    if (events == nullptr || events->empty())
+        return false;
+
+    stamp = events->front().stamp;
+    return true;
+}
+
+bool replay_channel::fetch(u64& stamp, vector<u8>& data) {
+    deque<replay_event>* events = queue();
+    if (events == nullptr || events->empty())
+        return false;
+
+    stamp = events->front().stamp;
+    data = std::move(events->front().data);
+    events->pop_front();
+    return true;
+}
+
+bool replay_channel::wait_fetch(vector<u8>& data) {
+    u64 stamp;
+    if (!peek(stamp))
+        return false;
+
+    sc_time t = time_from_value(stamp);
+    if (t > sc_time_stamp())
+        sc_core::wait(t - sc_time_stamp());
+
+    return fetch(stamp, data);
+}
+
+} // namespace vcml
@@ -50,6 +50,7 @@ setup::setup(int argc, char** argv):
     m_log_errors_only("--log-errors-only", "Only log errors"),
     m_log_stdout("--log-stdout", "Send log output to stdout"),
     m_log_inscight("--log-inscight", "Send log output to InSCight database"),
+    m_log_deferred("--log-deferred", "Format log messages in the background"),
     m_log_files("--log-file", "-l", "Send log output to file"),
     m_trace_stdout("--trace-stdout", "Send tracing output to stdout"),
     m_trace_inscight("--trace-inscight", "Send tracing output to InSCight"),
@@ -100,6 +101,9 @@ setup::setup(int argc, char** argv):
         m_publishers.push_back(pub);
     }
 
+    if (m_log_deferred)
+        binlog_enable();
+
     for (const string& file : m_trace_files.values()) {
         tracer* t = new tracer_file(file);
         m_tracers.push_back(t);
@@ -136,6 +140,9 @@ setup::setup(int argc, char** argv):
 setup::~setup() {
     s_instance = nullptr;
 
+    if (m_log_deferred)
+        binlog_enable(false);
+
     for (auto broker : m_brokers)
         delete broker;
 
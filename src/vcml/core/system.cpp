@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/core/system.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 
@@ -64,6 +65,25 @@ void system::timeout() {
     }
 }
 
+void system::startup_done() {
+    auto& profiler = debugging::startup_profiler::instance();
+    profiler.finish();
+
+    stringstream ss;
+    profiler.write_report(ss, 20);
+    for (const string& line : split(ss.str(), '\n'))
+        log_info("%s", line.c_str());
+
+    ofstream file(startup_profile.get());
+    if (!file.good()) {
+        log_warn("cannot write startup profile to %s",
+                 startup_profile.get().c_str());
+        return;
+    }
+
+    profiler.write_trace(file);
+}
+
 system::system(const sc_module_name& nm):
     module(nm),
     name("name", mwr::progname()),
@@ -73,10 +93,25 @@ system::system(const sc_module_name& nm):
     session("session", -1),
     session_debug("session_debug", false),
     quantum("quantum", sc_time(1, SC_US)),
-    duration("duration", SC_ZERO_TIME) {
+    duration("duration", SC_ZERO_TIME),
+    record("record", ""),
+    replay("replay", ""),
+    startup_profile("startup_profile", "") {
     if (backtrace)
         mwr::report_segfaults();
 
+    if (!startup_profile.get().empty()) {
+        debugging::startup_profiler::instance().enable();
+        SC_METHOD(startup_done);
+    }
+
+    if (!record.get().empty() && !replay.get().empty())
+        VCML_ERROR("cannot record and replay at the same time");
+    if (!record.get().empty())
+        replay_record(record);
+    if (!replay.get().empty())
+        replay_playback(replay);
+
     if (duration > SC_ZERO_TIME) {
         SC_THREAD(timeout);
         if (quantum > duration) {
@@ -90,7 +125,7 @@ system::system(const sc_module_name& nm):
 }
 
 system::~system() {
-    // nothing to do
+    replay_finish();
 }
 
 int system::run() {
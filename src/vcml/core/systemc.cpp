@@ -11,6 +11,7 @@
 #include "vcml/core/version.h"
 #include "vcml/core/systemc.h"
 #include "vcml/core/thctl.h"
+#include "vcml/core/replay.h"
 
 namespace vcml {
 
@@ -294,53 +295,54 @@ public:
     vector<function<void(void)>> deltas;
     vector<function<void(void)>> tsteps;
 
-    struct timer_compare {
-        bool operator()(const async_timer::event* a,
-                        const async_timer::event* b) const {
-            return a->timeout > b->timeout;
-        }
-    };
-
+    // timers are only ever touched from the SystemC thread, new timers get
+    // pushed onto a lock-free list and are moved into the wheel during the
+    // next update phase
     sc_event timeout_event;
-    priority_queue<async_timer::event*, vector<async_timer::event*>,
-                   timer_compare>
-        timers;
-
-    vector<async_timer::event*> pending_timers() {
-        lock_guard<mutex> guard(mtx);
-        vector<async_timer::event*> pending;
-        sc_time now = sc_time_stamp();
-
-        while (!timers.empty()) {
-            async_timer::event* event = timers.top();
-            if (event->timeout > now)
-                break;
-
-            timers.pop();
-            pending.push_back(event);
+    timewheel timers;
+    atomic<async_timer::event*> new_timers;
+
+    void fetch_timers() {
+        async_timer::event* head = new_timers.exchange(nullptr);
+
+        async_timer::event* list = nullptr;
+        while (head) {
+            async_timer::event* next = head->pending;
+            head->pending = list;
+            list = head;
+            head = next;
         }
 
-        return pending;
+        while (list) {
+            async_timer::event* next = list->pending;
+            list->pending = nullptr;
+            if (list->owner)
+                timers.insert(list, list->timeout.value());
+            else
+                delete list;
+            list = next;
+        }
     }
 
     void update_timer() {
-        lock_guard<mutex> guard(mtx);
-
         if (timers.empty()) {
             timeout_event.cancel();
             return;
         }
 
-        sc_time next_timeout = timers.top()->timeout;
-        if (next_timeout < sc_time_stamp())
+        u64 next_timeout = timers.next_timeout();
+        u64 now = sc_time_stamp().value();
+        if (next_timeout <= now)
             timeout_event.notify(SC_ZERO_TIME);
         else
-            timeout_event.notify(next_timeout - sc_time_stamp());
+            timeout_event.notify(time_from_value(next_timeout - now));
     }
 
     void run_timer() {
-        vector<async_timer::event*> pending = pending_timers();
-        for (auto event : pending) {
+        vector<timewheel::node*> pending;
+        timers.advance(sc_time_stamp().value(), pending);
+        for (auto node : pending) {
+            auto* event = static_cast<async_timer::event*>(node);
             if (event->owner)
                 event->owner->trigger();
             delete event;
@@ -350,12 +352,27 @@ public:
     }
 
     void add_timer(async_timer::event* ev) {
-        lock_guard<mutex> guard(mtx);
-        timers.push(ev);
+        ev->pending = new_timers.load(std::memory_order_relaxed);
+        while (!new_timers.compare_exchange_weak(ev->pending, ev,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+            // retry
+        }
+
         async_request_update();
     }
 
+    void cancel_timer(async_timer::event* ev) {
+        if (thctl_is_sysc_thread() && ev->is_scheduled()) {
+            timers.remove(ev);
+            delete ev;
+        } else {
+            ev->owner = nullptr;
+        }
+    }
+
     void update() override {
+        fetch_timers();
         update_timer();
 
         vector<function<void(void)>> curr_update;
@@ -385,7 +402,8 @@ public:
         deltas(),
         tsteps(),
         timeout_event("timeout_ev"),
-        timers() {
+        timers(),
+        new_timers(nullptr) {
 #if SYSTEMC_VERSION >= SYSTEMC_VERSION_2_3_1a && \
     SYSTEMC_VERSION < SYSTEMC_VERSION_3_0_0
         if (use_phase_callbacks) {
@@ -451,10 +469,12 @@ public:
         sc_core::sc_unregister_stage_callback(
             *this, sc_core::SC_POST_UPDATE | sc_core::SC_PRE_TIMESTEP);
 #endif
-        while (!timers.empty()) {
-            delete timers.top();
-            timers.pop();
-        }
+        fetch_timers();
+
+        vector<timewheel::node*> pending;
+        timers.advance(~0ull, pending);
+        for (auto node : pending)
+            delete static_cast<async_timer::event*>(node);
     }
 
     static helper_module& instance() {
@@ -550,7 +570,7 @@ void async_timer::trigger() {
 
 void async_timer::cancel() {
     if (m_event) {
-        m_event->owner = nullptr;
+        g_helper.cancel_timer(m_event);
         m_event = nullptr;
     }
 }
@@ -560,6 +580,7 @@ void async_timer::reset(const sc_time& delta) {
 
     m_event = new event;
     m_event->owner = this;
+    m_event->pending = nullptr;
     m_event->timeout = m_timeout = sc_time_stamp() + delta;
 
     g_helper.add_timer(m_event);
@@ -567,6 +588,50 @@ void async_timer::reset(const sc_time& delta) {
 
 thread_local struct async_worker* g_async = nullptr;
 
+// The order in which the kernel completes sync requests of async workers
+// decides e.g. how MMIO accesses of async processors interleave. It depends
+// on host scheduling, so every worker records the global sequence numbers of
+// its sync requests and waits for them to come up again during playback.
+static u64 g_sync_seq = 0;
+
+static sc_event& sync_seq_event() {
+    static sc_event ev;
+    return ev;
+}
+
+// Workers that belong to the same domain never simulate concurrently: a
+// worker must hold its domain while running and releases it whenever it has
+// to wait for the SystemC thread (sync requests or quantum boundaries).
+struct async_domain {
+    const string name;
+    atomic<bool> busy;
+
+    async_domain(const string& nm): name(nm), busy(false) {}
+
+    bool try_acquire() {
+        bool expected = false;
+        return busy.compare_exchange_weak(expected, true,
+                                          std::memory_order_acquire);
+    }
+
+    void release() { busy.store(false, std::memory_order_release); }
+
+    typedef unordered_map<string, shared_ptr<async_domain>> map_t;
+    static shared_ptr<async_domain> lookup(const string& name) {
+        static mutex lock;
+        static map_t domains;
+
+        if (name.empty())
+            return nullptr;
+
+        lock_guard<mutex> guard(lock);
+        auto& domain = domains[name];
+        if (domain == nullptr)
+            domain = std::make_shared<async_domain>(name);
+        return domain;
+    }
+};
+
 struct async_worker {
     const size_t id;
     sc_process_b* const process;
@@ -578,9 +643,21 @@ struct async_worker {
 
     atomic<u64> progress;
     atomic<function<void(void)>*> request;
+    u64 syncs;
+
+    shared_ptr<async_domain> domain;
+    bool in_domain;
+
+    // deterministic workers run in lockstep with SystemC: the kernel thread
+    // grants them a slice and sleeps on stepped until they hand it back
+    atomic<bool> lockstep;
+    atomic<bool> granted;
+
+    replay_channel replay;
 
     mutex mtx;
     condition_variable_any notify;
+    condition_variable_any stepped;
     thread worker;
 
     sc_time sc_thread_pos;
@@ -596,8 +673,15 @@ struct async_worker {
         task(),
         progress(0),
         request(nullptr),
+        syncs(0),
+        domain(),
+        in_domain(false),
+        lockstep(false),
+        granted(false),
+        replay(mkstr("%s.sync", worker_proc->name())),
         mtx(),
         notify(),
+        stepped(),
         worker(&async_worker::work, this),
         sc_thread_pos(sc_time_stamp()) {
         VCML_ERROR_ON(!process, "invalid parent process");
@@ -626,15 +710,19 @@ struct async_worker {
 
             try {
                 mtx.unlock();
+                acquire_domain();
                 task();
+                release_domain();
                 mtx.lock();
             } catch (sim_terminated_exception& ex) {
                 (void)ex;
+                release_domain();
                 mtx.lock();
                 alive = false;
             }
 
             working = false;
+            stepped.notify_all();
         }
 
         mtx.unlock();
@@ -647,19 +735,27 @@ struct async_worker {
             alive = false;
             mtx.unlock();
             notify.notify_all();
+            stepped.notify_all();
             worker.join();
         }
     }
 
-    void run_async(function<void(void)>& job, int job_affinity) {
+    void run_async(function<void(void)>& job, int job_affinity,
+                   const string& job_domain, bool deterministic) {
         mtx.lock();
         task = job;
         affinity = job_affinity;
+        domain = deterministic ? nullptr : async_domain::lookup(job_domain);
+        lockstep = deterministic;
+        granted = false;
         working = true;
         mtx.unlock();
         notify.notify_one();
 
         while (working) {
+            if (lockstep)
+                grant();
+
             u64 p = progress.exchange(0);
             sc_thread_pos = sc_time_stamp() + time_from_value(p);
             sc_core::wait(time_from_value(p));
@@ -671,8 +767,10 @@ struct async_worker {
                     sc_core::wait(time_from_value(p));
                 }
 
+                replay_sync_begin();
                 (*request)();
                 request = nullptr;
+                replay_sync_end();
             }
         }
 
@@ -682,12 +780,85 @@ struct async_worker {
     }
 
     void run_sync(function<void(void)> job) {
+        syncs++;
+
         g_async->request = &job;
-        while (g_async->request) {
+        release_domain();
+
+        // lockstep workers are only granted their next slice after the
+        // kernel has completed the request
+        while (!lockstep && g_async->request) {
             if (!g_async->alive || !sim_running())
                 throw sim_terminated_exception();
             mwr::cpu_yield();
         }
+
+        acquire_domain();
+    }
+
+    void grant() {
+        std::unique_lock<mutex> guard(mtx);
+        granted = true;
+        stepped.notify_all();
+        while (granted && working && alive)
+            stepped.wait(guard);
+    }
+
+    void release_domain() {
+        if (lockstep) {
+            mtx.lock();
+            granted = false;
+            mtx.unlock();
+            stepped.notify_all();
+            return;
+        }
+
+        if (domain && in_domain) {
+            domain->release();
+            in_domain = false;
+        }
+    }
+
+    void acquire_domain() {
+        if (lockstep) {
+            std::unique_lock<mutex> guard(mtx);
+            while (!granted) {
+                if (!alive || !sim_running())
+                    throw sim_terminated_exception();
+                stepped.wait_for(guard, std::chrono::milliseconds(10));
+            }
+
+            return;
+        }
+
+        if (!domain || in_domain)
+            return;
+
+        while (!domain->try_acquire()) {
+            if (!alive || !sim_running())
+                throw sim_terminated_exception();
+            mwr::cpu_yield();
+        }
+
+        in_domain = true;
+    }
+
+    void replay_sync_begin() {
+        u64 seq;
+        while (replay.peek(seq) && seq > g_sync_seq)
+            sc_core::wait(sync_seq_event());
+    }
+
+    void replay_sync_end() {
+        replay.record(g_sync_seq, nullptr, 0);
+
+        u64 seq;
+        vector<u8> data;
+        if (replay.is_replaying())
+            replay.fetch(seq, data);
+
+        g_sync_seq++;
+        sync_seq_event().notify();
     }
 
     sc_time timestamp() { return sc_thread_pos + time_from_value(progress); }
@@ -707,21 +878,33 @@ struct async_worker {
             return *it->second;
 
         size_t id = workers.size();
+        if (workers.empty())
+            g_sync_seq = 0;
+
         auto worker = std::make_shared<async_worker>(id, thread);
         return *(workers[thread] = worker);
     }
 };
 
-void sc_async(function<void(void)> job, int affinity) {
+void sc_async(function<void(void)> job, int affinity, const string& domain,
+              bool deterministic) {
     auto thread = current_thread();
     VCML_ERROR_ON(!thread, "sc_async must be called from SC_THREAD");
     async_worker& worker = async_worker::lookup(thread);
-    worker.run_async(job, affinity);
+    worker.run_async(job, affinity, domain, deterministic);
 }
 
+static function<void(const sc_time&)> g_async_pacer;
+
 void sc_progress(const sc_time& delta) {
     VCML_ERROR_ON(!g_async, "no async thread to progress");
     g_async->progress += delta.value();
+    if (g_async_pacer)
+        g_async_pacer(g_async->timestamp());
+}
+
+void sc_set_async_pacer(function<void(const sc_time&)> pacer) {
+    g_async_pacer = std::move(pacer);
 }
 
 void sc_sync(function<void(void)> job) {
@@ -738,6 +921,16 @@ void sc_join_async() {
     async_worker::all_workers().clear();
 }
 
+void sc_release_domain() {
+    if (g_async)
+        g_async->release_domain();
+}
+
+void sc_acquire_domain() {
+    if (g_async)
+        g_async->acquire_domain();
+}
+
 bool sc_is_async() {
     return g_async != nullptr;
 }
@@ -752,6 +945,10 @@ sc_time async_time_offset() {
     return async_time_stamp() - sc_time_stamp();
 }
 
+u64 async_sync_count() {
+    return g_async ? g_async->syncs : 0;
+}
+
 bool is_thread(sc_process_b* proc) {
     if (!thctl_is_sysc_thread())
         return false;
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2024 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/core/timewheel.h"
+
+namespace vcml {
+
+static inline size_t timewheel_level(u64 timeout, u64 now) {
+    u64 diff = timeout ^ now;
+    if (diff == 0)
+        return 0;
+    return (63 - clz(diff)) / timewheel::BITS;
+}
+
+static inline size_t timewheel_slot(u64 timeout, size_t level) {
+    return (timeout >> (level * timewheel::BITS)) & (timewheel::SLOTS - 1);
+}
+
+void timewheel::link(node* n) {
+    size_t level = timewheel_level(n->timeout, m_now);
+    size_t slot = timewheel_slot(n->timeout, level);
+
+    node*& head = m_slots[level][slot];
+    n->level = level;
+    n->slot = slot;
+    n->prev = nullptr;
+    n->next = head;
+    n->scheduled = true;
+    if (head)
+        head->prev = n;
+    head = n;
+
+    m_used[level] |= 1ull << slot;
+    m_count++;
+}
+
+void timewheel::unlink(node* n) {
+    node*& head = m_slots[n->level][n->slot];
+    if (n->prev)
+        n->prev->next = n->next;
+    else
+        head = n->next;
+    if (n->next)
+        n->next->prev = n->prev;
+    if (head == nullptr)
+        m_used[n->level] &= ~(1ull << n->slot);
+
+    n->prev = n->next = nullptr;
+    n->scheduled = false;
+    m_count--;
+}
+
+void timewheel::set_now(u64 now) {
+    u64 prev = m_now;
+    m_now = now;
+
+    // all entries below the highest level that changed would have expired
+    // already, so only the slot we are moving into needs to be cascaded
+    size_t level = timewheel_level(prev, now);
+    if (prev == now || level == 0)
+        return;
+
+    size_t slot = timewheel_slot(now, level);
+    node* n = m_slots[level][slot];
+    m_slots[level][slot] = nullptr;
+    m_used[level] &= ~(1ull << slot);
+
+    while (n) {
+        node* next = n->next;
+        m_count--;
+        link(n);
+        n = next;
+    }
+}
+
+timewheel::timewheel(): m_now(0), m_count(0), m_used(), m_slots() {
+    // nothing to do
+}
+
+void timewheel::insert(node* n, u64 timeout) {
+    if (n->scheduled)
+        unlink(n);
+
+    n->timeout = max(timeout, m_now);
+    link(n);
+}
+
+void timewheel::remove(node* n) {
+    if (n->scheduled)
+        unlink(n);
+}
+
+u64 timewheel::next_timeout() const {
+    for (size_t level = 0; level < LEVELS; level++) {
+        if (m_used[level] == 0)
+            continue;
+
+        size_t slot = ctz(m_used[level]);
+        if (level == 0)
+            return (m_now & ~(u64)(SLOTS - 1)) | slot;
+
+        u64 timeout = ~0ull;
+        for (node* n = m_slots[level][slot]; n != nullptr; n = n->next)
+            timeout = min(timeout, n->timeout);
+        return timeout;
+    }
+
+    return ~0ull;
+}
+
+void timewheel::advance(u64 now, vector<node*>& expired) {
+    while (m_count > 0) {
+        u64 next = next_timeout();
+        if (next > now)
+            break;
+
+        set_now(next);
+
+        size_t slot = timewheel_slot(next, 0);
+        while (node* n = m_slots[0][slot]) {
+            unlink(n);
+            expired.push_back(n);
+        }
+    }
+
+    if (now > m_now)
+        set_now(now);
+}
+
+} // namespace vcml
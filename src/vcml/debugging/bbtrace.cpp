@@ -0,0 +1,118 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/bbtrace.h"
+
+namespace vcml {
+namespace debugging {
+
+static const char BBTRACE_MAGIC[8] = { 'V', 'C', 'M', 'L', 'B', 'B', 'T', 1 };
+
+static const size_t BBTRACE_BUFSIZE = 64 * KiB;
+
+static void encode(vector<u8>& buf, u64 val) {
+    do {
+        u8 byte = val & 0x7f;
+        val >>= 7;
+        buf.push_back(val ? byte | 0x80 : byte);
+    } while (val);
+}
+
+static bool decode(istream& is, u64& val) {
+    val = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        int byte = is.get();
+        if (byte == EOF)
+            return false;
+
+        val |= (u64)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+void bbtrace::record(u64 pc, u64 size, u64 icount) {
+    i64 delta = (i64)(pc - m_next);
+    encode(m_buffer, ((u64)delta << 1) ^ (u64)(delta >> 63));
+    encode(m_buffer, size);
+    encode(m_buffer, icount);
+
+    m_next = pc + size;
+    m_blocks++;
+
+    if (m_buffer.size() >= BBTRACE_BUFSIZE)
+        flush();
+}
+
+bbtrace::bbtrace(target& tgt, const string& path):
+    m_target(tgt),
+    m_file(path, std::ios::binary | std::ios::trunc),
+    m_buffer(),
+    m_next(0),
+    m_blocks(0) {
+    VCML_ERROR_ON(!m_file.good(), "cannot open %s", path.c_str());
+    m_file.write(BBTRACE_MAGIC, sizeof(BBTRACE_MAGIC));
+    m_buffer.reserve(BBTRACE_BUFSIZE + 32);
+
+    if (!m_target.trace_basic_blocks(this)) {
+        VCML_ERROR("%s does not support basic block tracing",
+                   m_target.target_name());
+    }
+}
+
+bbtrace::~bbtrace() {
+    m_target.untrace_basic_blocks(this);
+    flush();
+}
+
+void bbtrace::flush() {
+    m_file.write((const char*)m_buffer.data(), m_buffer.size());
+    m_file.flush();
+    m_buffer.clear();
+}
+
+void bbtrace::notify_basic_block(target& tgt, u64 pc, size_t blksz,
+                                 size_t icount) {
+    record(pc, blksz, icount);
+}
+
+void bbtrace::notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                  size_t count) {
+    for (size_t i = 0; i < count; i++)
+        record(blocks[i].pc, blocks[i].size, blocks[i].icount);
+}
+
+bool bbtrace::load(const string& path, vector<basic_block>& blocks) {
+    ifstream file(path, std::ios::binary);
+    if (!file.good())
+        return false;
+
+    char magic[sizeof(BBTRACE_MAGIC)];
+    file.read(magic, sizeof(magic));
+    if (!file || memcmp(magic, BBTRACE_MAGIC, sizeof(magic)) != 0)
+        return false;
+
+    u64 next = 0, delta, size, icount;
+    while (decode(file, delta)) {
+        if (!decode(file, size) || !decode(file, icount))
+            return false;
+
+        u64 pc = next + (u64)((i64)(delta >> 1) ^ -(i64)(delta & 1));
+        blocks.push_back({ pc, (u32)size, (u32)icount });
+        next = pc + size;
+    }
+
+    return true;
+}
+
+} // namespace debugging
+} // namespace vcml
@@ -0,0 +1,67 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/coverage.h"
+
+namespace vcml {
+namespace debugging {
+
+void coverage::hit(u64 pc) {
+    // block hash as used by the AFL qemu mode, shifting the previous hash
+    // keeps the edges A->B and B->A as well as A->A and B->B apart
+    u64 curr = ((pc >> 4) ^ (pc << 8)) & m_mask;
+    u8& counter = bitmap()[curr ^ m_prev];
+    counter += counter == 0xff ? 2 : 1; // never wrap back to zero
+    m_prev = curr >> 1;
+}
+
+coverage::coverage(target& tgt, size_t size, const string& shared):
+    m_target(tgt), m_bitmap(), m_mask(size - 1), m_prev(0) {
+    VCML_ERROR_ON(!is_pow2(size), "coverage size must be a power of two");
+
+    if (shared.empty())
+        m_bitmap.init(size, VCML_ALIGN_NONE);
+    else
+        m_bitmap.init(shared, size, VCML_ALIGN_NONE);
+
+    m_bitmap.clear();
+
+    if (!m_target.trace_basic_blocks(this)) {
+        VCML_ERROR("%s does not support basic block tracing",
+                   m_target.target_name());
+    }
+}
+
+coverage::~coverage() {
+    m_target.untrace_basic_blocks(this);
+}
+
+size_t coverage::count() const {
+    return size() - std::count(bitmap(), bitmap() + size(), 0);
+}
+
+void coverage::reset() {
+    m_bitmap.clear();
+    m_prev = 0;
+}
+
+void coverage::notify_basic_block(target& tgt, u64 pc, size_t blksz,
+                                  size_t icount) {
+    hit(pc);
+}
+
+void coverage::notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                   size_t count) {
+    for (size_t i = 0; i < count; i++)
+        hit(blocks[i].pc);
+}
+
+} // namespace debugging
+} // namespace vcml
@@ -10,6 +10,7 @@
 
 #include "vcml/core/module.h"
 #include "vcml/debugging/loader.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 namespace debugging {
@@ -307,6 +308,9 @@ void loader::load_image(const image_info& image) {
     if (!mwr::file_exists(image.filename))
         VCML_REPORT("file not found");
 
+    debugging::startup_scope scope(loader_name(), "load_image",
+                                   image.filename.c_str());
+
     switch (image.type) {
     case IMAGE_ELF:
         load_elf(image.filename, image.offset);
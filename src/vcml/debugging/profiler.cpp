@@ -0,0 +1,118 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/profiler.h"
+
+namespace vcml {
+namespace debugging {
+
+static const char* frame_name(const stackframe& frame) {
+    return frame.sym ? frame.sym->name() : "[unknown]";
+}
+
+profiler::profiler(): m_mtx(), m_samples(0), m_stacks(), m_functions() {
+    // nothing to do
+}
+
+u64 profiler::samples() const {
+    lock_guard<mutex> guard(m_mtx);
+    return m_samples;
+}
+
+void profiler::reset() {
+    lock_guard<mutex> guard(m_mtx);
+    m_samples = 0;
+    m_stacks.clear();
+    m_functions.clear();
+}
+
+void profiler::sample(const vector<stackframe>& frames, u64 weight) {
+    if (frames.empty() || weight == 0)
+        return;
+
+    // frames are ordered innermost first, folded stacks outermost first
+    string folded;
+    for (auto it = frames.rbegin(); it != frames.rend(); it++) {
+        if (!folded.empty())
+            folded += ';';
+        folded += frame_name(*it);
+    }
+
+    lock_guard<mutex> guard(m_mtx);
+    m_samples += weight;
+    m_stacks[folded] += weight;
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const char* name = frame_name(frames[i]);
+
+        // count recursive functions only once towards their total
+        bool seen = false;
+        for (size_t j = 0; j < i && !seen; j++)
+            seen = strcmp(frame_name(frames[j]), name) == 0;
+        if (seen)
+            continue;
+
+        profile_entry& entry = m_functions[name];
+        if (entry.name.empty())
+            entry.name = name;
+        if (i == 0)
+            entry.self += weight;
+        entry.total += weight;
+    }
+}
+
+vector<profile_entry> profiler::top(size_t limit) const {
+    vector<profile_entry> entries;
+
+    {
+        lock_guard<mutex> guard(m_mtx);
+        entries.reserve(m_functions.size());
+        for (const auto& func : m_functions)
+            entries.push_back(func.second);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const profile_entry& a, const profile_entry& b) -> bool {
+                  if (a.self != b.self)
+                      return a.self > b.self;
+                  if (a.total != b.total)
+                      return a.total > b.total;
+                  return a.name < b.name;
+              });
+
+    if (entries.size() > limit)
+        entries.resize(limit);
+
+    return entries;
+}
+
+void profiler::write_folded(ostream& os) const {
+    lock_guard<mutex> guard(m_mtx);
+    for (const auto& [stack, count] : m_stacks)
+        os << stack << " " << count << "\n";
+}
+
+void profiler::write_top(ostream& os, size_t limit) const {
+    u64 total = samples();
+    os << "profiled " << total << " samples";
+    if (total == 0)
+        return;
+
+    char line[64];
+    for (const profile_entry& entry : top(limit)) {
+        snprintf(line, sizeof(line), "\n%6.2f%% %6.2f%% %10llu  ",
+                 100.0 * entry.self / total, 100.0 * entry.total / total,
+                 (unsigned long long)entry.self);
+        os << line << entry.name;
+    }
+}
+
+} // namespace debugging
+} // namespace vcml
@@ -32,10 +32,10 @@ static string rsp_escape(const string& s) {
     return ss.str();
 }
 
-static u8 checksum(const char* str) {
+static u8 checksum(const string& str) {
     u8 result = 0;
-    while (str && *str)
-        result += static_cast<u8>(*str++);
+    for (char c : str)
+        result += static_cast<u8>(c);
     return result;
 }
 
@@ -45,6 +45,7 @@ rspserver::rspserver(u16 port):
     m_name(mkstr("rsp_%hu", m_port)),
     m_echo(false),
     m_running(false),
+    m_idle_ms(0),
     m_mutex(),
     m_thread(),
     m_handlers(),
@@ -68,7 +69,7 @@ void rspserver::send_packet(const string& s) {
     string esc = rsp_escape(s);
 
     stringstream ss;
-    u8 sum = checksum(esc.c_str());
+    u8 sum = checksum(esc);
     ss << "$" << esc << "#" << to_hex_ascii(sum >> 4) << to_hex_ascii(sum);
 
     char ack;
@@ -96,6 +97,30 @@ void rspserver::send_packet(const string& s) {
     } while (ack != '+');
 }
 
+// notifications use '%' instead of '$' and are not acknowledged by the peer
+void rspserver::send_notification(const string& s) {
+    VCML_ERROR_ON(!is_connected(), "no connection established");
+    string esc = rsp_escape(s);
+
+    stringstream ss;
+    u8 sum = checksum(esc);
+    ss << "%" << esc << "#" << to_hex_ascii(sum >> 4) << to_hex_ascii(sum);
+
+    lock_guard<mutex> lock(m_mutex);
+    if (m_echo)
+        log_debug("sending notification '%s'", ss.str().c_str());
+    m_sock.send(ss.str());
+}
+
+bool rspserver::poll_packet() {
+    time_t timeout = m_idle_ms;
+    if (timeout == 0)
+        return true;
+
+    // peeking consumes nothing, so do not block senders while waiting
+    return !is_connected() || m_sock.peek(timeout);
+}
+
 string rspserver::recv_packet() {
     lock_guard<mutex> lock(m_mutex);
     VCML_ERROR_ON(!is_connected(), "no connection established");
@@ -199,6 +224,11 @@ void rspserver::run() {
             listen();
             while (m_running && is_connected())
                 try {
+                    if (!poll_packet()) {
+                        handle_idle();
+                        continue;
+                    }
+
                     string command = recv_packet();
                     string response = handle_command(command);
                     if (is_connected())
@@ -252,6 +282,10 @@ void rspserver::handle_disconnect() {
     // to be overloaded
 }
 
+void rspserver::handle_idle() {
+    // to be overloaded
+}
+
 void rspserver::register_handler(const char* cmd, handler h) {
     for (const auto& other : m_handlers) {
         if (starts_with(other.first, cmd) || starts_with(cmd, other.first))
@@ -0,0 +1,218 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/debugging/startup.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace vcml {
+namespace debugging {
+
+static i64 heap_usage() {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+    return (i64)(info.uordblks + info.hblkhd);
+#endif
+#endif
+    return 0;
+}
+
+static string json_escape(const string& s) {
+    string res;
+    res.reserve(s.length());
+    for (char c : s) {
+        switch (c) {
+        case '"':
+            res += "\\\"";
+            break;
+        case '\\':
+            res += "\\\\";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+                res += mkstr("\\u%04x", (unsigned int)c);
+            else
+                res += c;
+        }
+    }
+
+    return res;
+}
+
+atomic<bool> startup_profiler::s_enabled(false);
+
+void startup_profiler::pop(double now, i64 heap) {
+    startup_entry& entry = m_entries[m_stack.back()];
+    entry.total = now - entry.start;
+    entry.self += entry.total;
+    entry.alloc = heap - m_allocs.back();
+
+    m_stack.pop_back();
+    m_allocs.pop_back();
+    if (!m_stack.empty())
+        m_entries[m_stack.back()].self -= entry.total;
+
+    // open checkpoints are marked by a negative total
+    m_checkpoint = !m_stack.empty() && m_entries[m_stack.back()].total < 0;
+}
+
+startup_profiler::startup_profiler():
+    m_mtx(),
+    m_origin(0.0),
+    m_entries(),
+    m_stack(),
+    m_allocs(),
+    m_checkpoint(false) {
+}
+
+void startup_profiler::enable() {
+    lock_guard<mutex> guard(m_mtx);
+    if (!s_enabled)
+        m_origin = mwr::timestamp();
+    s_enabled = true;
+}
+
+void startup_profiler::disable() {
+    s_enabled = false;
+}
+
+void startup_profiler::finish() {
+    lock_guard<mutex> guard(m_mtx);
+    if (m_checkpoint)
+        pop(mwr::timestamp(), heap_usage());
+    s_enabled = false;
+}
+
+size_t startup_profiler::begin(const string& name, const string& phase,
+                               const string& detail) {
+    i64 heap = heap_usage();
+    lock_guard<mutex> guard(m_mtx);
+    m_stack.push_back(m_entries.size());
+    m_allocs.push_back(heap);
+    m_entries.push_back(
+        { name, phase, detail, mwr::timestamp(), 0, 0, 0, false });
+    m_checkpoint = false;
+    return m_stack.back();
+}
+
+void startup_profiler::end(size_t id, const string& name) {
+    double now = mwr::timestamp();
+    i64 heap = heap_usage();
+
+    lock_guard<mutex> guard(m_mtx);
+    VCML_ERROR_ON(m_stack.empty() || m_stack.back() != id,
+                  "startup profiler scopes out of order");
+
+    if (!name.empty())
+        m_entries[id].name = name;
+
+    pop(now, heap);
+}
+
+void startup_profiler::checkpoint(const string& name, const string& phase) {
+    double now = mwr::timestamp();
+    i64 heap = heap_usage();
+
+    lock_guard<mutex> guard(m_mtx);
+    if (m_checkpoint)
+        pop(now, heap);
+
+    // checkpoints stay open until the next checkpoint or finish
+    m_stack.push_back(m_entries.size());
+    m_allocs.push_back(heap);
+    m_entries.push_back({ name, phase, "", now, -1.0, 0, 0, false });
+    m_checkpoint = true;
+}
+
+void startup_profiler::record(const string& name, const string& phase,
+                              double start, const string& detail) {
+    double total = mwr::timestamp() - start;
+
+    lock_guard<mutex> guard(m_mtx);
+    if (s_enabled)
+        m_entries.push_back(
+            { name, phase, detail, start, total, total, 0, true });
+}
+
+vector<startup_entry> startup_profiler::entries() const {
+    lock_guard<mutex> guard(m_mtx);
+    vector<startup_entry> entries;
+    for (const startup_entry& entry : m_entries)
+        if (entry.total >= 0.0)
+            entries.push_back(entry);
+    return entries;
+}
+
+void startup_profiler::write_report(ostream& os, size_t limit) const {
+    vector<startup_entry> entries = this->entries();
+
+    std::map<string, double> phases;
+    for (const startup_entry& entry : entries)
+        if (!entry.background)
+            phases[entry.phase] += entry.self;
+
+    char line[128];
+    os << "startup profile";
+    for (const auto& [phase, time] : phases) {
+        snprintf(line, sizeof(line), "\n%10.3fms  %s", time * 1e3,
+                 phase.c_str());
+        os << line;
+    }
+
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const startup_entry& a, const startup_entry& b) {
+                         return a.self > b.self;
+                     });
+
+    if (entries.size() > limit)
+        entries.resize(limit);
+
+    for (const startup_entry& entry : entries) {
+        snprintf(line, sizeof(line), "\n%10.3fms %10.3fms %10lldkB  ",
+                 entry.self * 1e3, entry.total * 1e3,
+                 (long long)entry.alloc / 1024);
+        os << line << entry.phase << " " << entry.name;
+        if (!entry.detail.empty())
+            os << " (" << entry.detail << ")";
+    }
+}
+
+void startup_profiler::write_trace(ostream& os) const {
+    vector<startup_entry> entries = this->entries();
+
+    // chrome trace event format, timestamps in microseconds
+    os << "{\"traceEvents\":[";
+    for (size_t i = 0; i < entries.size(); i++) {
+        const startup_entry& entry = entries[i];
+        os << (i ? ",\n" : "\n") << "{\"name\":\""
+           << json_escape(entry.name) << "\",\"cat\":\""
+           << json_escape(entry.phase) << "\",\"ph\":\"X\",\"pid\":1,"
+           << "\"tid\":" << (entry.background ? 2 : 1) << ",\"ts\":"
+           << (u64)((entry.start - m_origin) * 1e6)
+           << ",\"dur\":" << (u64)(entry.total * 1e6) << ",\"args\":{"
+           << "\"alloc\":" << entry.alloc;
+        if (!entry.detail.empty())
+            os << ",\"detail\":\"" << json_escape(entry.detail) << "\"";
+        os << "}}";
+    }
+
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+startup_profiler& startup_profiler::instance() {
+    static startup_profiler profiler;
+    return profiler;
+}
+
+} // namespace debugging
+} // namespace vcml
@@ -22,6 +22,12 @@ void subscriber::notify_basic_block(target& tgt, u64 pc, size_t blksz,
     // to be overloaded
 }
 
+void subscriber::notify_basic_blocks(target& tgt, const basic_block* blocks,
+                                     size_t count) {
+    for (size_t i = 0; i < count; i++)
+        notify_basic_block(tgt, blocks[i].pc, blocks[i].size, blocks[i].icount);
+}
+
 void subscriber::notify_breakpoint_hit(const breakpoint& bp) {
     // to be overloaded
 }
@@ -9,6 +9,8 @@
  ******************************************************************************/
 
 #include "vcml/debugging/symtab.h"
+#include "vcml/debugging/startup.h"
+#include "vcml/logging/logger.h"
 
 namespace vcml {
 namespace debugging {
@@ -32,6 +34,274 @@ symbol::symbol(const string& name, symkind kind, endianess endian, u64 sz,
     m_phys(phys_addr) {
 }
 
+static u64 hash_name(const char* name) {
+    u64 hash = 0xcbf29ce484222325ull; // FNV-1a
+    for (; *name; name++)
+        hash = (hash ^ (u8)*name) * 0x100000001b3ull;
+    return hash;
+}
+
+static void sort_symbols(vector<symbol>& syms, vector<u32>& seq) {
+    // keep the first symbol per address, just like symtab::insert does
+    vector<u32> order(syms.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        return syms[a].virt_addr() < syms[b].virt_addr();
+    });
+
+    order.erase(std::unique(order.begin(), order.end(),
+                            [&](u32 a, u32 b) {
+                                return syms[a].virt_addr() ==
+                                       syms[b].virt_addr();
+                            }),
+                order.end());
+
+    vector<symbol> sorted;
+    sorted.reserve(order.size());
+    for (u32 idx : order)
+        sorted.push_back(std::move(syms[idx]));
+    syms = std::move(sorted);
+
+    // positions of the remaining symbols in their original file order
+    seq.resize(order.size());
+    std::iota(seq.begin(), seq.end(), 0);
+    std::sort(seq.begin(), seq.end(),
+              [&](u32 a, u32 b) { return order[a] < order[b]; });
+}
+
+void symfile::index(const vector<symbol>& syms, const vector<u32>& seq,
+                    vector<u32>& names) {
+    size_t size = 16;
+    while (size < 2 * syms.size())
+        size *= 2;
+
+    // slots hold symbol positions plus one, zero marks an empty slot; names
+    // that appear multiple times refer to their last occurrence in the file
+    names.assign(size, 0);
+    for (u32 pos : seq) {
+        const char* name = syms[pos].name();
+        size_t slot = hash_name(name) & (size - 1);
+        while (names[slot] && strcmp(syms[names[slot] - 1].name(), name))
+            slot = (slot + 1) & (size - 1);
+        names[slot] = pos + 1;
+    }
+}
+
+const symbol* symfile::lookup(const vector<symbol>& syms,
+                              const vector<u32>& names, const string& name) {
+    if (names.empty())
+        return nullptr;
+
+    size_t mask = names.size() - 1;
+    for (size_t slot = hash_name(name.c_str()) & mask; names[slot];
+         slot = (slot + 1) & mask) {
+        const symbol& sym = syms[names[slot] - 1];
+        if (name == sym.name())
+            return &sym;
+    }
+
+    return nullptr;
+}
+
+const symbol* symfile::lookup(const vector<symbol>& syms, u64 addr) {
+    auto it = std::upper_bound(syms.begin(), syms.end(), addr,
+                               [](u64 a, const symbol& sym) -> bool {
+                                   return a < sym.virt_addr();
+                               });
+    if (it == syms.begin())
+        return nullptr;
+
+    // find first that is not greater than addr
+    const symbol& sym = *--it;
+    return sym.memory().includes(addr) ? &sym : nullptr;
+}
+
+void symfile::build() {
+    vector<u32> seq;
+
+    try {
+        mwr::elf reader(m_path);
+        endianess endian = reader.is_big_endian() ? ENDIAN_BIG
+                                                  : ENDIAN_LITTLE;
+
+        for (const auto& sym : reader.symbols()) {
+            switch (sym.kind) {
+            case mwr::elf::KIND_OBJECT:
+            case mwr::elf::KIND_COMMON:
+            case mwr::elf::KIND_TLS:
+                m_objects.emplace_back(sym.name, SYMKIND_OBJECT, endian,
+                                       sym.size, sym.virt, sym.phys);
+                break;
+
+            case mwr::elf::KIND_FUNC:
+                m_functions.emplace_back(sym.name, SYMKIND_FUNCTION, endian,
+                                         sym.size, sym.virt, sym.phys);
+                break;
+
+            case mwr::elf::KIND_UNKNOWN:
+            case mwr::elf::KIND_NONE:
+            default:
+                break;
+            }
+        }
+
+        m_count = reader.symbols().size();
+    } catch (std::exception& ex) {
+        m_error = ex.what();
+        m_functions.clear();
+        m_objects.clear();
+    }
+
+    sort_symbols(m_functions, seq);
+    index(m_functions, seq, m_function_names);
+
+    sort_symbols(m_objects, seq);
+    index(m_objects, seq, m_object_names);
+
+    m_ready = true;
+}
+
+void symfile::load() const {
+    std::call_once(m_once, [this]() { const_cast<symfile*>(this)->build(); });
+}
+
+symfile::symfile(const string& path):
+    m_path(path),
+    m_error(),
+    m_count(0),
+    m_functions(),
+    m_objects(),
+    m_function_names(),
+    m_object_names(),
+    m_once(),
+    m_mtx(),
+    m_ready(false),
+    m_worker() {
+}
+
+symfile::~symfile() {
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+void symfile::prefetch() {
+    lock_guard<mutex> guard(m_mtx);
+    if (m_ready || m_worker.joinable())
+        return;
+
+    m_worker = thread([this]() {
+        mwr::set_thread_name("vcml_symbols");
+        double start = mwr::timestamp();
+        load();
+
+        if (startup_profiler::enabled()) {
+            startup_profiler::instance().record(m_path, "load_symbols", start,
+                                                "background");
+        }
+
+        if (!m_error.empty()) {
+            log_warn("cannot load symbols from %s: %s", m_path.c_str(),
+                     m_error.c_str());
+        }
+    });
+}
+
+const string& symfile::error() const {
+    load();
+    return m_error;
+}
+
+u64 symfile::count() const {
+    load();
+    return m_count;
+}
+
+const vector<symbol>& symfile::functions() const {
+    load();
+    return m_functions;
+}
+
+const vector<symbol>& symfile::objects() const {
+    load();
+    return m_objects;
+}
+
+const symbol* symfile::find_function(const string& name) const {
+    load();
+    return lookup(m_functions, m_function_names, name);
+}
+
+const symbol* symfile::find_function(u64 addr) const {
+    load();
+    return lookup(m_functions, addr);
+}
+
+const symbol* symfile::find_object(const string& name) const {
+    load();
+    return lookup(m_objects, m_object_names, name);
+}
+
+const symbol* symfile::find_object(u64 addr) const {
+    load();
+    return lookup(m_objects, addr);
+}
+
+shared_ptr<symfile> symfile::open(const string& path) {
+    static mutex mtx;
+    static unordered_map<string, std::weak_ptr<symfile>> files;
+
+    lock_guard<mutex> guard(mtx);
+    shared_ptr<symfile> file = files[path].lock();
+    if (!file) {
+        file = std::make_shared<symfile>(path);
+        files[path] = file;
+    }
+
+    return file;
+}
+
+// symbols at the highest address win if multiple tables contain addr
+static const symbol* closest(const symbol* a, const symbol* b) {
+    if (a == nullptr)
+        return b;
+    if (b == nullptr)
+        return a;
+    return b->virt_addr() > a->virt_addr() ? b : a;
+}
+
+static void merge_into(symtab::symset& set, const vector<symbol>& syms) {
+    for (const symbol& sym : syms)
+        set.insert(sym);
+}
+
+size_t symtab::count_functions() const {
+    size_t count = m_functions.size();
+    for (const auto& file : m_files)
+        count += file->functions().size();
+    return count;
+}
+
+size_t symtab::count_objects() const {
+    size_t count = m_objects.size();
+    for (const auto& file : m_files)
+        count += file->objects().size();
+    return count;
+}
+
+symtab::symset symtab::functions() const {
+    symset functions(m_functions);
+    for (const auto& file : m_files)
+        merge_into(functions, file->functions());
+    return functions;
+}
+
+symtab::symset symtab::objects() const {
+    symset objects(m_objects);
+    for (const auto& file : m_files)
+        merge_into(objects, file->objects());
+    return objects;
+}
+
 void symtab::insert(const symbol& sym) {
     if (!sym.is_function() && !sym.is_object())
         VCML_ERROR("symbol '%s' has no known type", sym.name());
@@ -59,6 +329,7 @@ void symtab::clear() {
     m_objects.clear();
     m_function_names.clear();
     m_object_names.clear();
+    m_files.clear();
 }
 
 const symbol* symtab::find_symbol(const string& name) const {
@@ -77,44 +348,66 @@ const symbol* symtab::find_symbol(u64 addr) const {
 
 const symbol* symtab::find_function(const string& name) const {
     const auto it = m_function_names.find(name);
-    return it != m_function_names.end() ? it->second : nullptr;
+    if (it != m_function_names.end())
+        return it->second;
+
+    for (const auto& file : m_files)
+        if (const symbol* sym = file->find_function(name))
+            return sym;
+
+    return nullptr;
 }
 
 const symbol* symtab::find_function(u64 addr) const {
+    const symbol* result = nullptr;
+    for (const auto& file : m_files)
+        result = closest(result, file->find_function(addr));
+
     if (m_functions.empty())
-        return nullptr;
+        return result;
     if (addr < m_functions.begin()->virt_addr())
-        return nullptr;
+        return result;
     if (addr > m_functions.rbegin()->memory().end)
-        return nullptr;
+        return result;
 
     symbol upper("", SYMKIND_FUNCTION, ENDIAN_LITTLE, 0, addr, addr);
     auto it = m_functions.upper_bound(upper);
 
     // find first that is not greater than addr
     const symbol& sym = *--it;
-    return sym.memory().includes(addr) ? &sym : nullptr;
+    return sym.memory().includes(addr) ? closest(result, &sym) : result;
 }
 
 const symbol* symtab::find_object(const string& name) const {
     const auto it = m_object_names.find(name);
-    return it != m_object_names.end() ? it->second : nullptr;
+    if (it != m_object_names.end())
+        return it->second;
+
+    for (const auto& file : m_files)
+        if (const symbol* sym = file->find_object(name))
+            return sym;
+
+    return nullptr;
 }
 
 const symbol* symtab::find_object(u64 addr) const {
+    const symbol* result = nullptr;
+    for (const auto& file : m_files)
+        result = closest(result, file->find_object(addr));
+
     if (m_objects.empty())
-        return nullptr;
+        return result;
     if (addr < m_objects.begin()->virt_addr())
-        return nullptr;
+        return result;
     if (addr > m_objects.rbegin()->memory().end)
-        return nullptr;
+        return result;
 
     symbol upper("", SYMKIND_OBJECT, ENDIAN_LITTLE, 0, addr, addr);
     auto it = m_objects.upper_bound(upper);
 
     // find first that is not greater than addr
     const symbol& sym = *--it;
-    return sym.memory().includes(addr) ? &sym : nullptr;
+    return sym.memory().includes(addr) ? closest(result, &sym) : result;
 }
 
 void symtab::merge(const symtab& other) {
@@ -122,37 +415,31 @@ void symtab::merge(const symtab& other) {
         insert_function(func);
     for (const auto& obj : other.m_objects)
         insert_object(obj);
+    for (const auto& file : other.m_files)
+        attach(file);
+}
+
+void symtab::attach(const shared_ptr<symfile>& file) {
+    if (!stl_contains(m_files, file))
+        m_files.push_back(file);
 }
 
 u64 symtab::load_elf(const string& filename) {
     if (!mwr::file_exists(filename))
         return 0;
 
-    mwr::elf reader(filename);
-    endianess endian = reader.is_big_endian() ? ENDIAN_BIG : ENDIAN_LITTLE;
-
-    for (const auto& symbol : reader.symbols()) {
-        switch (symbol.kind) {
-        case mwr::elf::KIND_OBJECT:
-        case mwr::elf::KIND_COMMON:
-        case mwr::elf::KIND_TLS:
-            insert({ symbol.name, SYMKIND_OBJECT, endian, symbol.size,
-                     symbol.virt, symbol.phys });
-            break;
-
-        case mwr::elf::KIND_FUNC:
-            insert({ symbol.name, SYMKIND_FUNCTION, endian, symbol.size,
-                     symbol.virt, symbol.phys });
-            break;
-
-        case mwr::elf::KIND_UNKNOWN:
-        case mwr::elf::KIND_NONE:
-        default:
-            break;
-        }
-    }
+    startup_scope scope(filename.c_str(), "load_symbols");
+    shared_ptr<symfile> file = symfile::open(filename);
+    VCML_REPORT_ON(!file->error().empty(), "%s", file->error().c_str());
+
+    attach(file);
+    return file->count();
+}
 
-    return reader.symbols().size();
+void symtab::load_elf_async(const string& filename) {
+    shared_ptr<symfile> file = symfile::open(filename);
+    file->prefetch();
+    attach(file);
 }
 
 void symtab::insert_function(const symbol& sym) {
@@ -73,6 +73,8 @@ target::target(const string& name):
     m_symbols(),
     m_steppers(),
     m_bbtracer(),
+    m_bbbatch(),
+    m_bbbatch_size(0),
     m_breakpoints(),
     m_watchpoints() {
     if (stl_contains(s_targets, m_name))
@@ -484,6 +486,13 @@ void target::notify_singlestep() {
 }
 
 void target::notify_basic_block(u64 pc, size_t blksz, size_t icount) {
+    if (m_bbbatch_size > 0) {
+        m_bbbatch.push_back({ pc, (u32)blksz, (u32)icount });
+        if (m_bbbatch.size() >= m_bbbatch_size)
+            flush_basic_blocks();
+        return;
+    }
+
     m_mtx.lock();
     vector<subscriber*> local(m_bbtracer);
     m_mtx.unlock();
@@ -492,6 +501,26 @@ void target::notify_basic_block(u64 pc, size_t blksz, size_t icount) {
         s->notify_basic_block(*this, pc, blksz, icount);
 }
 
+void target::set_basic_block_batch(size_t size) {
+    flush_basic_blocks();
+    m_bbbatch_size = size;
+    m_bbbatch.reserve(size);
+}
+
+void target::flush_basic_blocks() {
+    if (m_bbbatch.empty())
+        return;
+
+    m_mtx.lock();
+    vector<subscriber*> local(m_bbtracer);
+    m_mtx.unlock();
+
+    for (auto s : local)
+        s->notify_basic_blocks(*this, m_bbbatch.data(), m_bbbatch.size());
+
+    m_bbbatch.clear();
+}
+
 bool target::trace_basic_blocks(subscriber* subscr) {
     lock_guard<mutex> guard(m_mtx);
     if (m_bbtracer.empty() && !start_basic_block_trace())
@@ -12,6 +12,7 @@
 #include "vcml/core/systemc.h"
 #include "vcml/core/version.h"
 #include "vcml/core/component.h"
+#include "vcml/core/processor.h"
 
 #include "vcml/debugging/vspserver.h"
 #include "vcml/debugging/target.h"
@@ -30,6 +31,9 @@ namespace debugging {
 
 static vspserver* session = nullptr;
 
+static const u64 VSP_MAX_BULK = 1 * MiB;
+static const size_t VSP_MAX_UPDATES = 4096;
+
 static void cleanup_session() {
     if (session != nullptr)
         session->cleanup();
@@ -295,6 +299,54 @@ static void list_json(ostream& os) {
     os << "}";
 }
 
+static void hash_combine(u64& hash, u64 val) {
+    hash ^= val + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+}
+
+static void hash_object(u64& hash, sc_object* obj) {
+    hash_combine(hash, (u64)(uintptr_t)obj);
+    hash_combine(hash, obj->attr_cltn().size());
+
+    if (module* mod = dynamic_cast<module*>(obj))
+        hash_combine(hash, mod->get_commands().size());
+
+    for (sc_object* child : obj->get_child_objects())
+        hash_object(hash, child); // recursive call
+}
+
+// cheap fingerprint of everything list_xml and list_json report, used to
+// decide whether the cached listings are still up to date
+static u64 hierarchy_hash() {
+    u64 hash = 0;
+    for (auto obj : sc_core::sc_get_top_level_objects())
+        hash_object(hash, obj);
+
+    for (auto tgt : debugging::target::all())
+        hash_combine(hash, (u64)(uintptr_t)tgt);
+    for (auto loader : debugging::loader::all())
+        hash_combine(hash, (u64)(uintptr_t)loader);
+    for (auto kbd : ui::input::all<ui::keyboard>())
+        hash_combine(hash, (u64)(uintptr_t)kbd);
+    for (auto ptr : ui::input::all<ui::mouse>())
+        hash_combine(hash, (u64)(uintptr_t)ptr);
+    for (auto terminal : serial::terminal::all())
+        hash_combine(hash, (u64)(uintptr_t)terminal);
+    for (auto bridge : ethernet::bridge::all())
+        hash_combine(hash, (u64)(uintptr_t)bridge);
+
+    return hash;
+}
+
+static string hex_string(const vector<u8>& data) {
+    string s;
+    s.reserve(data.size() * 2);
+    for (u8 byte : data) {
+        s += to_hex_ascii(byte >> 4);
+        s += to_hex_ascii(byte);
+    }
+    return s;
+}
+
 vspserver* vspserver::instance() {
     return session;
 }
@@ -369,20 +421,32 @@ string vspserver::handle_list(const string& cmd) {
     if (args.size() > 1)
         format = to_lower(args[1]);
 
-    stringstream ss;
-    ss << "OK,";
-
-    if (format == "xml") {
-        list_xml(ss);
-        return ss.str();
+    string* cache = nullptr;
+    if (format == "xml")
+        cache = &m_list_xml;
+    else if (format == "json")
+        cache = &m_list_json;
+    else
+        return mkstr("E,unknown hierarchy format '%s'", format.c_str());
+
+    u64 hash = hierarchy_hash();
+    if (hash != m_list_hash) {
+        m_list_xml.clear();
+        m_list_json.clear();
+        m_list_hash = hash;
     }
 
-    if (format == "json") {
-        list_json(ss);
-        return ss.str();
+    if (cache->empty()) {
+        stringstream ss;
+        ss << "OK,";
+        if (cache == &m_list_xml)
+            list_xml(ss);
+        else
+            list_json(ss);
+        *cache = ss.str();
     }
 
-    return mkstr("E,unknown hierarchy format '%s'", format.c_str());
+    return *cache;
 }
 
 string vspserver::handle_exec(const string& cmd) {
@@ -678,6 +742,213 @@ string vspserver::handle_vwrite(const string& cmd) {
     return mkstr("OK,%zu bytes written", n);
 }
 
+string vspserver::handle_xread(const string& cmd) {
+    if (is_running())
+        return "E,simulation running";
+
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 4)
+        return mkstr("E,insufficient arguments %zu", args.size());
+
+    target* tgt = target::find(args[1]);
+    if (tgt == nullptr)
+        return mkstr("E,no such target: %s", args[1].c_str());
+
+    u64 addr = from_string<u64>(args[2]);
+    u64 size = from_string<u64>(args[3]);
+    if (size > VSP_MAX_BULK)
+        return mkstr("E,too much data requested %llu / %llu", size,
+                     VSP_MAX_BULK);
+
+    string data(size, '\0');
+    u64 n = tgt->read_vmem_dbg(addr, data.data(), data.size());
+    data.resize(n);
+
+    return "OK," + data;
+}
+
+bool vspserver::parse_probe(const string& desc, probe& p, string& err) const {
+    vector<string> args = split(desc, ':');
+    p = { PROBE_ATTR, nullptr, nullptr, nullptr, 0 };
+
+    if (args.size() == 2 && args[0] == "attr") {
+        p.attr = find_attribute(args[1]);
+        if (p.attr == nullptr)
+            err = mkstr("attribute '%s' not found", args[1].c_str());
+        return p.attr != nullptr;
+    }
+
+    if (args.size() == 3 && args[0] == "reg") {
+        target* tgt = target::find(args[1]);
+        if (tgt == nullptr) {
+            err = mkstr("no such target: %s", args[1].c_str());
+            return false;
+        }
+
+        p.kind = PROBE_REG;
+        p.reg = tgt->find_cpureg(args[2]);
+        if (p.reg == nullptr)
+            err = mkstr("no such register: %s", args[2].c_str());
+        return p.reg != nullptr;
+    }
+
+    if (args.size() < 2) {
+        err = mkstr("invalid probe '%s'", desc.c_str());
+        return false;
+    }
+
+    p.cpu = dynamic_cast<processor*>(find_object(args[1]));
+    if (p.cpu == nullptr) {
+        err = mkstr("no such processor: %s", args[1].c_str());
+        return false;
+    }
+
+    if (args.size() == 2 && args[0] == "cycles") {
+        p.kind = PROBE_CYCLES;
+        return true;
+    }
+
+    if (args.size() == 2 && args[0] == "cps") {
+        p.kind = PROBE_CPS;
+        return true;
+    }
+
+    if (args.size() == 3 && args[0] == "irq") {
+        p.kind = PROBE_IRQ;
+        p.irq = from_string<size_t>(args[2]);
+        return true;
+    }
+
+    err = mkstr("invalid probe '%s'", desc.c_str());
+    return false;
+}
+
+string vspserver::read_probe(const probe& p) const {
+    switch (p.kind) {
+    case PROBE_ATTR: {
+        property_base* prop = dynamic_cast<property_base*>(p.attr);
+        return escape(prop ? prop->str() : p.attr->name(), ",");
+    }
+
+    case PROBE_REG: {
+        vector<u8> data(p.reg->total_size());
+        if (!p.reg->read(data.data(), data.size()))
+            return "?";
+        return hex_string(data);
+    }
+
+    case PROBE_CYCLES:
+        return mkstr("%llu", p.cpu->cycle_count());
+
+    case PROBE_CPS:
+        return mkstr("%.0f", p.cpu->get_cps());
+
+    case PROBE_IRQ: {
+        irq_stats stats;
+        if (!p.cpu->get_irq_stats(p.irq, stats))
+            return "0:0";
+        return mkstr("%zu:%llu", stats.irq_count,
+                     time_to_ns(stats.irq_uptime));
+    }
+
+    default:
+        return "?";
+    }
+}
+
+// invoked from the simulation thread at the end of each time step, so that
+// all probes are read while the models are in a consistent state
+void vspserver::sample_telemetry() {
+    if (!m_telemetry.load(std::memory_order_relaxed))
+        return;
+
+    lock_guard<mutex> guard(m_telemetry_mtx);
+    u64 sim_now = time_to_ns(sc_time_stamp());
+    u64 host_now = mwr::timestamp_us();
+
+    for (subscription& sub : m_subscriptions) {
+        u64 now = sub.host_time ? host_now : sim_now;
+        if (now < sub.next)
+            continue;
+
+        stringstream ss;
+        ss << "vsp:" << sub.id << "," << sim_now;
+        for (const probe& p : sub.probes)
+            ss << "," << read_probe(p);
+        // drop the oldest updates if the client cannot keep up
+        if (m_updates.size() >= VSP_MAX_UPDATES)
+            m_updates.pop_front();
+        m_updates.push_back(ss.str());
+
+        sub.next = now + sub.period;
+        if (sub.next <= now)
+            sub.next = now + 1;
+    }
+}
+
+string vspserver::handle_subscribe(const string& cmd) {
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 4)
+        return mkstr("E,insufficient arguments %zu", args.size());
+
+    subscription sub;
+    if (args[1] == "sim")
+        sub.host_time = false;
+    else if (args[1] == "host")
+        sub.host_time = true;
+    else
+        return mkstr("E,invalid time base '%s'", args[1].c_str());
+
+    sc_time period = from_string<sc_time>(args[2]);
+    if (period == SC_ZERO_TIME)
+        return "E,invalid sampling period";
+
+    sub.period = sub.host_time ? time_to_us(period) : time_to_ns(period);
+    if (sub.period == 0)
+        sub.period = 1;
+
+    for (size_t i = 3; i < args.size(); i++) {
+        probe p;
+        string err;
+        if (!parse_probe(args[i], p, err))
+            return "E," + err;
+        sub.probes.push_back(p);
+    }
+
+    lock_guard<mutex> guard(m_telemetry_mtx);
+    sub.id = m_next_subscription++;
+    sub.next = 0;
+    m_subscriptions.push_back(std::move(sub));
+    m_telemetry = true;
+    set_idle_timeout(10);
+
+    return mkstr("OK,%llu", m_subscriptions.back().id);
+}
+
+string vspserver::handle_unsubscribe(const string& cmd) {
+    vector<string> args = split(cmd, ',');
+    if (args.size() < 2)
+        return mkstr("E,insufficient arguments %zu", args.size());
+
+    u64 id = from_string<u64>(args[1]);
+
+    lock_guard<mutex> guard(m_telemetry_mtx);
+    auto it = std::find_if(m_subscriptions.begin(), m_subscriptions.end(),
+                           [id](const subscription& sub) -> bool {
+                               return sub.id == id;
+                           });
+    if (it == m_subscriptions.end())
+        return mkstr("E,invalid subscription id: %llu", id);
+
+    m_subscriptions.erase(it);
+    if (m_subscriptions.empty()) {
+        m_telemetry = false;
+        set_idle_timeout(0);
+    }
+
+    return "OK";
+}
+
 void vspserver::resume_simulation(const sc_time& duration) {
     if (is_suspending()) {
         m_stop_reason.clear();
@@ -726,11 +997,29 @@ vspserver::vspserver(u16 server_port):
     subscriber(),
     m_announce(mwr::temp_dir() + mkstr("/vcml_session_%hu", port())),
     m_stop_reason("elaboration"),
-    m_duration() {
+    m_duration(),
+    m_breakpoints(),
+    m_telemetry_mtx(),
+    m_telemetry(false),
+    m_next_subscription(0),
+    m_subscriptions(),
+    m_updates(),
+    m_list_hash(0),
+    m_list_xml(),
+    m_list_json() {
     VCML_ERROR_ON(session != nullptr, "vspserver already created");
     session = this;
     atexit(&cleanup_session);
 
+    static bool sampling = false;
+    if (!sampling) {
+        on_each_time_step([]() -> void {
+            if (session != nullptr)
+                session->sample_telemetry();
+        });
+        sampling = true;
+    }
+
     register_handler("version", &vspserver::handle_version);
     register_handler("status", &vspserver::handle_status);
     register_handler("resume", &vspserver::handle_resume);
@@ -751,6 +1040,9 @@ vspserver::vspserver(u16 server_port):
     register_handler("vapa", &vspserver::handle_vapa);
     register_handler("vread", &vspserver::handle_vread);
     register_handler("vwrite", &vspserver::handle_vwrite);
+    register_handler("xread", &vspserver::handle_xread);
+    register_handler("subscribe", &vspserver::handle_subscribe);
+    register_handler("unsubscribe", &vspserver::handle_unsubscribe);
 
     // Create announce file
     ofstream of(m_announce.c_str());
@@ -806,9 +1098,29 @@ void vspserver::handle_connect(const char* peer) {
 }
 
 void vspserver::handle_disconnect() {
+    lock_guard<mutex> guard(m_telemetry_mtx);
+    m_subscriptions.clear();
+    m_updates.clear();
+    m_telemetry = false;
+    set_idle_timeout(0);
+
     if (sim_running())
         log_info("vspserver waiting on port %hu", port());
 }
 
+void vspserver::handle_idle() {
+    deque<string> updates;
+    {
+        lock_guard<mutex> guard(m_telemetry_mtx);
+        updates.swap(m_updates);
+    }
+
+    for (const string& update : updates) {
+        if (!is_connected())
+            break;
+        send_notification(update);
+    }
+}
+
 } // namespace debugging
 } // namespace vcml
@@ -0,0 +1,434 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/logging/binlog.h"
+#include "vcml/core/systemc.h"
+
+namespace vcml {
+
+atomic<bool> g_binlog_enabled(false);
+
+struct binlog_header {
+    const char* format;
+    const mwr::logger* sender;
+    const char* file;
+    u64 timestamp;
+    u32 line;
+    u32 level;
+    u32 size;
+};
+
+constexpr size_t BINLOG_RING_SIZE = 256 * KiB;
+constexpr size_t BINLOG_ALIGN = 16;
+
+static size_t binlog_align(size_t size) {
+    return (size + BINLOG_ALIGN - 1) & ~(BINLOG_ALIGN - 1);
+}
+
+// single-producer single-consumer ring owned by one logging thread; records
+// that do not fit at the end are preceded by a padding record without format
+// or, if not even a header fits there, by an implicit skip to the beginning
+struct binlog_ring {
+    atomic<u64> head;
+    atomic<u64> tail;
+    atomic<bool> orphaned;
+    vector<u8> data;
+
+    binlog_ring(): head(0), tail(0), orphaned(false), data(BINLOG_RING_SIZE) {}
+
+    bool push(const binlog_header& hdr, const u8* args, size_t len);
+    bool pop(binlog_header& hdr, vector<u8>& args);
+};
+
+bool binlog_ring::push(const binlog_header& hdr, const u8* args, size_t len) {
+    size_t cap = data.size();
+    u64 h = head.load(std::memory_order_relaxed);
+    u64 t = tail.load(std::memory_order_acquire);
+
+    size_t pos = h % cap;
+    size_t pad = cap - pos < hdr.size ? cap - pos : 0;
+    if (cap - (h - t) < pad + hdr.size)
+        return false;
+
+    if (pad > 0) {
+        if (pad >= sizeof(binlog_header)) {
+            binlog_header filler{};
+            filler.size = pad;
+            memcpy(data.data() + pos, &filler, sizeof(filler));
+        }
+
+        h += pad;
+        pos = 0;
+    }
+
+    memcpy(data.data() + pos, &hdr, sizeof(hdr));
+    memcpy(data.data() + pos + sizeof(hdr), args, len);
+    head.store(h + hdr.size, std::memory_order_release);
+    return true;
+}
+
+bool binlog_ring::pop(binlog_header& hdr, vector<u8>& args) {
+    size_t cap = data.size();
+    u64 t = tail.load(std::memory_order_relaxed);
+    u64 h = head.load(std::memory_order_acquire);
+
+    while (t != h) {
+        size_t pos = t % cap;
+        if (cap - pos < sizeof(hdr)) {
+            t += cap - pos;
+            continue;
+        }
+
+        memcpy(&hdr, data.data() + pos, sizeof(hdr));
+        if (hdr.format == nullptr) {
+            t += hdr.size;
+            continue;
+        }
+
+        const u8* ptr = data.data() + pos + sizeof(hdr);
+        args.assign(ptr, ptr + hdr.size - sizeof(hdr));
+        tail.store(t + hdr.size, std::memory_order_release);
+        return true;
+    }
+
+    tail.store(t, std::memory_order_release);
+    return false;
+}
+
+class binlog_publisher
+{
+private:
+    mutex m_mtx;
+    mutex m_drain_mtx;
+    condition_variable m_notify;
+    vector<shared_ptr<binlog_ring>> m_rings;
+    atomic<bool> m_running;
+    thread m_worker;
+
+    void drain();
+    void work();
+
+public:
+    binlog_publisher();
+    ~binlog_publisher();
+
+    shared_ptr<binlog_ring> create_ring();
+
+    void start();
+    void stop();
+    void flush();
+
+    static binlog_publisher& instance();
+};
+
+static thread_local bool g_replaying = false;
+static thread_local u64 g_replay_time = 0;
+
+static void binlog_publish(const binlog_header& hdr, const string& msg) {
+    mwr::logger* sender = const_cast<mwr::logger*>(hdr.sender);
+
+    g_replaying = true;
+    g_replay_time = hdr.timestamp;
+
+    sender->log((log_level)hdr.level, hdr.file, hdr.line, "%s", msg.c_str());
+
+    g_replaying = false;
+}
+
+void binlog_publisher::drain() {
+    lock_guard<mutex> guard(m_drain_mtx);
+
+    vector<shared_ptr<binlog_ring>> rings;
+    {
+        lock_guard<mutex> lock(m_mtx);
+        rings = m_rings;
+    }
+
+    binlog_header hdr;
+    vector<u8> args;
+    for (const auto& ring : rings) {
+        bool orphaned = ring->orphaned;
+        while (ring->pop(hdr, args)) {
+            string msg = binlog_render(hdr.format, args.data(), args.size());
+            binlog_publish(hdr, msg);
+        }
+
+        if (orphaned) {
+            lock_guard<mutex> lock(m_mtx);
+            stl_remove(m_rings, ring);
+        }
+    }
+}
+
+void binlog_publisher::work() {
+    mwr::set_thread_name("vcml_binlog");
+    std::unique_lock<mutex> lock(m_mtx);
+    while (m_running) {
+        m_notify.wait_for(lock, std::chrono::milliseconds(10));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+binlog_publisher::binlog_publisher():
+    m_mtx(), m_drain_mtx(), m_notify(), m_rings(), m_running(false) {
+}
+
+binlog_publisher::~binlog_publisher() {
+    stop();
+}
+
+shared_ptr<binlog_ring> binlog_publisher::create_ring() {
+    auto ring = std::make_shared<binlog_ring>();
+    lock_guard<mutex> guard(m_mtx);
+    m_rings.push_back(ring);
+    return ring;
+}
+
+void binlog_publisher::start() {
+    if (m_running.exchange(true))
+        return;
+    m_worker = thread(&binlog_publisher::work, this);
+}
+
+void binlog_publisher::stop() {
+    if (m_running.exchange(false)) {
+        m_notify.notify_all();
+        if (m_worker.joinable())
+            m_worker.join();
+    }
+
+    drain();
+}
+
+void binlog_publisher::flush() {
+    drain();
+}
+
+binlog_publisher& binlog_publisher::instance() {
+    static binlog_publisher publisher;
+    return publisher;
+}
+
+struct binlog_ring_handle {
+    shared_ptr<binlog_ring> ring;
+    binlog_ring_handle(): ring(binlog_publisher::instance().create_ring()) {}
+    ~binlog_ring_handle() { ring->orphaned = true; }
+};
+
+void binlog_enable(bool enable) {
+    binlog_publisher& publisher = binlog_publisher::instance();
+    if (enable) {
+        publisher.start();
+        g_binlog_enabled = true;
+    } else {
+        g_binlog_enabled = false;
+        publisher.stop();
+    }
+}
+
+void binlog_flush() {
+    binlog_publisher::instance().flush();
+}
+
+bool binlog_replay_time(u64& timestamp) {
+    if (!g_replaying)
+        return false;
+
+    timestamp = g_replay_time;
+    return true;
+}
+
+static bool binlog_next(const u8*& args, const u8* end, binlog_tag& tag,
+                        size_t& width, u64& val, const char*& str) {
+    if (args >= end)
+        return false;
+
+    tag = (binlog_tag)(*args & BINLOG_TYPE_MASK);
+    width = *args >> BINLOG_SIZE_SHIFT;
+    if (tag == BINLOG_STR) {
+        str = (const char*)args + 1;
+        args += 2 + strlen(str);
+        return true;
+    }
+
+    if (args + 1 + sizeof(val) > end)
+        return false;
+
+    memcpy(&val, args + 1, sizeof(val));
+    args += 1 + sizeof(val);
+    return true;
+}
+
+static u64 binlog_truncate(u64 val, size_t width) {
+    if (width == 0 || width >= sizeof(val))
+        return val;
+    return val & ((1ull << (width * 8)) - 1);
+}
+
+static i64 binlog_sign_extend(u64 val, size_t width) {
+    if (width == 0 || width >= sizeof(val))
+        return (i64)val;
+    u64 sign = 1ull << (width * 8 - 1);
+    return (i64)((binlog_truncate(val, width) ^ sign) - sign);
+}
+
+// Formats one conversion at a time using the original specification. Stored
+// arguments are 64bit wide, so they are first narrowed to their recorded size
+// or the size given by an h/hh length modifier, whichever is smaller, and
+// then formatted with a matching long long length modifier.
+string binlog_render(const char* format, const u8* args, size_t size) {
+    const u8* end = args + size;
+    stringstream ss;
+    char buf[BINLOG_MAX_STRLEN + 64];
+
+    for (const char* p = format; *p; p++) {
+        if (*p != '%') {
+            ss << *p;
+            continue;
+        }
+
+        if (p[1] == '%') {
+            ss << '%';
+            p++;
+            continue;
+        }
+
+        string spec = "%";
+        const char* q = p + 1;
+        while (*q && strchr("-+ #0123456789.*", *q)) {
+            if (*q == '*') {
+                binlog_tag tag;
+                size_t width = 0;
+                u64 val = 0;
+                const char* str = nullptr;
+                binlog_next(args, end, tag, width, val, str);
+                spec += std::to_string((int)val);
+            } else {
+                spec += *q;
+            }
+            q++;
+        }
+
+        size_t length = sizeof(u64);
+        if (*q == 'h')
+            length = q[1] == 'h' ? sizeof(u8) : sizeof(u16);
+        while (*q && strchr("hljztLq", *q))
+            q++;
+
+        char conv = *q;
+        if (conv == '\0')
+            break;
+
+        binlog_tag tag;
+        size_t width = 0;
+        u64 val = 0;
+        const char* str = nullptr;
+        if (!binlog_next(args, end, tag, width, val, str)) {
+            ss << "<?>";
+            p = q;
+            continue;
+        }
+
+        if (width == 0 || width > length)
+            width = length;
+
+        switch (conv) {
+        case 'd':
+        case 'i':
+            spec += "lld";
+            snprintf(buf, sizeof(buf), spec.c_str(),
+                     (long long)binlog_sign_extend(val, width));
+            break;
+
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            spec += "ll";
+            spec += conv;
+            snprintf(buf, sizeof(buf), spec.c_str(),
+                     (unsigned long long)binlog_truncate(val, width));
+            break;
+
+        case 'c':
+            spec += conv;
+            snprintf(buf, sizeof(buf), spec.c_str(), (int)val);
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': {
+            double d = 0.0;
+            if (tag == BINLOG_REAL)
+                memcpy(&d, &val, sizeof(d));
+            else
+                d = tag == BINLOG_SINT ? (double)(i64)val : (double)val;
+            spec += conv;
+            snprintf(buf, sizeof(buf), spec.c_str(), d);
+            break;
+        }
+
+        case 's':
+            spec += conv;
+            snprintf(buf, sizeof(buf), spec.c_str(),
+                     tag == BINLOG_STR ? str : "<?>");
+            break;
+
+        case 'p':
+            spec += conv;
+            snprintf(buf, sizeof(buf), spec.c_str(), (void*)(uintptr_t)val);
+            break;
+
+        default:
+            buf[0] = '\0';
+            break;
+        }
+
+        ss << buf;
+        p = q;
+    }
+
+    return ss.str();
+}
+
+void binlog_commit(const mwr::logger& sender, log_level lvl, const char* file,
+                   int line, const char* format, const u8* args, size_t size) {
+    static thread_local binlog_ring_handle handle;
+
+    binlog_header hdr;
+    hdr.format = format;
+    hdr.sender = &sender;
+    hdr.file = file;
+    hdr.line = line;
+    hdr.timestamp = time_to_ns(sc_time_stamp());
+    hdr.level = lvl;
+    hdr.size = binlog_align(sizeof(hdr) + size);
+
+    binlog_ring& ring = *handle.ring;
+    if (hdr.size > ring.data.size() / 2) {
+        // oversized records bypass the ring, so earlier ones must go first
+        binlog_publisher::instance().flush();
+        binlog_publish(hdr, binlog_render(format, args, size));
+        return;
+    }
+
+    // if the background thread cannot keep up, drain all rings ourselves
+    while (!ring.push(hdr, args, size))
+        binlog_publisher::instance().flush();
+}
+
+} // namespace vcml
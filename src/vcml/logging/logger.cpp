@@ -25,6 +25,12 @@ logger::logger(const string& name):
     mwr::logger(name), m_parent(hierarchy_search<module>()) {
 }
 
+logger::~logger() {
+    // deferred messages still refer to us as their sender
+    if (binlog_enabled())
+        binlog_flush();
+}
+
 bool logger::can_log(log_level lvl) const {
     log_level mylvl = m_parent ? m_parent->loglvl : level();
     return lvl <= mylvl;
@@ -33,6 +39,9 @@ bool logger::can_log(log_level lvl) const {
 logger log; // global default logger
 
 u64 log_systemc_time() {
+    u64 timestamp;
+    if (binlog_replay_time(timestamp))
+        return timestamp;
     return time_to_ns(sc_time_stamp());
 }
 
@@ -650,6 +650,8 @@ void gic400::distif::set_sgi_pending(u8 value, size_t sgi, size_t cpu,
 }
 
 void gic400::distif::end_of_elaboration() {
+    peripheral::end_of_elaboration();
+
     // SGIs are enabled per default and cannot be disabled
     for (size_t irq = 0; irq < NSGI; irq++)
         m_parent->enable_irq(irq, gic400::ALL_CPU);
@@ -1314,6 +1316,7 @@ void gic400::vcpuif::reset() {
 gic400::gic400(const sc_module_name& nm):
     peripheral(nm),
     secure("secure", false),
+    deferred_update("deferred_update", false),
     distif("distif"),
     cpuif("cpuif"),
     vifctrl("vifctrl"),
@@ -1326,7 +1329,8 @@ gic400::gic400(const sc_module_name& nm):
     virq_out("virq_out", NVCPU),
     m_irq_num(NPRIV),
     m_cpu_num(0),
-    m_irq_state() {
+    m_irq_state(),
+    m_update_ev("update_ev") {
     clk.bind(distif.clk);
     clk.bind(cpuif.clk);
     clk.bind(vifctrl.clk);
@@ -1335,6 +1339,11 @@ gic400::gic400(const sc_module_name& nm):
     rst.bind(cpuif.rst);
     rst.bind(vifctrl.rst);
     rst.bind(vcpuif.rst);
+
+    SC_HAS_PROCESS(gic400);
+    SC_METHOD(update_deferred);
+    sensitive << m_update_ev;
+    dont_initialize();
 }
 
 gic400::~gic400() {
@@ -1433,6 +1442,15 @@ pair<bool, bool> gic400::update_excp_state(size_t cpu, size_t& irq,
     return { next_irq, next_grp0 };
 }
 
+gpio_origin gic400::irq_origin(size_t cpu, size_t irq) {
+    // software generated interrupts have no source socket
+    if (irq >= NPRIV && irq < NIRQ && spi_in.exists(irq - NPRIV))
+        return spi_in[irq - NPRIV].origin();
+    if (irq >= NSGI && irq < NPRIV && ppi_in.exists(cpu * NPPI + irq - NSGI))
+        return ppi(cpu, irq - NSGI).origin();
+    return gpio_origin();
+}
+
 void gic400::update(bool virt) {
     for (int cpu = 0; cpu < m_cpu_num; cpu++) {
         size_t irq;
@@ -1471,6 +1489,8 @@ void gic400::update(bool virt) {
             }
         }
 
+        gpio_origin origin = irq_origin(cpu, virt ? SPURIOUS_IRQ : hppir);
+        gpio_origin_scope scope(origin);
         if (!virt) {
             cpuif.hppir.bank(cpu) = next_grp0 ? hppir : SPURIOUS_IRQ;
             cpuif.ahppir.bank(cpu) = next_grp0 ? SPURIOUS_IRQ : hppir;
@@ -1515,6 +1535,8 @@ u8 gic400::get_irq_priority(size_t cpu, size_t irq) {
 }
 
 void gic400::end_of_elaboration() {
+    peripheral::end_of_elaboration();
+
     m_cpu_num = 0;
     m_irq_num = NPRIV;
 
@@ -1564,7 +1586,10 @@ void gic400::handle_ppi(size_t cpu, size_t idx, bool state) {
     if (get_irq_trigger(irq) == EDGE && state)
         set_irq_pending(irq, true, mask);
 
-    update();
+    if (deferred_update)
+        m_update_ev.notify(SC_ZERO_TIME);
+    else
+        update();
 }
 
 void gic400::handle_spi(size_t idx, bool state) {
@@ -1576,6 +1601,13 @@ void gic400::handle_spi(size_t idx, bool state) {
     if (get_irq_trigger(irq) == EDGE && state)
         set_irq_pending(irq, true, target_cpu);
 
+    if (deferred_update)
+        m_update_ev.notify(SC_ZERO_TIME);
+    else
+        update();
+}
+
+void gic400::update_deferred() {
     update();
 }
 
@@ -127,6 +127,8 @@ pl190vic::pl190vic(const sc_module_name& nm):
 
     pid.allow_read_only();
     cid.allow_read_only();
+
+    map_shadow(range(0xfe0, 0xfff));
 }
 
 pl190vic::~pl190vic() {
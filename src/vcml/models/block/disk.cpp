@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/models/block/disk.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 namespace block {
@@ -61,6 +62,8 @@ disk::disk(const sc_module_name& nm, const string& img, bool ro):
     serial("serial", default_serial()),
     readonly("readonly", ro) {
     try {
+        debugging::startup_scope scope(name(), "create_backend",
+                                       image.get().c_str());
         m_backend = backend::create(image, readonly);
         readonly = !m_backend || m_backend->readonly();
     } catch (std::exception& ex) {
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/models/can/bridge.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 namespace can {
@@ -65,6 +66,9 @@ void bridge::can_receive(can_frame& frame) {
 }
 
 void bridge::can_transmit() {
+    if (m_replay.is_replaying())
+        can_replay();
+
     while (true) {
         wait(m_ev);
 
@@ -72,11 +76,27 @@ void bridge::can_transmit() {
         while (!m_rx.empty()) {
             can_frame frame = m_rx.front();
             m_rx.pop();
+            size_t size = offsetof(can_frame, data) + frame.length();
+            m_replay.record(&frame, size);
             can_tx.send(frame);
         }
     }
 }
 
+void bridge::can_replay() {
+    // frames from host backends are dropped during replay
+    vector<u8> data;
+    while (m_replay.wait_fetch(data)) {
+        can_frame frame;
+        memset(&frame, 0, sizeof(frame));
+        memcpy(&frame, data.data(), min(data.size(), sizeof(frame)));
+        can_tx.send(frame);
+    }
+
+    while (true)
+        wait(m_ev);
+}
+
 unordered_map<string, bridge*>& bridge::bridges() {
     static unordered_map<string, bridge*> instances;
     return instances;
@@ -91,6 +111,7 @@ bridge::bridge(const sc_module_name& nm):
     m_mtx(),
     m_rx(),
     m_ev("rxev"),
+    m_replay(name()),
     backends("backends", ""),
     can_tx("can_tx"),
     can_rx("can_rx") {
@@ -131,6 +152,9 @@ void bridge::send_to_host(const can_frame& frame) {
 }
 
 void bridge::send_to_guest(can_frame frame) {
+    if (m_replay.is_replaying())
+        return;
+
     lock_guard<mutex> guard(m_mtx);
     m_rx.push(frame);
     on_next_update([&]() -> void { m_ev.notify(SC_ZERO_TIME); });
@@ -150,6 +174,7 @@ void bridge::detach(backend* b) {
 
 size_t bridge::create_backend(const string& type) {
     auto guard = get_hierarchy_scope();
+    debugging::startup_scope scope(name(), "create_backend", type.c_str());
     m_dynamic_backends[m_next_id] = backend::create(this, type);
     return m_next_id++;
 }
@@ -13,17 +13,119 @@
 namespace vcml {
 namespace can {
 
-void bus::can_receive(const can_target_socket& rx, can_frame& frame) {
-    const can_initiator_socket& sender = peer_of(rx);
+void bus::deliver(can_frame& frame, size_t node) {
+    const can_initiator_socket& sender = can_tx[node];
     for (auto& tx : can_tx) {
-        if (tx.second != &sender)
+        if (tx.second != &sender) {
             tx.second->send(frame);
+            m_stats[tx.first].rx_frames++;
+        }
+    }
+}
+
+void bus::transmit() {
+    if (m_transmitting) {
+        m_transmitting = false;
+        deliver(m_current.frame, m_current.node);
+    }
+
+    if (m_pending.empty())
+        return;
+
+    auto winner = std::min_element(m_pending.begin(), m_pending.end(),
+                                   [](const pending& a, const pending& b) {
+                                       return a.key != b.key ? a.key < b.key
+                                                             : a.seq < b.seq;
+                                   });
+
+    for (const pending& p : m_pending) {
+        if (&p != &*winner && p.node != winner->node)
+            m_stats[p.node].arb_lost++;
+    }
+
+    m_current = *winner;
+    m_pending.erase(winner);
+
+    size_t data_bits = 0;
+    size_t bits = frame_bits(m_current.frame, data_bits);
+    sc_time duration = frame_duration(m_current.frame);
+
+    node_stats& st = m_stats[m_current.node];
+    st.tx_frames++;
+    st.tx_bits += bits + data_bits;
+    st.busy += duration;
+    if (m_current.frame.is_err())
+        st.errors++;
+
+    m_busy += duration;
+    m_transmitting = true;
+    m_ev.notify(duration);
+}
+
+void bus::can_receive(const can_target_socket& rx, can_frame& frame) {
+    size_t node = can_rx.index_of(rx);
+
+    if (!timed) {
+        node_stats& st = m_stats[node];
+        st.tx_frames++;
+        if (frame.is_err())
+            st.errors++;
+        deliver(frame, node);
+        return;
     }
+
+    m_pending.push_back({ frame, node, arbitration_key(frame), m_seq++ });
+    if (!m_transmitting)
+        m_ev.notify(SC_ZERO_TIME);
+}
+
+bool bus::cmd_stats(const vector<string>& args, ostream& os) {
+    os << "bus load: " << std::fixed << std::setprecision(1)
+       << bus_load() * 100.0 << "%, busy " << m_busy;
+
+    vector<size_t> nodes;
+    for (const auto& it : m_stats)
+        nodes.push_back(it.first);
+    std::sort(nodes.begin(), nodes.end());
+
+    for (size_t node : nodes) {
+        const node_stats& st = m_stats[node];
+        double load = sc_time_stamp() > SC_ZERO_TIME
+                          ? st.busy / sc_time_stamp() * 100.0
+                          : 0.0;
+        os << "\nnode " << node << ": " << st.tx_frames << " tx, "
+           << st.rx_frames << " rx, " << st.tx_bits << " bits, "
+           << st.arb_lost << " arbitration lost, " << st.errors
+           << " errors, load " << load << "%";
+    }
+
+    return true;
 }
 
 bus::bus(const sc_module_name& nm):
-    module(nm), can_host(), m_next_id(0), can_tx("can_tx"), can_rx("can_rx") {
-    // nothing to do
+    module(nm),
+    can_host(),
+    m_next_id(0),
+    m_pending(),
+    m_current(),
+    m_transmitting(false),
+    m_seq(0),
+    m_busy(),
+    m_ev("ev"),
+    m_stats(),
+    timed("timed", false),
+    bitrate("bitrate", 500000),
+    data_bitrate("data_bitrate", 2000000),
+    stuffing("stuffing", false),
+    can_tx("can_tx"),
+    can_rx("can_rx") {
+    SC_HAS_PROCESS(bus);
+    SC_METHOD(transmit);
+    sensitive << m_ev;
+    dont_initialize();
+
+    register_command("stats", 0, &bus::cmd_stats,
+                     "shows bus load and per-node frame statistics");
 }
 
 void bus::bind(can_initiator_socket& tx, can_target_socket& rx) {
@@ -35,6 +137,66 @@ void bus::bind(can_initiator_socket& tx, can_target_socket& rx) {
     m_next_id++;
 }
 
+size_t bus::frame_bits(const can_frame& frame, size_t& data_bits) const {
+    size_t n = frame.is_rtr() ? 0 : frame.length();
+    data_bits = 0;
+
+    if (!frame.is_fdf()) {
+        // SOF, identifier, control field, data and crc are subject to
+        // stuffing; crc delimiter, ack, eof and interframe space are not
+        size_t head = (frame.is_eff() ? 54 : 34) + 8 * n;
+        size_t bits = head + 13;
+        if (stuffing)
+            bits += (head - 1) / 4;
+        return bits;
+    }
+
+    // FD frames switch to the data bitrate after BRS until crc delimiter
+    size_t arb = frame.is_eff() ? 36 : 17;
+    size_t crc = n > 16 ? 21 : 17;
+    size_t data = 1 + 4 + 8 * n + 4 + crc + 1;
+    size_t tail = 12;
+
+    if (stuffing) {
+        arb += (arb - 1) / 4;
+        data += (5 + 8 * n) / 4 + (crc + 4) / 4 + 1;
+    }
+
+    if (!frame.is_brs())
+        return arb + data + tail;
+
+    data_bits = data;
+    return arb + tail;
+}
+
+sc_time bus::frame_duration(const can_frame& frame) const {
+    size_t data_bits = 0;
+    size_t bits = frame_bits(frame, data_bits);
+
+    double t = (double)bits / (double)bitrate;
+    if (data_bits > 0)
+        t += (double)data_bits / (double)data_bitrate;
+
+    return sc_time(t, SC_SEC);
+}
+
+double bus::bus_load() const {
+    sc_time now = sc_time_stamp();
+    return now > SC_ZERO_TIME ? m_busy / now : 0.0;
+}
+
+u32 bus::arbitration_key(const can_frame& frame) {
+    // the key orders frames like the dominant bits on the wire: base id,
+    // RTR (or SRR), IDE and for extended frames, id extension and RTR
+    u32 rtr = frame.is_rtr() ? 1 : 0;
+    if (!frame.is_eff())
+        return frame.id() << 21 | rtr << 20;
+
+    u32 base = (frame.id() >> 18) & CAN_SID;
+    u32 ext = frame.id() & bitmask(18);
+    return base << 21 | 1u << 20 | 1u << 19 | ext << 1 | rtr;
+}
+
 VCML_EXPORT_MODEL(vcml::can::bus, name, args) {
     return new bus(name);
 }
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/models/ethernet/bridge.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 namespace ethernet {
@@ -65,6 +66,9 @@ void bridge::eth_receive(const eth_frame& frame) {
 }
 
 void bridge::eth_transmit() {
+    if (m_replay.is_replaying())
+        eth_replay();
+
     while (true) {
         wait(m_ev);
 
@@ -72,11 +76,24 @@ void bridge::eth_transmit() {
         while (!m_rx.empty()) {
             eth_frame frame = std::move(m_rx.front());
             m_rx.pop();
+            m_replay.record(frame.data(), frame.size());
             eth_tx.send(frame);
         }
     }
 }
 
+void bridge::eth_replay() {
+    // frames from host backends are dropped during replay
+    vector<u8> data;
+    while (m_replay.wait_fetch(data)) {
+        eth_frame frame(std::move(data));
+        eth_tx.send(frame);
+    }
+
+    while (true)
+        wait(m_ev);
+}
+
 unordered_map<string, bridge*>& bridge::bridges() {
     static unordered_map<string, bridge*> instances;
     return instances;
@@ -91,6 +108,7 @@ bridge::bridge(const sc_module_name& nm):
     m_mtx(),
     m_rx(),
     m_ev("rxev"),
+    m_replay(name()),
     backends("backends", ""),
     eth_tx("eth_tx"),
     eth_rx("eth_rx") {
@@ -131,6 +149,9 @@ void bridge::send_to_host(const eth_frame& frame) {
 }
 
 void bridge::send_to_guest(eth_frame frame) {
+    if (m_replay.is_replaying())
+        return;
+
     lock_guard<mutex> guard(m_mtx);
     m_rx.push(std::move(frame));
     on_next_update([&]() -> void { m_ev.notify(SC_ZERO_TIME); });
@@ -150,6 +171,7 @@ void bridge::detach(backend* b) {
 
 size_t bridge::create_backend(const string& type) {
     auto guard = get_hierarchy_scope();
+    debugging::startup_scope scope(name(), "create_backend", type.c_str());
     m_dynamic_backends[m_next_id] = backend::create(this, type);
     return m_next_id++;
 }
@@ -142,12 +142,26 @@ void ethoc::rx_process() {
 }
 
 void ethoc::tx_poll() {
+    // transmit all ready buffers until an interrupt needs handling
+    size_t n = 0;
+    while (n < num_txbd() && tx_next())
+        n++;
+}
+
+void ethoc::rx_poll() {
+    // receive into all empty buffers until an interrupt needs handling
+    size_t n = 0;
+    while (n < num_rxbd() && rx_next())
+        n++;
+}
+
+bool ethoc::tx_next() {
     if (irq.read())
-        return;
+        return false;
 
     descriptor bd = current_txbd();
     if (!(bd.info & TXBD_RD))
-        return;
+        return false;
 
     bd.info &= ~(TXBD_UR | TXBD_RL | TXBD_LC | TXBD_DF | TXBD_CS);
     u32 packet_length = bd.info >> TXBD_LEN_O;
@@ -166,15 +180,17 @@ void ethoc::tx_poll() {
     m_tx_idx++;
     if ((m_tx_idx >= num_txbd()) || (bd.info & TXBD_WR))
         m_tx_idx = 0;
+
+    return success;
 }
 
-void ethoc::rx_poll() {
+bool ethoc::rx_next() {
     if (irq.read())
-        return;
+        return false;
 
     descriptor bd = current_rxbd();
     if (!(bd.info & RXBD_E))
-        return;
+        return false;
 
     bd.info &= ~(RXBD_M | RXBD_OR | RXBD_IS | RXBD_DN);
     bd.info &= ~(RXBD_TL | RXBD_SF | RXBD_LC);
@@ -182,7 +198,7 @@ void ethoc::rx_poll() {
     u32 packet_length = 0;
     bool success = rx_packet(bd.addr, packet_length);
     if (success && (packet_length == 0))
-        return; // nothing received
+        return false; // nothing received
     if (success && (bd.info & RXBD_IRQ))
         interrupt(INT_SOURCE_RXB);
     if (!success)
@@ -198,6 +214,8 @@ void ethoc::rx_poll() {
     m_rx_idx++;
     if ((m_rx_idx >= ETHOC_NUMBD) || (bd.info & RXBD_WRAP))
         m_rx_idx = num_txbd();
+
+    return success;
 }
 
 bool ethoc::tx_packet(u32 addr, u32 length) {
@@ -206,22 +224,20 @@ bool ethoc::tx_packet(u32 addr, u32 length) {
         return false;
     }
 
-    vector<u8> buffer(length);
-    tlm_response_status rs = out.read(addr, buffer.data(), buffer.size());
+    eth_frame frame;
+    frame.resize(length);
+    tlm_response_status rs = out.read(addr, frame.data(), frame.size());
     if (failed(rs)) {
         log_warn("tx error  %s while reading from 0x%08x",
                  tlm_response_to_str(rs), addr);
         return false;
     }
 
-    stringstream ss;
-    for (unsigned int i = 0; i < length; i++) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)buffer[i]
-           << " ";
-    }
-
-    log_debug("sending packet:\n%s", ss.str().c_str());
-    eth_tx.send(buffer);
+    // frame contents are visible via eth_tx tracing
+    if (moder & MODER_LOOPBCK)
+        eth_receive(frame);
+    else
+        eth_tx.send(frame);
 
     return true;
 }
@@ -231,14 +247,6 @@ bool ethoc::rx_packet(u32 addr, u32& size) {
     if (!eth_rx_pop(frame))
         return true;
 
-    stringstream ss;
-    for (u8 data : frame) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << (int)data
-           << " ";
-    }
-
-    log_debug("received packet:\n%s", ss.str().c_str());
-
     // promiscuous mode disabled, check destination HW address
     if (!(moder & MODER_PRO)) {
         mac_addr dest = frame.destination();
@@ -606,6 +606,16 @@ void lan9118::reset_fifo_size(size_t txff_size) {
     m_rx_status_fifo_size = rxff_size / 16;
     m_rx_data_fifo_size = rxff_size - m_rx_status_fifo_size;
 
+    // resizing keeps pending data unless it no longer fits
+    if (m_tx_status_fifo.num_used() > m_tx_status_fifo_size / 4 ||
+        m_rx_status_fifo.num_used() > m_rx_status_fifo_size / 4 ||
+        m_rx_data_fifo.num_used() > m_rx_data_fifo_size / 4)
+        log_warn("FIFO shrunk below its fill level, dropping data");
+
+    m_tx_status_fifo.resize(m_tx_status_fifo_size / 4);
+    m_rx_status_fifo.resize(m_rx_status_fifo_size / 4);
+    m_rx_data_fifo.resize(m_rx_data_fifo_size / 4);
+
     log_debug("TX STATUS FIFO: %zu bytes", m_tx_status_fifo_size);
     log_debug("TX DATA FIFO:   %zu bytes", m_tx_data_fifo_size);
     log_debug("RX STATUS FIFO: %zu bytes", m_rx_status_fifo_size);
@@ -685,35 +695,16 @@ bool lan9118::rx_enqueue(const vector<u8>& pkt) {
     size_t offset = extract(rx_cfg.get(), 8, 5);
     size_t padding = calc_rx_padding(rx_cfg, pkt.size(), offset);
     size_t length = pkt.size() + sizeof(crc) + offset + padding * 4;
-    if (rx_data_free() < length)
+    size_t ndw = (offset + pkt.size() + sizeof(crc) + 3) / 4 + padding;
+    if (rx_data_free() < ndw * 4 || rx_status_full())
         return false;
 
-    while (offset > 4) {
-        m_rx_data_fifo.push_back(0);
-        offset -= 4;
-    }
-
-    u32 val = 0;
-    for (u8 src : pkt) {
-        val = (val >> 8) | (src << 24);
-        if (++offset >= 4) {
-            m_rx_data_fifo.push_back(val);
-            val = offset = 0;
-        }
-    }
-
-    if (offset > 0) {
-        val >>= (4 - offset) * 8;
-        val |= crc << (offset * 8);
-        m_rx_data_fifo.push_back(val);
-        val = crc >> (4 - offset) * 8;
-        m_rx_data_fifo.push_back(val);
-    } else {
-        m_rx_data_fifo.push_back(crc);
-    }
-
-    while (padding--)
-        m_rx_data_fifo.push_back(0);
+    // assemble offset, frame, crc and padding, then copy it in one go
+    m_rx_words.assign(ndw, 0);
+    u8* ptr = (u8*)m_rx_words.data() + offset;
+    memcpy(ptr, pkt.data(), pkt.size());
+    memcpy(ptr + pkt.size(), &crc, sizeof(crc));
+    m_rx_data_fifo.push(m_rx_words.data(), ndw);
 
     u32 status = (length << 16) & PKT_RXSTS_LEN_MASK;
     if (!filter)
@@ -722,7 +713,7 @@ bool lan9118::rx_enqueue(const vector<u8>& pkt) {
         status |= PKT_RXSTS_BROADCAST;
     else if (dest.is_multicast())
         status |= PKT_RXSTS_MULTICAST;
-    m_rx_status_fifo.push_back(status);
+    m_rx_status_fifo.push(status);
 
     return true;
 }
@@ -756,8 +747,9 @@ void lan9118::tx_thread() {
             wait(m_txev);
         }
 
-        packet pkt = m_tx_packets.front();
+        packet pkt = std::move(m_tx_packets.front());
         m_tx_packets.pop_front();
+        m_tx_packets_dw -= pkt.used_dw;
 
         if (pkt.length < 64 && !(pkt.cmdb & CMDB_PAD_DIS)) {
             for (size_t i = pkt.length; i < 64; i++)
@@ -774,8 +766,7 @@ void lan9118::tx_thread() {
         // status |= PKT_STS_EX_COL;
         // status |= PKT_STS_ERROR;
 
-        if (!tx_status_full())
-            m_tx_status_fifo.push_back(status);
+        m_tx_status_fifo.push(status);
 
         if (pkt.cmda & CMDA_TX_IOC)
             irq_sts |= IRQ_TXIOC;
@@ -784,24 +775,32 @@ void lan9118::tx_thread() {
     }
 }
 
-u32 lan9118::read_rx_data_fifo() {
-    if (m_rx_data_fifo.empty()) {
+size_t lan9118::rx_data_pop(u32* data, size_t count) {
+    size_t n = data ? m_rx_data_fifo.pop(data, count)
+                    : m_rx_data_fifo.drop(count);
+
+    if (n < count) {
+        if (data)
+            memset(data + n, 0, (count - n) * sizeof(*data));
         irq_sts |= IRQ_RXE;
-        return 0;
     }
 
-    u32 val = m_rx_data_fifo.front();
-    m_rx_data_fifo.pop_front();
-
     u32 dma = rx_cfg.get_field<RX_CFG_DMA_COUNT>();
-    if (dma > 0) {
-        rx_cfg.set_field<RX_CFG_DMA_COUNT>(--dma);
+    if (dma > 0 && n > 0) {
+        dma -= min<size_t>(dma, n);
+        rx_cfg.set_field<RX_CFG_DMA_COUNT>(dma);
         if (dma == 0) {
             irq_sts |= IRQ_RXD;
             update_irq();
         }
     }
 
+    return n;
+}
+
+u32 lan9118::read_rx_data_fifo() {
+    u32 val = 0;
+    rx_data_pop(&val, 1);
     return val;
 }
 
@@ -818,6 +817,32 @@ static size_t calc_tx_padding(u32 cmda, size_t off, size_t length) {
     }
 }
 
+void lan9118::tx_data_push(const u32* data, size_t count) {
+    while (count > 0) {
+        // copy payload words in bulk, but leave the last word of a buffer to
+        // write_tx_data_fifo so that it can finish the packet
+        size_t n = 0;
+        if (m_tx_pkt.state == packet::DATA && m_tx_pkt.offset == 0 &&
+            m_tx_pkt.remain > 0) {
+            n = min(count, (m_tx_pkt.remain - 1) / 4);
+            n = min(n, tx_data_free() / 4);
+        }
+
+        if (n > 0) {
+            const u8* bytes = (const u8*)data;
+            m_tx_pkt.data.insert(m_tx_pkt.data.end(), bytes, bytes + n * 4);
+            m_tx_pkt.remain -= n * 4;
+            m_tx_pkt.used_dw += n;
+        } else {
+            write_tx_data_fifo(*data);
+            n = 1;
+        }
+
+        data += n;
+        count -= n;
+    }
+}
+
 void lan9118::write_tx_data_fifo(u32 val) {
     if (tx_data_full()) {
         log_warn("TX error: FIFO overflow");
@@ -843,6 +868,7 @@ void lan9118::write_tx_data_fifo(u32 val) {
         if (m_tx_pkt.cmda & CMDA_FIRST) {
             m_tx_pkt.cmdb = val & CMDB_MASK;
             m_tx_pkt.length = extract(val, 0, 11);
+            m_tx_pkt.data.reserve(m_tx_pkt.length);
         }
 
         if (val != m_tx_pkt.cmdb) {
@@ -889,7 +915,8 @@ void lan9118::write_tx_data_fifo(u32 val) {
             update_irq();
         }
 
-        m_tx_packets.push_back(m_tx_pkt);
+        m_tx_packets_dw += m_tx_pkt.used_dw;
+        m_tx_packets.push_back(std::move(m_tx_pkt));
         m_tx_pkt.reset();
         m_txev.notify();
         break;
@@ -902,9 +929,7 @@ u32 lan9118::read_rx_status_fifo() {
         return 0;
     }
 
-    u32 val = m_rx_status_fifo.front();
-    m_rx_status_fifo.pop_front();
-    return val;
+    return m_rx_status_fifo.pop();
 }
 
 u32 lan9118::read_rx_status_peek() {
@@ -920,9 +945,7 @@ u32 lan9118::read_tx_status_fifo() {
     if (tx_status_full())
         m_txev.notify();
 
-    u32 val = m_tx_status_fifo.front();
-    m_tx_status_fifo.pop_front();
-    return val;
+    return m_tx_status_fifo.pop();
 }
 
 u32 lan9118::read_tx_status_peek() {
@@ -962,8 +985,8 @@ void lan9118::write_fifo_int(u32 val) {
 
 void lan9118::write_rx_cfg(u32 val) {
     if (val & RX_CFG_RX_DUMP) {
-        m_rx_data_fifo.clear();
-        m_rx_status_fifo.clear();
+        m_rx_data_fifo.reset();
+        m_rx_status_fifo.reset();
     }
 
     rx_cfg = val & RX_CFG_MASK;
@@ -976,10 +999,11 @@ void lan9118::write_rx_cfg(u32 val) {
 
 void lan9118::write_tx_cfg(u32 val) {
     if (val & TX_CFG_TXS_DUMP)
-        m_tx_status_fifo.clear();
+        m_tx_status_fifo.reset();
 
     if (val & TX_CFG_TXD_DUMP) {
         m_tx_packets.clear();
+        m_tx_packets_dw = 0;
         m_tx_pkt.reset();
     }
 
@@ -1018,21 +1042,20 @@ void lan9118::write_rx_dp_ctrl(u32 val) {
         size_t ndw = (length + offset) / 4 + padding;
         log_debug("triggering fast-forward for %zu dwords", ndw);
 
-        while (ndw--)
-            read_rx_data_fifo();
+        rx_data_pop(nullptr, ndw);
     }
 
     update_irq();
 }
 
 u32 lan9118::read_rx_fifo_inf() {
-    return ((m_rx_status_fifo.size() & 0xff) << 16) |
-           ((m_rx_data_fifo.size() * 4) & 0xffff);
+    return ((m_rx_status_fifo.num_used() & 0xff) << 16) |
+           (rx_data_used() & 0xffff);
 }
 
 u32 lan9118::read_tx_fifo_inf() {
-    return ((m_tx_status_fifo.size() & 0xff) << 16) |
-           ((m_tx_data_fifo_size - tx_data_used() * 4) & 0xffff);
+    return ((m_tx_status_fifo.num_used() & 0xff) << 16) |
+           (tx_data_free() & 0xffff);
 }
 
 void lan9118::write_pmt_ctrl(u32 val) {
@@ -1157,9 +1180,11 @@ lan9118::lan9118(const sc_module_name& nm):
     m_tx_status_fifo_size(),
     m_tx_pkt(),
     m_tx_packets(),
-    m_tx_status_fifo(),
-    m_rx_data_fifo(),
-    m_rx_status_fifo(),
+    m_tx_packets_dw(0),
+    m_tx_status_fifo(0),
+    m_rx_data_fifo(0),
+    m_rx_status_fifo(0),
+    m_rx_words(),
     eeprom_mac("eeprom_mac", "12:34:56:78:9a:bc"),
     rx_data_fifo("rx_data_fifo", 0x00, 0x00000000),
     tx_data_fifo("tx_data_fifo", 0x20, 0x00000000),
@@ -1340,6 +1365,7 @@ void lan9118::reset() {
 
     m_tx_pkt.reset();
     m_tx_packets.clear();
+    m_tx_packets_dw = 0;
 
     reset_fifo_size(5 * KiB);
 
@@ -1397,6 +1423,49 @@ void lan9118::update_irq() {
     irq_cfg |= IRQ_CFG_DEAS_STS;
 }
 
+unsigned int lan9118::transport(tlm_generic_payload& tx,
+                                const tlm_sbi& info, address_space as) {
+    u64 addr = tx.get_address();
+    unsigned int length = tx.get_data_length();
+    unsigned int swidth = tx.get_streaming_width();
+    if (swidth == 0 || swidth > length)
+        swidth = length;
+
+    // multi-word bursts into the data FIFO windows are served in one go,
+    // either as streaming accesses or as incrementing bursts in the window
+    reg<u32, 8>& window = tx.is_read() ? rx_data_fifo : tx_data_fifo;
+    range span(addr, addr + swidth - 1);
+    bool bulk = !info.is_debug && as == VCML_AS_DEFAULT && length > 4 &&
+                length % 4 == 0 && addr % 4 == 0 && !tx.get_byte_enable_ptr() &&
+                (swidth == 4 || swidth == length) &&
+                (tx.is_read() || tx.is_write()) &&
+                span.inside(window.get_range());
+    if (!bulk)
+        return peripheral::transport(tx, info, as);
+
+    unsigned int npulses = length / swidth;
+    unsigned int cycles = tx.is_read() ? read_latency : write_latency;
+    local_time() += clock_cycles(cycles * npulses);
+
+    sync(); // data FIFOs are sync_always
+
+    trace_fw(window, tx, local_time());
+
+    u32* data = (u32*)tx.get_data_ptr();
+    if (tx.is_read())
+        rx_data_pop(data, length / 4);
+    else
+        tx_data_push(data, length / 4);
+
+    tx.set_response_status(TLM_OK_RESPONSE);
+    trace_bw(window, tx, local_time());
+
+    if (needs_sync())
+        sync();
+
+    return length;
+}
+
 void lan9118::eth_link_up() {
     phy.set_link_status(true);
 }
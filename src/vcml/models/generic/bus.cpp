@@ -112,6 +112,8 @@ bool bus::cmd_mmap(const vector<string>& args, ostream& os) {
 }
 
 void bus::end_of_elaboration() {
+    component::end_of_elaboration();
+
     if (loglvl == LOG_DEBUG) {
         stringstream ss;
         do_mmap(ss);
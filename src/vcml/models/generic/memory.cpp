@@ -13,6 +13,10 @@
 namespace vcml {
 namespace generic {
 
+// while pages are still waiting for their poison value, DMI is only granted
+// for blocks of this size around the requested address
+static constexpr u64 LAZY_DMI_BLOCK = 2 * MiB;
+
 bool memory::cmd_show(const vector<string>& args, ostream& os) {
     u64 start = strtoull(args[0].c_str(), NULL, 0);
     u64 end = strtoull(args[1].c_str(), NULL, 0);
@@ -41,23 +45,54 @@ bool memory::cmd_show(const vector<string>& args, ostream& os) {
     return true;
 }
 
-u8* memory::allocate_image(u64 sz, u64 off) {
-    if (off >= size)
-        VCML_REPORT("offset 0x%llx exceeds memory size", off);
+void memory::load_bin(const string& filename, u64 offset) {
+    if (!map_images) {
+        loader::load_bin(filename, offset);
+        return;
+    }
 
-    if (sz + off > size)
-        VCML_REPORT("image too big for memory");
+    ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    VCML_REPORT_ON(!file, "cannot open file");
 
-    return m_memory.data() + off;
+    u64 filesz = file.tellg();
+    check_image(filesz, offset);
+
+    size_t mapped = m_memory.map_file(filename, offset, filesz);
+    if (mapped == 0) {
+        loader::load_bin(filename, offset);
+        return;
+    }
+
+    log_debug("mapped binary file '%s' (%zu bytes) to offset 0x%llx",
+              filename.c_str(), mapped, offset);
+
+    if (mapped < filesz) {
+        u8* tail = allocate_image(filesz - mapped, offset + mapped);
+        file.seekg(mapped, std::ios::beg);
+        file.read((char*)tail, filesz - mapped);
+        VCML_REPORT_ON(!file, "cannot read file");
+    }
 }
 
-void memory::copy_image(const u8* image, u64 sz, u64 off) {
+void memory::check_image(u64 sz, u64 off) const {
     if (off >= size)
         VCML_REPORT("offset 0x%llx exceeds memory size", off);
 
     if (sz + off > size)
         VCML_REPORT("image too big for memory");
+}
+
+u8* memory::allocate_image(u64 sz, u64 off) {
+    check_image(sz, off);
+    if (sz > 0)
+        m_memory.touch({ off, off + sz - 1 });
+    return m_memory.data() + off;
+}
 
+void memory::copy_image(const u8* image, u64 sz, u64 off) {
+    check_image(sz, off);
+    if (sz > 0)
+        m_memory.touch({ off, off + sz - 1 });
     memcpy(m_memory.data() + off, image, sz);
 }
 
@@ -72,12 +107,37 @@ memory::memory(const sc_module_name& nm, u64 sz, bool read_only, alignment al,
     readonly("readonly", read_only),
     shared("shared", ""),
     images("images"),
+    map_images("map_images", false),
+    clear_on_reset("clear_on_reset", false),
     poison("poison", 0x00),
+    hugepages("hugepages", "none"),
+    prefault("prefault", false),
+    numa_node("numa_node", -1),
+    numa_interleave("numa_interleave", false),
     in("in") {
     VCML_ERROR_ON(size == 0u, "memory size cannot be 0");
     VCML_ERROR_ON(al > VCML_ALIGN_1G, "requested alignment too big");
 
+    if (hugepages == "transparent")
+        m_memory.set_hugepages(tlm_memory::HUGEPAGES_TRANSPARENT);
+    else if (hugepages == "explicit")
+        m_memory.set_hugepages(tlm_memory::HUGEPAGES_EXPLICIT);
+    else if (hugepages != "none")
+        log_warn("invalid hugepages setting: %s", hugepages.c_str());
+
+    m_memory.set_prefault(prefault);
+    m_memory.set_numa_node(numa_node);
+    m_memory.set_numa_interleave(numa_interleave);
     m_memory.init(shared, size, align);
+
+    if (hugepages == "explicit" &&
+        m_memory.hugepages() != tlm_memory::HUGEPAGES_EXPLICIT)
+        log_warn("no explicit huge pages available, using transparent ones");
+    if (hugepages != "none" &&
+        m_memory.hugepages() == tlm_memory::HUGEPAGES_NONE)
+        log_warn("huge pages not supported");
+    if ((numa_node >= 0 || numa_interleave) && !m_memory.numa_bound())
+        log_warn("failed to apply numa policy");
     m_memory.set_read_latency(read_cycles());
     m_memory.set_write_latency(write_cycles());
 
@@ -98,7 +158,14 @@ memory::~memory() {
 
 void memory::reset() {
     if (poison > 0)
-        m_memory.fill(poison);
+        m_memory.poison(poison);
+    else if (clear_on_reset)
+        m_memory.clear();
+
+    // pages still waiting for their poison value must not be reachable via
+    // DMI, so only grant it on demand from now on
+    if (m_memory.has_pending())
+        unmap_dmi(0, size - 1);
 
     load_images(images);
 }
@@ -113,6 +180,37 @@ tlm_response_status memory::write(const range& addr, const void* data,
     return m_memory.write(addr, data, info.is_debug);
 }
 
+bool memory::get_direct_mem_ptr(tlm_target_socket& origin,
+                                tlm_generic_payload& tx, tlm_dmi& dmi) {
+    u64 addr = tx.get_address();
+    if (addr >= size)
+        return false;
+
+    u64 start = 0;
+    u64 end = size - 1;
+
+    if (m_memory.has_pending()) {
+        start = addr & ~(LAZY_DMI_BLOCK - 1);
+        end = min<u64>(start + LAZY_DMI_BLOCK, size) - 1;
+        m_memory.touch({ start, end });
+    }
+
+    if (!m_memory.has_pending()) {
+        start = 0;
+        end = size - 1;
+    }
+
+    dmi = m_memory;
+    dmi.set_dmi_ptr(m_memory.data() + start);
+    dmi.set_start_address(start);
+    dmi.set_end_address(end);
+    dmi.set_read_latency(read_cycles());
+    dmi.set_write_latency(write_cycles());
+
+    map_dmi(dmi);
+    return true;
+}
+
 VCML_EXPORT_MODEL(vcml::generic::memory, name, args) {
     size_t size = 4 * KiB;
     if (!args.empty())
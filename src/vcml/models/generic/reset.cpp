@@ -22,6 +22,7 @@ reset::~reset() {
 }
 
 void reset::end_of_elaboration() {
+    module::end_of_elaboration();
     rst.pulse();
     rst = state;
 }
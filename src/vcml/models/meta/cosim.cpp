@@ -0,0 +1,904 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/models/meta/cosim.h"
+#include "vcml/protocols/tlm_memory.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace vcml {
+namespace meta {
+
+enum cosim_state : u32 {
+    STATE_NONE = 0,
+    STATE_ATTACHED = 1,
+    STATE_FINISHED = 2,
+};
+
+enum cosim_msg_type : u32 {
+    MSG_PAD = 0,
+    MSG_TLM_REQ,
+    MSG_TLM_RSP,
+    MSG_DMI_REQ,
+    MSG_DMI_RSP,
+    MSG_DMI_INV,
+    MSG_GPIO,
+    MSG_ETH,
+    MSG_CAN,
+};
+
+enum cosim_tlm_flags : u32 {
+    TLM_FLAG_DEBUG = bit(0),
+    TLM_FLAG_NODMI = bit(1),
+    TLM_FLAG_SYNC = bit(2),
+    TLM_FLAG_INSN = bit(3),
+    TLM_FLAG_EXCL = bit(4),
+    TLM_FLAG_LOCK = bit(5),
+    TLM_FLAG_SECURE = bit(6),
+    TLM_FLAG_DMI_ALLOWED = bit(7),
+};
+
+constexpr u32 COSIM_MAGIC = 0x6d69736f; // "osim"
+constexpr u32 COSIM_VERSION = 1;
+constexpr size_t COSIM_MAX_NAME = 64;
+
+struct cosim_msg {
+    u32 type;
+    u32 length;
+    u64 id;
+};
+
+struct cosim_msg_tlm {
+    cosim_msg hdr;
+    u64 addr;
+    u64 time;
+    u64 cpuid;
+    u64 privilege;
+    u64 asid;
+    u32 command;
+    u32 size;
+    u32 flags;
+    i32 response;
+    u32 atype;
+    u32 bytes;
+};
+
+struct cosim_msg_dmi {
+    cosim_msg hdr;
+    u64 start;
+    u64 end;
+    u64 offset;
+    u64 rdlat;
+    u64 wrlat;
+    u32 command;
+    u32 access;
+    char name[COSIM_MAX_NAME];
+};
+
+struct cosim_msg_range {
+    cosim_msg hdr;
+    u64 start;
+    u64 end;
+};
+
+struct cosim_msg_gpio {
+    cosim_msg hdr;
+    u64 port;
+    u64 vector;
+    u64 state;
+};
+
+struct cosim_msg_eth {
+    cosim_msg hdr;
+    u64 size;
+};
+
+struct cosim_msg_can {
+    cosim_msg hdr;
+    can_frame frame;
+};
+
+struct cosim::shm_header {
+    atomic<u32> magic;
+    u32 version;
+    u64 ring_size;
+    atomic<u32> state[2];
+    atomic<u64> time[2];
+};
+
+// single-producer single-consumer ring, head is only written by the sending
+// process and tail is only written by the receiving process
+struct cosim::shm_ring {
+    alignas(64) atomic<u64> head;
+    alignas(64) atomic<u64> tail;
+    alignas(64) u8 data[8];
+};
+
+static_assert(atomic<u64>::is_always_lock_free, "u64 atomics required");
+static_assert(atomic<u32>::is_always_lock_free, "u32 atomics required");
+
+// messages are padded to the header size, so that a padding message always
+// fits into the space left at the end of the ring
+static size_t msg_align(size_t len) {
+    return (len + sizeof(cosim_msg) - 1) & ~(sizeof(cosim_msg) - 1);
+}
+
+template <typename T>
+static T* msg_init(vector<u8>& buf, cosim_msg_type type, size_t extra = 0,
+                   u64 id = 0) {
+    buf.assign(msg_align(sizeof(T) + extra), 0);
+    T* msg = (T*)buf.data();
+    msg->hdr.type = type;
+    msg->hdr.length = buf.size();
+    msg->hdr.id = id;
+    return msg;
+}
+
+// shared memory layout: header page followed by the two rings
+constexpr size_t COSIM_HEADER_SIZE = 4096;
+constexpr size_t COSIM_RING_HEADER = 128;
+
+static size_t ring_offset(size_t idx, size_t ringsz) {
+    return COSIM_HEADER_SIZE + idx * (COSIM_RING_HEADER + ringsz);
+}
+
+static sc_time time_from_ps(u64 ps) {
+    return sc_time((double)ps, SC_PS);
+}
+
+void cosim::connect() {
+    static_assert(sizeof(shm_header) <= COSIM_HEADER_SIZE, "header size");
+    static_assert(offsetof(shm_ring, data) == COSIM_RING_HEADER, "ring size");
+
+    const string& name = channel.get();
+    VCML_ERROR_ON(name.empty() || name[0] != '/',
+                  "invalid cosim channel name '%s'", name.c_str());
+    VCML_ERROR_ON(ring_size < 4 * KiB || ring_size % 64,
+                  "invalid cosim ring size: %zu", ring_size.get());
+
+    m_shmsz = ring_offset(2, ring_size);
+    m_max_data = ring_size / 4 - sizeof(cosim_msg_tlm);
+
+    m_fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (m_fd >= 0) {
+        m_side = 0;
+        if (ftruncate(m_fd, m_shmsz) < 0)
+            VCML_ERROR("ftruncate failed: %s", strerror(errno));
+    } else if (errno == EEXIST) {
+        m_side = 1;
+        m_fd = shm_open(name.c_str(), O_RDWR, 0600);
+        VCML_ERROR_ON(m_fd < 0, "cannot open cosim channel '%s': %s",
+                      name.c_str(), strerror(errno));
+
+        // the creator might not have sized the segment yet
+        struct stat st {};
+        VCML_ERROR_ON(fstat(m_fd, &st), "fstat: %s", strerror(errno));
+        while ((size_t)st.st_size < m_shmsz) {
+            mwr::usleep(100);
+            VCML_ERROR_ON(fstat(m_fd, &st), "fstat: %s", strerror(errno));
+        }
+
+        if ((size_t)st.st_size != m_shmsz) {
+            VCML_ERROR("cosim channel '%s' has unexpected size %zu",
+                       name.c_str(), (size_t)st.st_size);
+        }
+    } else {
+        VCML_ERROR("cannot create cosim channel '%s': %s", name.c_str(),
+                   strerror(errno));
+    }
+
+    int prot = PROT_READ | PROT_WRITE;
+    void* base = mmap(nullptr, m_shmsz, prot, MAP_SHARED, m_fd, 0);
+    VCML_ERROR_ON(base == MAP_FAILED, "mmap failed: %s", strerror(errno));
+
+    m_shm = (shm_header*)base;
+    shm_ring* rings[2] = {
+        (shm_ring*)((u8*)base + ring_offset(0, ring_size)),
+        (shm_ring*)((u8*)base + ring_offset(1, ring_size)),
+    };
+
+    m_tx = rings[m_side];
+    m_rx = rings[1 - m_side];
+
+    if (is_creator()) {
+        m_shm->version = COSIM_VERSION;
+        m_shm->ring_size = ring_size;
+        for (int i = 0; i < 2; i++) {
+            m_shm->state[i] = STATE_NONE;
+            m_shm->time[i] = 0;
+            rings[i]->head = 0;
+            rings[i]->tail = 0;
+        }
+
+        m_shm->state[m_side].store(STATE_ATTACHED);
+        m_shm->magic.store(COSIM_MAGIC, std::memory_order_release);
+        log_debug("created cosim channel %s", name.c_str());
+        return;
+    }
+
+    while (m_shm->magic.load(std::memory_order_acquire) != COSIM_MAGIC)
+        mwr::cpu_yield();
+
+    VCML_ERROR_ON(m_shm->version != COSIM_VERSION,
+                  "cosim channel '%s' has incompatible version %u",
+                  name.c_str(), m_shm->version);
+    VCML_ERROR_ON(m_shm->ring_size != ring_size,
+                  "cosim channel '%s' uses different ring size %llu",
+                  name.c_str(), m_shm->ring_size);
+
+    u32 expected = STATE_NONE;
+    if (!m_shm->state[m_side].compare_exchange_strong(expected,
+                                                      STATE_ATTACHED)) {
+        VCML_ERROR("cosim channel '%s' already in use", name.c_str());
+    }
+
+    // both sides hold a mapping now, so the name can be released
+    shm_unlink(name.c_str());
+    log_debug("attached to cosim channel %s", name.c_str());
+}
+
+void cosim::disconnect() {
+    if (!is_connected())
+        return;
+
+    if (is_creator() && !peer_attached() && !peer_finished())
+        shm_unlink(channel.get().c_str());
+
+    m_shm->state[m_side].store(STATE_FINISHED, std::memory_order_release);
+    munmap(m_shm, m_shmsz);
+    mwr::fd_close(m_fd);
+
+    m_shm = nullptr;
+    m_tx = m_rx = nullptr;
+    m_fd = -1;
+}
+
+void cosim::wait_peer() {
+    if (peer_attached() || peer_finished())
+        return;
+
+    log_debug("waiting for peer on %s", channel.get().c_str());
+    while (!peer_attached() && !peer_finished())
+        mwr::usleep(100);
+}
+
+bool cosim::peer_attached() const {
+    if (!is_connected())
+        return false;
+    return m_shm->state[1 - m_side].load() == STATE_ATTACHED;
+}
+
+bool cosim::peer_finished() const {
+    if (!is_connected())
+        return false;
+    return m_shm->state[1 - m_side].load() == STATE_FINISHED;
+}
+
+u64 cosim::peer_time() const {
+    return m_shm->time[1 - m_side].load(std::memory_order_acquire);
+}
+
+void cosim::publish_time(const sc_time& t) {
+    m_shm->time[m_side].store(time_to_ps(t), std::memory_order_release);
+}
+
+bool cosim::ring_push(shm_ring* ring, const void* msg, size_t len) {
+    size_t cap = ring_size;
+    u64 head = ring->head.load(std::memory_order_relaxed);
+    u64 tail = ring->tail.load(std::memory_order_acquire);
+
+    size_t pos = head % cap;
+    size_t pad = cap - pos < len ? cap - pos : 0;
+    if (cap - (head - tail) < pad + len) {
+        // wrap around early, so that the message fits once the peer has
+        // consumed everything up to the end of the ring
+        if (pad > 0 && cap - (head - tail) >= pad) {
+            cosim_msg* filler = (cosim_msg*)(ring->data + pos);
+            filler->type = MSG_PAD;
+            filler->length = pad;
+            filler->id = 0;
+            ring->head.store(head + pad, std::memory_order_release);
+        }
+
+        return false;
+    }
+
+    if (pad > 0) {
+        cosim_msg* filler = (cosim_msg*)(ring->data + pos);
+        filler->type = MSG_PAD;
+        filler->length = pad;
+        filler->id = 0;
+        head += pad;
+        pos = 0;
+    }
+
+    memcpy(ring->data + pos, msg, len);
+    ring->head.store(head + len, std::memory_order_release);
+    return true;
+}
+
+bool cosim::ring_pop(shm_ring* ring, vector<u8>& msg) {
+    size_t cap = ring_size;
+    u64 tail = ring->tail.load(std::memory_order_relaxed);
+    u64 head = ring->head.load(std::memory_order_acquire);
+
+    while (tail != head) {
+        const cosim_msg* hdr = (const cosim_msg*)(ring->data + tail % cap);
+        if (hdr->type == MSG_PAD) {
+            tail += hdr->length;
+            continue;
+        }
+
+        msg.assign((const u8*)hdr, (const u8*)hdr + hdr->length);
+        ring->tail.store(tail + hdr->length, std::memory_order_release);
+        return true;
+    }
+
+    ring->tail.store(tail, std::memory_order_release);
+    return false;
+}
+
+bool cosim::timed_out(u64 start) const {
+    if (timeout == 0u)
+        return false;
+    return mwr::timestamp_us() - start > timeout * 1000ull;
+}
+
+bool cosim::send(vector<u8>& msg) {
+    VCML_ERROR_ON(!thctl_is_sysc_thread(), "cosim used outside SystemC");
+
+    if (msg.size() > ring_size) {
+        log_warn("dropping cosim message of %zu bytes, ring holds %zu bytes",
+                 msg.size(), ring_size.get());
+        return false;
+    }
+
+    u64 start = mwr::timestamp_us();
+    while (!ring_push(m_tx, msg.data(), msg.size())) {
+        if (peer_finished())
+            return false;
+
+        if (timed_out(start)) {
+            log_warn("peer stopped receiving, dropping message");
+            return false;
+        }
+
+        if (!poll())
+            mwr::cpu_yield();
+    }
+
+    return true;
+}
+
+bool cosim::poll() {
+    if (!is_connected())
+        return false;
+
+    vector<u8> msg;
+    if (!ring_pop(m_rx, msg))
+        return false;
+
+    handle(msg);
+    return true;
+}
+
+bool cosim::receive(u64 id, vector<u8>& rsp) {
+    u64 start = mwr::timestamp_us();
+    while (true) {
+        auto it = m_responses.find(id);
+        if (it != m_responses.end()) {
+            rsp = std::move(it->second);
+            m_responses.erase(it);
+            return true;
+        }
+
+        if (peer_finished())
+            return false;
+
+        if (timed_out(start)) {
+            log_warn("peer did not respond within %ums", timeout.get());
+            return false;
+        }
+
+        if (!poll())
+            mwr::cpu_yield();
+    }
+}
+
+void cosim::handle(vector<u8>& msg) {
+    const cosim_msg* hdr = (const cosim_msg*)msg.data();
+    u64 id = hdr->id;
+
+    switch (hdr->type) {
+    case MSG_TLM_RSP:
+    case MSG_DMI_RSP:
+        m_responses[id] = std::move(msg);
+        break;
+
+    case MSG_TLM_REQ:
+        handle_tlm(msg);
+        break;
+
+    case MSG_DMI_REQ:
+        handle_dmi(msg);
+        break;
+
+    case MSG_DMI_INV:
+        handle_dmi_invalidate(msg);
+        break;
+
+    case MSG_GPIO:
+        handle_gpio(msg);
+        break;
+
+    case MSG_ETH:
+        handle_eth(msg);
+        break;
+
+    case MSG_CAN:
+        handle_can(msg);
+        break;
+
+    default:
+        VCML_ERROR("invalid cosim message type %u", hdr->type);
+    }
+}
+
+void cosim::handle_tlm(vector<u8>& msg) {
+    const cosim_msg_tlm* req = (const cosim_msg_tlm*)msg.data();
+    bool debug = req->flags & TLM_FLAG_DEBUG;
+
+    // regular transactions may only be replayed from thread context; if we
+    // got here from a method or a debug access, hand them over to the replay
+    // thread, which runs in the next delta cycle rather than the next quantum
+    if (!debug && (!is_thread() || m_debug)) {
+        m_deferred.push_back(std::move(msg));
+        m_replay_ev.notify(SC_ZERO_TIME);
+        return;
+    }
+
+    tlm_command cmd = (tlm_command)req->command;
+    vector<u8> buf;
+    size_t extra = cmd == TLM_READ_COMMAND ? req->size : 0;
+    cosim_msg_tlm* rsp = msg_init<cosim_msg_tlm>(buf, MSG_TLM_RSP, extra,
+                                                 req->hdr.id);
+    *rsp = *req;
+    rsp->hdr.type = MSG_TLM_RSP;
+    rsp->hdr.length = buf.size();
+
+    u8* data = (u8*)(rsp + 1);
+    if (cmd == TLM_WRITE_COMMAND)
+        data = (u8*)(req + 1);
+
+    tlm_sbi info(debug, req->flags & TLM_FLAG_NODMI,
+                 req->flags & TLM_FLAG_SYNC, req->flags & TLM_FLAG_INSN,
+                 req->flags & TLM_FLAG_EXCL, req->flags & TLM_FLAG_LOCK,
+                 req->flags & TLM_FLAG_SECURE, req->atype, req->cpuid,
+                 req->privilege, req->asid);
+
+    tlm_generic_payload tx;
+    tx_setup(tx, cmd, req->addr, data, req->size);
+
+    // issue the transaction at the local time of the remote initiator, its
+    // own latency is sent back and added there
+    sc_time& offset = local_time();
+    sc_time before = offset;
+    sc_time start = sc_time_stamp() + offset;
+    if (!debug && time_from_ps(req->time) > start) {
+        offset += time_from_ps(req->time) - start;
+        start = time_from_ps(req->time);
+    }
+
+    rsp->bytes = out.send(tx, info);
+    rsp->response = tx.get_response_status();
+    sc_time end = sc_time_stamp() + offset;
+    rsp->time = debug ? 0 : time_to_ps(end - start);
+    offset = before;
+
+    rsp->flags &= ~TLM_FLAG_DMI_ALLOWED;
+    if (tx.is_dmi_allowed())
+        rsp->flags |= TLM_FLAG_DMI_ALLOWED;
+
+    send(buf);
+}
+
+void cosim::handle_dmi(const vector<u8>& msg) {
+    const cosim_msg_dmi* req = (const cosim_msg_dmi*)msg.data();
+
+    vector<u8> buf;
+    cosim_msg_dmi* rsp = msg_init<cosim_msg_dmi>(buf, MSG_DMI_RSP, 0,
+                                                 req->hdr.id);
+    rsp->start = req->start;
+    rsp->end = req->end;
+    rsp->access = VCML_ACCESS_NONE;
+
+    tlm_dmi dmi;
+    tlm_generic_payload tx;
+    tx_setup(tx, (tlm_command)req->command, req->start, nullptr,
+             req->end - req->start + 1);
+
+    if (out->get_direct_mem_ptr(tx, dmi)) {
+        rsp->start = dmi.get_start_address();
+        rsp->end = dmi.get_end_address();
+
+        const tlm_memory* mem = tlm_memory::find_shared(dmi.get_dmi_ptr());
+        if (mem && strlen(mem->shared_name()) < COSIM_MAX_NAME) {
+            u8* limit = mem->data() + mem->size();
+            u64 avail = limit - dmi.get_dmi_ptr();
+            if (rsp->end - rsp->start >= avail)
+                rsp->end = rsp->start + avail - 1;
+
+            rsp->offset = mem->shared_offset(dmi.get_dmi_ptr());
+            rsp->rdlat = time_to_ps(dmi.get_read_latency());
+            rsp->wrlat = time_to_ps(dmi.get_write_latency());
+            rsp->access = (u32)dmi.get_granted_access();
+            strncpy(rsp->name, mem->shared_name(), COSIM_MAX_NAME - 1);
+        }
+    }
+
+    send(buf);
+}
+
+void cosim::handle_dmi_invalidate(const vector<u8>& msg) {
+    const cosim_msg_range* inv = (const cosim_msg_range*)msg.data();
+    stl_remove_if(m_nodmi, [inv](const range& r) -> bool {
+        return r.overlaps(range(inv->start, inv->end));
+    });
+
+    in->invalidate_direct_mem_ptr(inv->start, inv->end);
+}
+
+void cosim::handle_gpio(const vector<u8>& msg) {
+    const cosim_msg_gpio* gpio = (const cosim_msg_gpio*)msg.data();
+    if (!gpio_out.exists(gpio->port)) {
+        log_warn("gpio_out[%llu] not connected", gpio->port);
+        return;
+    }
+
+    gpio_out[gpio->port].write(gpio->state, gpio->vector);
+}
+
+void cosim::handle_eth(const vector<u8>& msg) {
+    const cosim_msg_eth* eth = (const cosim_msg_eth*)msg.data();
+    const u8* data = (const u8*)(eth + 1);
+    eth_frame frame(data, eth->size);
+    eth_tx.send(frame);
+}
+
+void cosim::handle_can(const vector<u8>& msg) {
+    const cosim_msg_can* can = (const cosim_msg_can*)msg.data();
+    can_frame frame = can->frame;
+    can_tx.send(frame);
+}
+
+u8* cosim::map_remote(const string& name, u64 offset, u64 size) {
+    auto it = m_mappings.find(name);
+    if (it == m_mappings.end()) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            log_warn("cannot open %s: %s", name.c_str(), strerror(errno));
+            return nullptr;
+        }
+
+        struct stat st {};
+        if (fstat(fd, &st) < 0) {
+            mwr::fd_close(fd);
+            return nullptr;
+        }
+
+        mapping m;
+        m.size = st.st_size;
+        m.base = mmap(nullptr, m.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+        mwr::fd_close(fd);
+
+        if (m.base == MAP_FAILED) {
+            log_warn("cannot map %s: %s", name.c_str(), strerror(errno));
+            return nullptr;
+        }
+
+        it = m_mappings.emplace(name, m).first;
+    }
+
+    if (offset + size > it->second.size)
+        return nullptr;
+
+    return (u8*)it->second.base + offset;
+}
+
+void cosim::unmap_remote() {
+    for (auto& it : m_mappings)
+        munmap(it.second.base, it.second.size);
+    m_mappings.clear();
+}
+
+tlm_response_status cosim::forward(tlm_generic_payload& tx,
+                                   const tlm_sbi& info, unsigned int& bytes,
+                                   sc_time& latency) {
+    tlm_command cmd = tx.get_command();
+    u8* data = tx.get_data_ptr();
+    u64 addr = tx.get_address();
+    u64 size = tx.get_data_length();
+    bool dmi = true;
+
+    u32 flags = 0;
+    flags |= info.is_debug ? TLM_FLAG_DEBUG : 0;
+    flags |= info.is_nodmi ? TLM_FLAG_NODMI : 0;
+    flags |= info.is_sync ? TLM_FLAG_SYNC : 0;
+    flags |= info.is_insn ? TLM_FLAG_INSN : 0;
+    flags |= info.is_excl ? TLM_FLAG_EXCL : 0;
+    flags |= info.is_lock ? TLM_FLAG_LOCK : 0;
+    flags |= info.is_secure ? TLM_FLAG_SECURE : 0;
+
+    for (u64 done = 0; done < size;) {
+        u32 chunk = min<u64>(size - done, m_max_data);
+        size_t extra = cmd == TLM_WRITE_COMMAND ? chunk : 0;
+
+        vector<u8> buf;
+        u64 id = m_next_id++;
+        cosim_msg_tlm* req = msg_init<cosim_msg_tlm>(buf, MSG_TLM_REQ, extra,
+                                                     id);
+        req->addr = addr + done;
+        req->time = info.is_debug ? 0
+                                  : time_to_ps(local_time_stamp() + latency);
+        req->cpuid = info.cpuid;
+        req->privilege = info.privilege;
+        req->asid = info.asid;
+        req->atype = info.atype;
+        req->command = cmd;
+        req->size = chunk;
+        req->flags = flags;
+        req->response = TLM_INCOMPLETE_RESPONSE;
+        if (cmd == TLM_WRITE_COMMAND)
+            memcpy(req + 1, data + done, chunk);
+
+        if (!send(buf) || !receive(id, buf)) {
+            log_warn("peer disconnected during transaction");
+            return TLM_GENERIC_ERROR_RESPONSE;
+        }
+
+        const cosim_msg_tlm* rsp = (const cosim_msg_tlm*)buf.data();
+        if (cmd == TLM_READ_COMMAND)
+            memcpy(data + done, rsp + 1, chunk);
+
+        bytes += rsp->bytes;
+        latency += time_from_ps(rsp->time);
+        dmi &= (rsp->flags & TLM_FLAG_DMI_ALLOWED) != 0;
+        done += chunk;
+
+        tlm_response_status resp = (tlm_response_status)rsp->response;
+        if (failed(resp))
+            return resp;
+    }
+
+    for (const range& r : m_nodmi)
+        dmi &= !r.overlaps(tx);
+
+    tx.set_dmi_allowed(dmi && allow_dmi);
+    return TLM_OK_RESPONSE;
+}
+
+void cosim::sync() {
+    wait_peer();
+
+    while (true) {
+        wait(m_quantum);
+
+        sc_time now = sc_time_stamp();
+        publish_time(now);
+
+        while (!peer_finished() && peer_time() < time_to_ps(now)) {
+            if (!poll())
+                mwr::cpu_yield();
+        }
+
+        while (poll()) {
+            // drain pending messages
+        }
+    }
+}
+
+void cosim::replay() {
+    while (true) {
+        wait(m_replay_ev);
+
+        while (!m_deferred.empty()) {
+            vector<u8> msg(std::move(m_deferred.front()));
+            m_deferred.pop_front();
+            handle(msg);
+        }
+    }
+}
+
+cosim::cosim(const sc_module_name& nm):
+    component(nm),
+    eth_host(),
+    can_host(),
+    m_fd(-1),
+    m_side(0),
+    m_shmsz(0),
+    m_shm(nullptr),
+    m_tx(nullptr),
+    m_rx(nullptr),
+    m_next_id(0),
+    m_max_data(0),
+    m_quantum(),
+    m_responses(),
+    m_deferred(),
+    m_replay_ev("replay_ev"),
+    m_debug(false),
+    m_mappings(),
+    m_nodmi(),
+    channel("channel", mkstr("/vcml.%s", name())),
+    ring_size("ring_size", 1 * MiB),
+    quantum("quantum", SC_ZERO_TIME),
+    timeout("timeout", 10000),
+    in("in"),
+    out("out"),
+    gpio_in("gpio_in"),
+    gpio_out("gpio_out"),
+    eth_tx("eth_tx"),
+    eth_rx("eth_rx"),
+    can_tx("can_tx"),
+    can_rx("can_rx") {
+    SC_HAS_PROCESS(cosim);
+    SC_THREAD(sync);
+    SC_THREAD(replay);
+}
+
+cosim::~cosim() {
+    disconnect();
+    unmap_remote();
+}
+
+unsigned int cosim::transport(tlm_target_socket& socket,
+                              tlm_generic_payload& tx, const tlm_sbi& info) {
+    if (!is_connected() || peer_finished()) {
+        tx.set_response_status(TLM_GENERIC_ERROR_RESPONSE);
+        return 0;
+    }
+
+    if (tx.get_byte_enable_ptr() != nullptr) {
+        tx.set_response_status(TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        return 0;
+    }
+
+    if (tx.get_streaming_width() != tx.get_data_length()) {
+        tx.set_response_status(TLM_BURST_ERROR_RESPONSE);
+        return 0;
+    }
+
+    unsigned int bytes = 0;
+    sc_time latency = SC_ZERO_TIME;
+    bool debug = m_debug;
+    m_debug = debug || info.is_debug;
+    tx.set_response_status(forward(tx, info, bytes, latency));
+    m_debug = debug;
+    if (!info.is_debug)
+        local_time() += latency;
+
+    return bytes;
+}
+
+bool cosim::get_direct_mem_ptr(tlm_target_socket& origin,
+                               tlm_generic_payload& tx, tlm_dmi& dmi) {
+    if (!is_connected() || peer_finished() || !allow_dmi)
+        return false;
+
+    range addr(tx);
+    for (const range& r : m_nodmi)
+        if (r.includes(addr))
+            return false;
+
+    vector<u8> buf;
+    u64 id = m_next_id++;
+    cosim_msg_dmi* req = msg_init<cosim_msg_dmi>(buf, MSG_DMI_REQ, 0, id);
+    req->start = addr.start;
+    req->end = addr.end;
+    req->command = tx.get_command();
+
+    if (!send(buf) || !receive(id, buf))
+        return false;
+
+    const cosim_msg_dmi* rsp = (const cosim_msg_dmi*)buf.data();
+    u8* ptr = nullptr;
+    if (rsp->access != VCML_ACCESS_NONE) {
+        string name(rsp->name, strnlen(rsp->name, COSIM_MAX_NAME));
+        ptr = map_remote(name, rsp->offset, rsp->end - rsp->start + 1);
+    }
+
+    if (ptr == nullptr) {
+        m_nodmi.emplace_back(rsp->start, rsp->end);
+        return false;
+    }
+
+    dmi.init();
+    dmi.set_dmi_ptr(ptr);
+    dmi.set_start_address(rsp->start);
+    dmi.set_end_address(rsp->end);
+    dmi.set_read_latency(time_from_ps(rsp->rdlat));
+    dmi.set_write_latency(time_from_ps(rsp->wrlat));
+    dmi_set_access(dmi, (vcml_access)rsp->access);
+    return true;
+}
+
+void cosim::invalidate_direct_mem_ptr(tlm_initiator_socket& origin, u64 start,
+                                      u64 end) {
+    if (!is_connected() || !peer_attached())
+        return;
+
+    vector<u8> buf;
+    cosim_msg_range* inv = msg_init<cosim_msg_range>(buf, MSG_DMI_INV);
+    inv->start = start;
+    inv->end = end;
+    send(buf);
+}
+
+void cosim::gpio_notify(const gpio_target_socket& socket, bool state,
+                        gpio_vector vec) {
+    if (!is_connected())
+        return;
+
+    vector<u8> buf;
+    cosim_msg_gpio* gpio = msg_init<cosim_msg_gpio>(buf, MSG_GPIO);
+    gpio->port = gpio_in.index_of(socket);
+    gpio->vector = vec;
+    gpio->state = state;
+    send(buf);
+}
+
+void cosim::eth_receive(const eth_target_socket& socket,
+                        const eth_frame& frame) {
+    if (!is_connected())
+        return;
+
+    vector<u8> buf;
+    cosim_msg_eth* eth = msg_init<cosim_msg_eth>(buf, MSG_ETH, frame.size());
+    eth->size = frame.size();
+    memcpy(eth + 1, frame.data(), frame.size());
+    send(buf);
+}
+
+void cosim::can_receive(const can_target_socket& socket, can_frame& frame) {
+    if (!is_connected())
+        return;
+
+    vector<u8> buf;
+    cosim_msg_can* can = msg_init<cosim_msg_can>(buf, MSG_CAN);
+    can->frame = frame;
+    send(buf);
+}
+
+void cosim::end_of_elaboration() {
+    component::end_of_elaboration();
+
+    m_quantum = quantum;
+    if (m_quantum == SC_ZERO_TIME)
+        m_quantum = tlm::tlm_global_quantum::instance().get();
+    if (m_quantum == SC_ZERO_TIME)
+        m_quantum = sc_time(1.0, SC_US);
+
+    connect();
+}
+
+void cosim::end_of_simulation() {
+    component::end_of_simulation();
+    disconnect();
+}
+
+VCML_EXPORT_MODEL(vcml::meta::cosim, name, args) {
+    return new cosim(name);
+}
+
+} // namespace meta
+} // namespace vcml
@@ -10,6 +10,10 @@
 
 #include "vcml/models/meta/throttle.h"
 
+#include <time.h>
+#include <errno.h>
+#include <chrono>
+
 namespace vcml {
 namespace meta {
 
@@ -23,11 +27,71 @@ static u64 do_usleep(u64 delta) {
     return d > delta ? d - delta : 0;
 }
 
+static u64 host_time_ns() {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+#else
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+#endif
+}
+
+static void host_sleep_until(u64 deadline) {
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000ull;
+    ts.tv_nsec = deadline % 1000000000ull;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+           EINTR) {
+        // interrupted by a signal, resume sleeping
+    }
+#else
+    u64 now = host_time_ns();
+    if (now < deadline)
+        mwr::usleep((deadline - now) / 1000);
+#endif
+}
+
+u64 throttle::deadline(const sc_time& t) const {
+    u64 origin = m_sim_origin.load(std::memory_order_relaxed);
+    u64 host = m_host_origin.load(std::memory_order_relaxed);
+    if (t.value() <= origin)
+        return host;
+
+    double delta = time_to_ns(time_from_value(t.value() - origin));
+    return host + (u64)(delta / m_rtf.load(std::memory_order_relaxed));
+}
+
+void throttle::sleep_until(u64 target) {
+    // sleep on an absolute deadline to avoid accumulating wakeup latency,
+    // then spin through the last part where the scheduler is too coarse
+    u64 spin = time_to_ns(spin_window);
+    if (target > spin && host_time_ns() < target - spin)
+        host_sleep_until(target - spin);
+
+    while (host_time_ns() < target)
+        mwr::cpu_yield();
+}
+
+void throttle::rebase(u64 host, const sc_time& sim) {
+    m_host_origin.store(host, std::memory_order_relaxed);
+    m_sim_origin.store(sim.value(), std::memory_order_relaxed);
+}
+
 void throttle::update() {
     sc_time quantum = tlm::tlm_global_quantum::instance().get();
     sc_time interval = max<sc_time>(quantum, update_interval);
     next_trigger(interval);
 
+    if (precise)
+        update_precise();
+    else
+        update_coarse(interval);
+}
+
+void throttle::update_coarse(const sc_time& interval) {
     if (rtf > 0.0) {
         u64 actual = mwr::timestamp_us() - m_start + m_extra;
         u64 target = time_to_us(interval) / rtf;
@@ -48,24 +112,164 @@ void throttle::update() {
     m_start = mwr::timestamp_us();
 }
 
+void throttle::update_precise() {
+    sc_time now = sc_time_stamp();
+    u64 host = host_time_ns();
+
+    if (rtf <= 0.0) {
+        m_throttling = false;
+        m_rtf = 0.0;
+        rebase(host, now);
+        m_host_last = host;
+        m_sim_last = now;
+        return;
+    }
+
+    if (rtf.get() != m_rtf.load()) {
+        m_rtf = rtf.get();
+        rebase(host, now);
+    }
+
+    u64 target = deadline(now);
+    if (host < target) {
+        sleep_until(target);
+        u64 woken = host_time_ns();
+        u64 overshoot = woken - target;
+        m_stats.total_sleep += sc_time((double)(target - host), SC_NS);
+        m_stats.max_overshoot = max(m_stats.max_overshoot,
+                                    sc_time((double)overshoot, SC_NS));
+        m_stats.drift = sc_time((double)overshoot, SC_NS);
+        m_stats.throttled++;
+        if (!m_throttling)
+            log_debug("throttling started");
+        m_throttling = true;
+        host = woken;
+    } else {
+        // running behind: catch up at full speed as long as the lag is
+        // within the burst credit, anything beyond that is forgotten
+        u64 lag = host - target;
+        u64 credit = time_to_ns(burst_credit);
+        if (lag > credit) {
+            rebase(host - credit, now);
+            m_stats.credit_drops++;
+            m_dropped += lag - credit;
+            lag = credit;
+        }
+
+        m_stats.drift = sc_time((double)lag, SC_NS);
+        if (m_throttling)
+            log_debug("throttling stopped");
+        m_throttling = false;
+    }
+
+    // lag that was dropped when running out of burst credit is lost for
+    // good, so it still counts towards the total
+    m_stats.total_drift = m_stats.drift + sc_time((double)m_dropped, SC_NS);
+
+    u64 dhost = host - m_host_last;
+    u64 dsim = time_to_ns(now - m_sim_last);
+    if (dhost > 0 && now > m_sim_last) {
+        double curr = (double)dsim / (double)dhost;
+        m_stats.rtf_last = curr;
+        m_stats.rtf_min = m_stats.intervals ? min(m_stats.rtf_min, curr)
+                                            : curr;
+        m_stats.rtf_max = max(m_stats.rtf_max, curr);
+        m_stats.intervals++;
+
+        m_sum_host += dhost;
+        m_sum_sim += dsim;
+        m_stats.rtf_avg = (double)m_sum_sim / (double)m_sum_host;
+    }
+
+    m_host_last = host;
+    m_sim_last = now;
+}
+
+void throttle::pace_async(const sc_time& t) {
+    static thread_local u64 next = 0;
+    if (m_rtf.load(std::memory_order_relaxed) <= 0.0 || t.value() < next)
+        return;
+
+    next = t.value() + update_interval.get().value();
+
+    u64 target = deadline(t);
+    if (host_time_ns() < target)
+        sleep_until(target);
+}
+
+bool throttle::cmd_stats(const vector<string>& args, ostream& os) {
+    os << "mode: " << (precise ? "precise" : "coarse") << std::endl
+       << "throttling: " << (m_throttling ? "yes" : "no") << std::endl
+       << "intervals: " << m_stats.intervals << " (" << m_stats.throttled
+       << " throttled)" << std::endl
+       << "rtf: " << m_stats.rtf_last << " last, " << m_stats.rtf_avg
+       << " avg, " << m_stats.rtf_min << " min, " << m_stats.rtf_max
+       << " max" << std::endl
+       << "drift: " << m_stats.drift << " last, " << m_stats.total_drift
+       << " total" << std::endl
+       << "max overshoot: " << m_stats.max_overshoot << std::endl
+       << "total sleep: " << m_stats.total_sleep << std::endl
+       << "credit drops: " << m_stats.credit_drops;
+    return true;
+}
+
 throttle::throttle(const sc_module_name& nm):
     module(nm),
     m_throttling(false),
     m_start(mwr::timestamp_us()),
     m_extra(0),
+    m_host_origin(host_time_ns()),
+    m_sim_origin(0),
+    m_rtf(0.0),
+    m_host_last(m_host_origin),
+    m_sim_last(),
+    m_suspended(0),
+    m_sum_host(0),
+    m_sum_sim(0),
+    m_dropped(0),
+    m_stats(),
     update_interval("update_interval", sc_time(10.0, SC_MS)),
-    rtf("rtf", 0.0) {
+    rtf("rtf", 0.0),
+    precise("precise", false),
+    spin_window("spin_window", sc_time(50.0, SC_US)),
+    burst_credit("burst_credit", sc_time(10.0, SC_MS)),
+    async_pacing("async_pacing", true) {
     SC_HAS_PROCESS(throttle);
     SC_METHOD(update);
+
+    register_command("stats", 0, &throttle::cmd_stats,
+                     "shows real-time pacing statistics");
+}
+
+throttle::~throttle() {
+    if (precise && async_pacing)
+        sc_set_async_pacer(nullptr);
+}
+
+void throttle::end_of_elaboration() {
+    module::end_of_elaboration();
+
+    u64 host = host_time_ns();
+    rebase(host, sc_time_stamp());
+    m_host_last = host;
+    m_rtf = precise ? rtf.get() : 0.0;
+
+    if (precise && async_pacing)
+        sc_set_async_pacer([this](const sc_time& t) { pace_async(t); });
 }
 
 void throttle::session_suspend() {
     m_start -= mwr::timestamp_us();
+    m_suspended = host_time_ns();
 }
 
 void throttle::session_resume() {
     m_start += mwr::timestamp_us();
     m_extra = 0;
+
+    u64 paused = host_time_ns() - m_suspended;
+    m_host_origin += paused;
+    m_host_last += paused;
 }
 
 VCML_EXPORT_MODEL(vcml::meta::throttle, name, args) {
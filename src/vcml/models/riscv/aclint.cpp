@@ -13,13 +13,13 @@
 namespace vcml {
 namespace riscv {
 
-u64 aclint::get_cycles() const {
-    sc_time delta = sc_time_stamp() - m_time_reset;
+u64 aclint::get_cycles(const sc_time& t) const {
+    sc_time delta = t - m_time_reset;
     return delta / clock_cycle();
 }
 
 u64 aclint::read_mtime() {
-    return get_cycles();
+    return get_cycles(access_time_stamp());
 }
 
 void aclint::write_mtimecmp(u64 val, size_t hart) {
@@ -72,16 +72,23 @@ void aclint::write_ssip(u32 val, size_t hart) {
 
 void aclint::update_timer() {
     u64 mtime = get_cycles();
+    sc_time horizon = SC_MAX_TIME;
 
     for (auto& [hart, port] : irq_mtimer) {
         u64 mcomp = mtimecmp.get(hart);
         port->write(mtime >= mcomp);
 
-        if (mtime >= mcomp)
+        if (mtime >= mcomp) {
             log_debug("triggering hart %zu timer interrupt", hart);
-        else if (mcomp != ~0ull)
-            m_trigger.notify(clock_cycles(mcomp - mtime));
+        } else if (mcomp != ~0ull) {
+            sc_time delta = clock_cycles(mcomp - mtime);
+            horizon = min(horizon, sc_time_stamp() + delta);
+            m_trigger.notify(delta);
+        }
     }
+
+    // mtime reads beyond the next timer interrupt must sync to observe it
+    this->mtime.set_time_horizon(horizon);
 }
 
 aclint::aclint(const sc_module_name& nm):
@@ -104,7 +111,7 @@ aclint::aclint(const sc_module_name& nm):
     mtimecmp.allow_read_write();
     mtimecmp.on_write(&aclint::write_mtimecmp);
 
-    mtime.sync_on_read();
+    mtime.time_derived();
     mtime.allow_read_only();
     mtime.on_read(&aclint::read_mtime);
 
@@ -399,23 +399,25 @@ void aplic::notify(size_t idx, bool level) {
     switch (get_field<SOURCECFG_SM>(irq->sourcecfg)) {
     case SM_EDGE_RISE:
     case SM_LEVEL_HI:
-        if (level) {
-            irq->pending = true;
-            update(irq);
-        }
+        irq->pending = level;
         break;
 
     case SM_EDGE_FALL:
     case SM_LEVEL_LO:
-        if (!level) {
-            irq->pending = true;
-            update(irq);
-        }
+        irq->pending = !level;
         break;
 
     default:
         break;
     }
+
+    if (!irq->pending)
+        return;
+
+    if (deferred_update)
+        m_update_ev.notify(SC_ZERO_TIME);
+    else
+        update(irq);
 }
 
 void aplic::update() {
@@ -443,6 +445,16 @@ void aplic::update(irqinfo* irq) {
     }
 }
 
+void aplic::update_deferred() {
+    if (is_msi()) {
+        update();
+        return;
+    }
+
+    for (auto& [hart, port] : irq_out)
+        send_irq(hart);
+}
+
 void aplic::send_msi(u32 target, u32 guest, u32 eiid) {
     aplic* r = root();
 
@@ -492,6 +504,13 @@ void aplic::send_irq(u32 hart) {
     u32 idelivery = idc->idelivery;
     u32 iforce = idc->iforce;
 
+    // credit the source when forwarding outside of its own notification
+    gpio_origin origin{};
+    u32 eiid = get_field<TOPI_EIID>(itop);
+    if (itop && root()->irq_in.exists(eiid))
+        origin = root()->irq_in[eiid].origin();
+
+    gpio_origin_scope scope(origin);
     irq_out[hart] = enabled && idelivery && (iforce || itop);
 }
 
@@ -536,7 +555,9 @@ aplic::aplic(const sc_module_name& nm, aplic* parent):
     m_parent(parent),
     m_children(),
     m_irqs(),
+    m_update_ev("update_ev"),
     mmode("mmode", parent == nullptr),
+    deferred_update("deferred_update", false),
     domaincfg("domaincfg", 0x0000, 0x80000000),
     sourcecfg("sourcecfg", 0x0004, 0),
     mmsiaddrcfg("mmsiaddrcfg", 0x1bc0, 0),
@@ -673,6 +694,11 @@ aplic::aplic(const sc_module_name& nm, aplic* parent):
 
     if (m_parent)
         m_parent->m_children.push_back(this);
+
+    SC_HAS_PROCESS(aplic);
+    SC_METHOD(update_deferred);
+    sensitive << m_update_ev;
+    dont_initialize();
 }
 
 aplic::~aplic() {
@@ -694,6 +720,8 @@ void aplic::reset() {
 }
 
 void aplic::end_of_elaboration() {
+    peripheral::end_of_elaboration();
+
     for (auto& [hart, port] : irq_out)
         idcs[hart] = new hartidc(hart);
 }
@@ -1908,40 +1908,61 @@ void iommu::handle_command() {
 
     cqcsr |= CQCSR_BUSY;
 
-    while ((cqh != cqt) && (cqcsr & CQCSR_CQEN)) {
-        command cmd{};
-        u64 addr = base + cqh * sizeof(command);
-        if (failed(dma_readw(addr, cmd, false, false))) {
-            log_debug("command queue memory error");
-            update_cqcsr(CQCSR_CQMF);
-            break;
+    command cmds[16];
+    tlm_batch_op ops[MWR_ARRAY_SIZE(cmds)];
+
+    bool stop = false;
+    while ((cqh != cqt) && (cqcsr & CQCSR_CQEN) && !stop) {
+        // fetch pending commands up to the end of the ring in one go
+        u32 head = cqh;
+        u32 tail = cqt;
+        u32 count = tail > head ? tail - head : mask + 1 - head;
+        count = min<u32>(count, MWR_ARRAY_SIZE(cmds));
+        for (u32 i = 0; i < count; i++) {
+            u64 addr = base + (head + i) * sizeof(command);
+            ops[i] = { TLM_READ_COMMAND, addr, cmds + i, sizeof(command) };
         }
 
-        switch (cmd.opcode) {
-        case IOMMU_OPCODE_IOTINVAL:
-            handle_iotinval(cmd);
-            break;
-        case IOMMU_OPCODE_IOFENCE:
-            handle_iofence(cmd);
-            break;
-        case IOMMU_OPCODE_IOTDIR:
-            handle_iodir(cmd);
-            break;
-        case IOMMU_OPCODE_ATS:
-            handle_ats(cmd);
-            break;
-        default:
-            update_cqcsr(CQCSR_CMDILL);
-            break;
-        }
+        ddtp |= DDTP_BUSY;
+        out.access_batch(ops, count);
+        ddtp &= ~DDTP_BUSY;
 
-        if (cqcsr & CQCSR_CMDILL) {
-            log_debug("command queue illegal opcode: 0x%02x:0x%01x",
-                      (int)cmd.opcode, (int)cmd.func3);
-            break;
-        }
+        for (u32 i = 0; i < count && (cqcsr & CQCSR_CQEN); i++) {
+            const command& cmd = cmds[i];
+            if (failed(ops[i].resp)) {
+                log_debug("command queue memory error");
+                update_cqcsr(CQCSR_CQMF);
+                stop = true;
+                break;
+            }
 
-        cqh = (cqh + 1) & mask;
+            switch (cmd.opcode) {
+            case IOMMU_OPCODE_IOTINVAL:
+                handle_iotinval(cmd);
+                break;
+            case IOMMU_OPCODE_IOFENCE:
+                handle_iofence(cmd);
+                break;
+            case IOMMU_OPCODE_IOTDIR:
+                handle_iodir(cmd);
+                break;
+            case IOMMU_OPCODE_ATS:
+                handle_ats(cmd);
+                break;
+            default:
+                update_cqcsr(CQCSR_CMDILL);
+                break;
+            }
+
+            if (cqcsr & CQCSR_CMDILL) {
+                log_debug("command queue illegal opcode: 0x%02x:0x%01x",
+                          (int)cmd.opcode, (int)cmd.func3);
+                stop = true;
+                break;
+            }
+
+            cqh = (cqh + 1) & mask;
+        }
     }
 
     cqcsr &= ~CQCSR_BUSY;
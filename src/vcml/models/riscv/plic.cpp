@@ -167,6 +167,7 @@ void plic::update() {
         for (auto irq : irqs) {
             if (is_pending(irq.first) && is_enabled(irq.first, ctx.first) &&
                 !is_claimed(irq.first) && irq_priority(irq.first) > th) {
+                gpio_origin_scope origin(irq.second->origin());
                 ctx.second->write(true);
                 log_debug("forwarding irq %zu to context %zu", irq.first,
                           ctx.first);
@@ -175,10 +176,16 @@ void plic::update() {
     }
 }
 
+void plic::update_deferred() {
+    update();
+}
+
 plic::plic(const sc_module_name& nm):
     peripheral(nm),
     m_claims(),
     m_contexts(),
+    m_update_ev("update_ev"),
+    deferred_update("deferred_update", false),
     priority("priority", 0x0, 0),
     pending("pending", 0x1000, 0),
     irqs("irqs", NIRQ),
@@ -195,6 +202,11 @@ plic::plic(const sc_module_name& nm):
 
     for (unsigned int irq = 0; irq < NIRQ; irq++)
         m_claims[irq] = ~0u;
+
+    SC_HAS_PROCESS(plic);
+    SC_METHOD(update_deferred);
+    sensitive << m_update_ev;
+    dont_initialize();
 }
 
 plic::~plic() {
@@ -210,6 +222,8 @@ void plic::reset() {
 }
 
 void plic::end_of_elaboration() {
+    peripheral::end_of_elaboration();
+
     for (auto ctx : irqt)
         m_contexts[ctx.first] = new context(ctx.first);
 
@@ -219,7 +233,11 @@ void plic::end_of_elaboration() {
 void plic::gpio_notify(const gpio_target_socket& socket) {
     unsigned int irqno = irqs.index_of(socket);
     log_debug("irq %u %s", irqno, socket.read() ? "set" : "cleared");
-    update();
+
+    if (deferred_update)
+        m_update_ev.notify(SC_ZERO_TIME);
+    else
+        update();
 }
 
 VCML_EXPORT_MODEL(vcml::riscv::plic, name, args) {
@@ -214,6 +214,8 @@ pl011::pl011(const sc_module_name& nm):
 
     cid.sync_never();
     cid.allow_read_only();
+
+    map_shadow(range(0xfe0, 0xfff));
 }
 
 pl011::~pl011() {
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "vcml/models/serial/terminal.h"
+#include "vcml/debugging/startup.h"
 
 namespace vcml {
 namespace serial {
@@ -117,10 +118,14 @@ bool terminal::cmd_history(const vector<string>& args, ostream& os) {
 }
 
 void terminal::serial_transmit() {
+    if (m_replay.is_replaying())
+        serial_replay();
+
     while (true) {
         for (backend* b : m_listeners) {
             u8 data = 0xff;
             while (b->read(data)) {
+                m_replay.record(&data, sizeof(data));
                 serial_tx.send(data);
                 if (!untimed)
                     wait(serial_tx.cycle());
@@ -131,6 +136,21 @@ void terminal::serial_transmit() {
     }
 }
 
+void terminal::serial_replay() {
+    // host input is ignored during replay, only output reaches backends
+    vector<u8> data;
+    while (m_replay.wait_fetch(data)) {
+        for (u8 val : data) {
+            serial_tx.send(val);
+            if (!untimed)
+                wait(serial_tx.cycle());
+        }
+    }
+
+    while (true)
+        wait(m_async_ev);
+}
+
 void terminal::serial_receive(u8 data) {
     m_hist.insert(data);
     for (backend* b : m_listeners)
@@ -149,6 +169,7 @@ terminal::terminal(const sc_module_name& nm):
     m_backends(),
     m_listeners(),
     m_async_ev("async_ev"),
+    m_replay(name()),
     backends("backends", ""),
     config("config", "9600N8"),
     untimed("untimed", false),
@@ -220,6 +241,7 @@ void terminal::notify(backend* b) {
 
 size_t terminal::create_backend(const string& type) {
     auto guard = get_hierarchy_scope();
+    debugging::startup_scope scope(name(), "create_backend", type.c_str());
     m_backends[m_next_id] = backend::create(this, type);
     return m_next_id++;
 }
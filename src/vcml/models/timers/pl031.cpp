@@ -18,7 +18,8 @@ enum cr_bits : u32 {
 };
 
 u32 pl031::read_dr() {
-    return cr & CR_ENABLE ? m_offset + time_to_sec(sc_time_stamp()) : 0;
+    sc_time now = access_time_stamp();
+    return cr & CR_ENABLE ? m_offset + time_to_sec(now) : 0;
 }
 
 void pl031::write_mr(u32 val) {
@@ -57,8 +58,10 @@ void pl031::update() {
     u32 next = mr - read_dr();
     if (next == 0) {
         ris = 1;
+        dr.set_time_horizon(SC_MAX_TIME);
     } else {
         m_notify.notify(next, SC_SEC);
+        dr.set_time_horizon(sc_time_stamp() + sc_time(next, SC_SEC));
     }
 
     irq = (ris & imsc) && (cr & CR_ENABLE);
@@ -80,7 +83,7 @@ pl031::pl031(const sc_module_name& nm):
     cid("cid", 0xff0),
     in("in"),
     irq("irq") {
-    dr.sync_always();
+    dr.time_derived();
     dr.allow_read_only();
     dr.on_read(&pl031::read_dr);
 
@@ -111,6 +114,8 @@ pl031::pl031(const sc_module_name& nm):
     icr.allow_write_only();
     icr.on_write(&pl031::write_icr);
 
+    map_shadow(range(0xfe0, 0xfff));
+
     SC_HAS_PROCESS(pl031);
     SC_METHOD(update);
     sensitive << m_notify;
@@ -48,7 +48,12 @@ u32 sp804::timer::read_value() {
     if (!is_enabled())
         return load;
 
-    double delta = (sc_time_stamp() - m_prev) / (m_next - m_prev);
+    // timers have no transaction context of their own, so ask the parent
+    // for the initiator time and only sync once the next underflow is due
+    m_timer->sync_horizon(m_next);
+    sc_time now = m_timer->access_time_stamp();
+
+    double delta = (now - m_prev) / (m_next - m_prev);
     return load * (1.0 - delta);
 }
 
@@ -101,7 +106,7 @@ sp804::timer::timer(const sc_module_name& nm):
     load.allow_read_write();
     load.on_write(&timer::write_load);
 
-    value.sync_always();
+    value.sync_never();
     value.allow_read_only();
     value.on_read(&timer::read_value);
 
@@ -168,6 +173,8 @@ sp804::sp804(const sc_module_name& nm):
     cid.sync_never();
     cid.allow_read_only();
 
+    map_shadow(range(0xfe0, 0xfff));
+
     timer1.irq.bind(irq1);
     timer2.irq.bind(irq2);
 
@@ -273,6 +273,7 @@ drive::drive(const sc_module_name& nm, const string& img, bool ro):
     device(nm, DRIVE_DESC),
     m_mode(MODE_CBW),
     m_output(),
+    m_outpos(),
     m_len(),
     m_cmd(),
     m_sts(),
@@ -325,7 +326,7 @@ usb_result drive::get_data(u32 ep, u8* data, size_t len) {
         usb_msd_csw csw;
         csw.signature = 0x53425355;
         csw.tag = m_tag;
-        csw.residue = (u32)m_output.size();
+        csw.residue = (u32)(m_output.size() - m_outpos);
         csw.status = m_sts;
         memcpy(data, &csw, sizeof(csw));
         m_mode = MODE_CBW;
@@ -333,10 +334,10 @@ usb_result drive::get_data(u32 ep, u8* data, size_t len) {
     }
 
     case MODE_DATA_IN: {
-        len = min(len, m_output.size());
-        memcpy(data, m_output.data(), len);
-        m_output.erase(m_output.begin(), m_output.begin() + len);
-        if (m_output.empty())
+        len = min(len, m_output.size() - m_outpos);
+        memcpy(data, m_output.data() + m_outpos, len);
+        m_outpos += len;
+        if (m_outpos == m_output.size())
             m_mode = MODE_CSW;
         return USB_RESULT_SUCCESS;
     }
@@ -379,6 +380,9 @@ usb_result drive::set_data(u32 ep, const u8* data, size_t len) {
         else
             m_mode = MODE_DATA_OUT;
 
+        m_output.clear();
+        m_outpos = 0;
+
         m_tag = cbw.tag;
         m_cmd = cbw.cmd[0];
         m_len = cbw.data_len;
@@ -435,6 +439,7 @@ void drive::usb_reset_device() {
     m_sense = SENSE_NOTHING;
 
     m_output.clear();
+    m_outpos = 0;
 }
 
 VCML_EXPORT_MODEL(vcml::usb::drive, name, args) {
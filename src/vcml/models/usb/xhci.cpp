@@ -1016,27 +1016,45 @@ u32 xhci::handle_transmit(u32 slotid, u32 epid, trb& cmd) {
     u64 addr = cmd.parameter;
     u32 size = get_trb_data_length(cmd);
     u32 epno = (epid + 1) / 2;
-    for (u32 off = 0; off < size; off += ep->max_psize) {
-        vector<u8> buf(min(size - off, ep->max_psize));
+
+    if (size == 0)
+        return TRB_CC_SUCCESS;
+
+    if (!dirin && (cmd.control & TRB_IDT)) {
+        if (size > sizeof(cmd.parameter))
+            return TRB_CC_TRB_ERROR;
+        auto packet = usb_packet_out(slotid, epno, &cmd.parameter, size);
+        usb_out[slot->port].send(packet);
+        return usb_packet_ccode(packet);
+    }
+
+    // bulk endpoints receive the entire trb in one packet, all others are
+    // still served in chunks of their maximum packet size
+    u32 chunk = ep->max_psize ? ep->max_psize : size;
+    if (epid > 0 && (ep->type & 3) == USB_EP_BULK)
+        chunk = size;
+
+    vcml_access acs = dirin ? VCML_ACCESS_WRITE : VCML_ACCESS_READ;
+    u8* dmi = dma.lookup_dmi_ptr(addr, size, acs);
+    if (dmi == nullptr && m_xferbuf.size() < chunk)
+        m_xferbuf.resize(chunk);
+
+    for (u32 off = 0; off < size; off += chunk) {
+        u32 len = min(size - off, chunk);
+        u8* buf = dmi ? dmi + off : m_xferbuf.data();
 
         if (dirin) {
-            auto packet = usb_packet_in(slotid, epno, buf.data(), buf.size());
+            auto packet = usb_packet_in(slotid, epno, buf, len);
             usb_out[slot->port].send(packet);
             if (failed(packet))
                 return usb_packet_ccode(packet);
-            if (failed(dma.write(addr + off, buf.data(), buf.size())))
+            if (!dmi && failed(dma.write(addr + off, buf, len)))
                 return TRB_CC_DATA_BUFFER_ERROR;
         } else {
-            if (cmd.control & TRB_IDT) {
-                if (size > sizeof(cmd.parameter))
-                    return TRB_CC_TRB_ERROR;
-                memcpy(buf.data(), (u8*)&cmd.parameter + off, buf.size());
-            } else {
-                if (failed(dma.read(addr + off, buf.data(), buf.size())))
-                    return TRB_CC_DATA_BUFFER_ERROR;
-            }
+            if (!dmi && failed(dma.read(addr + off, buf, len)))
+                return TRB_CC_DATA_BUFFER_ERROR;
 
-            auto packet = usb_packet_out(slotid, epno, buf.data(), buf.size());
+            auto packet = usb_packet_out(slotid, epno, buf, len);
             usb_out[slot->port].send(packet);
             if (failed(packet))
                 return usb_packet_ccode(packet);
@@ -1047,37 +1065,37 @@ u32 xhci::handle_transmit(u32 slotid, u32 epid, trb& cmd) {
 }
 
 void xhci::schedule_transfers() {
-    u32 mfindex = get_mfindex();
-    for (size_t i = 1; i < num_slots; i++) {
-        auto slot = m_slots + i;
-        if (slot->enabled) {
-            for (size_t j = 0; j < 32; j++) {
-                auto ep = slot->endpoints + j;
-                if (ep->state == EP_RUNNING && ep->kicked &&
-                    ep->mfindex > mfindex) {
-                    m_trev.notify(125 * (ep->mfindex - mfindex), SC_US);
-                }
-            }
-        }
-    }
+    u64 mfindex = get_mfindex();
+    if (!m_ready.empty() && m_ready.top().mfindex > mfindex)
+        m_trev.notify(125 * (m_ready.top().mfindex - mfindex), SC_US);
 }
 
 bool xhci::get_transfer(u32& slotid, u32& epid) {
-    u32 mfindex = get_mfindex();
-    for (size_t i = 1; i < num_slots; i++) {
-        auto slot = m_slots + i;
-        if (slot->enabled) {
-            for (size_t j = 0; j < 32; j++) {
-                auto ep = slot->endpoints + j;
-                if (ep->state == EP_RUNNING && ep->kicked &&
-                    ep->mfindex <= mfindex) {
-                    ep->kicked = false;
-                    slotid = i;
-                    epid = j;
-                    return true;
-                }
-            }
+    u64 mfindex = get_mfindex();
+    while (!m_ready.empty()) {
+        ready_ep next = m_ready.top();
+        if (next.mfindex > mfindex)
+            return false;
+
+        m_ready.pop();
+
+        // entries are not removed when endpoints are stopped or disabled,
+        // so stale ones are dropped here instead
+        auto slot = m_slots + next.slotid;
+        auto ep = slot->endpoints + next.epid;
+        if (!slot->enabled || !ep->kicked || ep->state != EP_RUNNING)
+            continue;
+
+        if (ep->mfindex > next.mfindex) {
+            next.mfindex = ep->mfindex;
+            m_ready.push(next);
+            continue;
         }
+
+        ep->kicked = false;
+        slotid = next.slotid;
+        epid = next.epid;
+        return true;
     }
 
     return false;
@@ -1248,9 +1266,12 @@ void xhci::kick_endpoint(u32 slotid, u32 epid) {
         return;
     }
 
-    ep->kicked = true;
+    if (!ep->kicked) {
+        ep->kicked = true;
+        m_ready.push({ ep->mfindex, slotid, epid });
+    }
 
-    u32 mfindex = get_mfindex();
+    u64 mfindex = get_mfindex();
     if (ep->mfindex > mfindex)
         m_trev.notify(125 * (ep->mfindex - mfindex), SC_US);
     else
@@ -1315,7 +1336,13 @@ u32 xhci::cmd_address_device(trb& cmd, u32& slotid) {
     log_debug("input context at 0x%llx", ictx_addr);
     log_debug("output context at 0x%llx", octx_addr);
 
-    if (failed(dma.readw(ictx_addr, ictx))) {
+    tlm_batch_op ops[] = {
+        { TLM_READ_COMMAND, ictx_addr, &ictx, sizeof(ictx) },
+        { TLM_READ_COMMAND, ictx_addr + 32, &sctx, sizeof(sctx) },
+    };
+
+    dma.access_batch(ops, MWR_ARRAY_SIZE(ops));
+    if (failed(ops[0].resp)) {
         log_error("failed to read input context at 0x%llx", ictx_addr);
         return TRB_CC_TRB_ERROR;
     }
@@ -1325,7 +1352,7 @@ u32 xhci::cmd_address_device(trb& cmd, u32& slotid) {
         return TRB_CC_TRB_ERROR;
     }
 
-    if (failed(dma.readw(ictx_addr + 32, sctx))) {
+    if (failed(ops[1].resp)) {
         log_error("failed to read slot %u input data", slotid);
         return TRB_CC_TRB_ERROR;
     }
@@ -1479,20 +1506,40 @@ u32 xhci::cmd_evaluate_context(trb& cmd, u32& slotid) {
         return TRB_CC_TRB_ERROR;
     }
 
+    // fetch all contexts that need to be evaluated in one go
+    slot_context slotctx;
+    ep_context epctx[32];
+    vector<tlm_batch_op> ops;
+
     if (ictx.acf & bit(0)) {
-        slot_context slotctx;
-        if (failed(dma.readw(ictx_addr + 32, slotctx))) {
-            log_error("failed to read slot context at 0x%llx", ictx_addr + 32);
+        ops.push_back({ TLM_READ_COMMAND, ictx_addr + 32, &slotctx,
+                        sizeof(slotctx) });
+    }
+
+    for (u32 i = 1; i < 32; i++) {
+        if (ictx.acf & bit(i + 1)) {
+            u64 input_addr = ictx_addr + 32 + 32 + 32 * i;
+            ops.push_back({ TLM_READ_COMMAND, input_addr, epctx + i,
+                            sizeof(epctx[i]) });
+        }
+    }
+
+    dma.access_batch(ops);
+    for (const tlm_batch_op& op : ops) {
+        if (failed(op.resp)) {
+            log_error("failed to read slot%u input context at 0x%llx", slotid,
+                      op.addr);
             return TRB_CC_TRB_ERROR;
         }
+    }
+
+    ops.clear();
 
+    if (ictx.acf & bit(0)) {
         slot->intr = slotctx.intr();
         slot->port = slotctx.portno() - 1;
-
-        if (failed(dma.writew(slot->context, slotctx))) {
-            log_error("failed to write slot context at 0x%llx", slot->context);
-            return TRB_CC_TRB_ERROR;
-        }
+        ops.push_back({ TLM_WRITE_COMMAND, slot->context, &slotctx,
+                        sizeof(slotctx) });
 
         log_debug("slot%u updated", slotid);
         log_debug("  context: 0x%llx", slot->context);
@@ -1503,28 +1550,17 @@ u32 xhci::cmd_evaluate_context(trb& cmd, u32& slotid) {
     for (u32 i = 1; i < 32; i++) {
         if (ictx.acf & bit(i + 1)) {
             u64 epctx_addr = slot->context + 32 + 32 * i;
-            u64 input_addr = ictx_addr + 32 + 32 + 32 * i;
-
-            ep_context epctx;
-            if (failed(dma.readw(input_addr, epctx))) {
-                log_error("failed to read slot%u.ep%u input context at 0x%llx",
-                          slotid, i, input_addr);
-                return TRB_CC_TRB_ERROR;
-            }
 
             auto ep = slot->endpoints + i;
-            ep->state = epctx.state();
-            ep->tr.dequeue = epctx.dequeue_ptr();
-            ep->tr.ccs = epctx.dcs();
+            ep->state = epctx[i].state();
+            ep->tr.dequeue = epctx[i].dequeue_ptr();
+            ep->tr.ccs = epctx[i].dcs();
             ep->max_pstreams = 0; // streams not supported
-            ep->max_psize = epctx.max_psize();
-            ep->interval = epctx.interval();
+            ep->max_psize = epctx[i].max_psize();
+            ep->interval = epctx[i].interval();
 
-            if (failed(dma.writew(epctx_addr, epctx))) {
-                log_error("failed to write slot%u.ep%u context at 0x%llx",
-                          slotid, i, epctx_addr);
-                return TRB_CC_TRB_ERROR;
-            }
+            ops.push_back({ TLM_WRITE_COMMAND, epctx_addr, epctx + i,
+                            sizeof(epctx[i]) });
 
             log_debug("slot%u.ep%u updated", slotid, i);
             log_debug("  type: %s (%u)", usb_endpoint_str(ep->type), ep->type);
@@ -1536,6 +1572,15 @@ u32 xhci::cmd_evaluate_context(trb& cmd, u32& slotid) {
         }
     }
 
+    dma.access_batch(ops);
+    for (const tlm_batch_op& op : ops) {
+        if (failed(op.resp)) {
+            log_error("failed to write slot%u context at 0x%llx", slotid,
+                      op.addr);
+            return TRB_CC_TRB_ERROR;
+        }
+    }
+
     return TRB_CC_TRB_ERROR;
 }
 
@@ -1858,6 +1903,8 @@ xhci::xhci(const sc_module_name& nm):
     m_events(),
     m_cmdring(),
     m_slots(),
+    m_ready(),
+    m_xferbuf(),
     num_slots("num_slots", 64),
     num_ports("num_ports", 4),
     num_intrs("num_intrs", 1),
@@ -1978,6 +2025,8 @@ void xhci::reset() {
     for (auto& slot : m_slots)
         slot.reset();
 
+    m_ready = {};
+
     for (size_t i = 0; i < 2 * num_ports; i++)
         port_update(i, true);
 }
@@ -13,6 +13,228 @@
 
 namespace vcml {
 
+static bool is_glob(const string& s) {
+    return s.find_first_of("*?") != string::npos;
+}
+
+static bool glob_match(const char* pat, const char* str) {
+    const char* star = nullptr;
+    const char* retry = nullptr;
+
+    while (*str) {
+        if (*pat == '?' || *pat == *str) {
+            pat++;
+            str++;
+        } else if (*pat == '*') {
+            star = pat++;
+            retry = str;
+        } else if (star) {
+            pat = star + 1;
+            str = ++retry;
+        } else {
+            return false;
+        }
+    }
+
+    while (*pat == '*')
+        pat++;
+
+    return *pat == '\0';
+}
+
+// rules matching fewer characters via '*' are considered more specific
+static size_t literals(const string& key) {
+    return key.size() - std::count(key.begin(), key.end(), '*');
+}
+
+// Merged view of the values of all brokers: exact keys are kept in a hash
+// table, wildcard rules in a trie of their hierarchy levels.
+class broker_index
+{
+public:
+    struct entry {
+        broker* owner;
+        broker::value* val;
+        size_t literals;
+        u64 seq;
+    };
+
+private:
+    struct node {
+        unordered_map<string, unique_ptr<node>> literal;
+        vector<pair<string, unique_ptr<node>>> pattern;
+        vector<entry> entries;
+    };
+
+    u64 m_seq;
+    size_t m_rules;
+    unordered_map<string, vector<entry>> m_exact;
+    node m_root;
+
+    node* walk(const string& key, bool create);
+
+    void match(const node& n, const vector<string>& levels, size_t idx,
+               const broker* only, const entry*& best) const;
+
+    static bool better(const entry& a, const entry* b);
+
+public:
+    size_t rules() const { return m_rules; }
+
+    broker_index(): m_seq(0), m_rules(0), m_exact(), m_root() {}
+
+    void insert(broker* owner, const string& key, broker::value* val);
+    void remove(const broker* owner, const string& key);
+
+    const entry* find(const string& key, const broker* only = nullptr) const;
+
+    static void update_ranks(const vector<broker*>& brokers);
+    static broker_index& instance();
+};
+
+broker_index::node* broker_index::walk(const string& key, bool create) {
+    node* curr = &m_root;
+    for (const string& level : split(key, SC_HIERARCHY_CHAR)) {
+        if (!is_glob(level)) {
+            auto it = curr->literal.find(level);
+            if (it == curr->literal.end()) {
+                if (!create)
+                    return nullptr;
+                it = curr->literal.emplace(level, std::make_unique<node>())
+                         .first;
+            }
+
+            curr = it->second.get();
+            continue;
+        }
+
+        auto it = std::find_if(curr->pattern.begin(), curr->pattern.end(),
+                               [&](const auto& p) { return p.first == level; });
+        if (it == curr->pattern.end()) {
+            if (!create)
+                return nullptr;
+            curr->pattern.emplace_back(level, std::make_unique<node>());
+            it = curr->pattern.end() - 1;
+        }
+
+        curr = it->second.get();
+    }
+
+    return curr;
+}
+
+void broker_index::match(const node& n, const vector<string>& levels,
+                         size_t idx, const broker* only,
+                         const entry*& best) const {
+    if (idx == levels.size()) {
+        for (const entry& e : n.entries)
+            if ((only == nullptr || e.owner == only) && better(e, best))
+                best = &e;
+    }
+
+    for (const auto& p : n.pattern) {
+        if (p.first == "**") {
+            for (size_t next = idx; next <= levels.size(); next++)
+                match(*p.second, levels, next, only, best);
+        } else if (idx < levels.size() &&
+                   glob_match(p.first.c_str(), levels[idx].c_str())) {
+            match(*p.second, levels, idx + 1, only, best);
+        }
+    }
+
+    if (idx < levels.size()) {
+        auto it = n.literal.find(levels[idx]);
+        if (it != n.literal.end())
+            match(*it->second, levels, idx + 1, only, best);
+    }
+}
+
+bool broker_index::better(const entry& a, const entry* b) {
+    if (b == nullptr)
+        return true;
+    if (a.owner->m_rank != b->owner->m_rank)
+        return a.owner->m_rank < b->owner->m_rank;
+    if (a.literals != b->literals)
+        return a.literals > b->literals;
+    return a.seq > b->seq;
+}
+
+void broker_index::insert(broker* owner, const string& key,
+                          broker::value* val) {
+    bool glob = is_glob(key);
+    vector<entry>& entries = glob ? walk(key, true)->entries : m_exact[key];
+    size_t lit = glob ? literals(key) : SIZE_MAX;
+
+    for (entry& e : entries) {
+        if (e.owner == owner) {
+            e.val = val;
+            e.seq = m_seq++;
+            return;
+        }
+    }
+
+    entries.push_back({ owner, val, lit, m_seq++ });
+    if (glob)
+        m_rules++;
+}
+
+void broker_index::remove(const broker* owner, const string& key) {
+    bool glob = is_glob(key);
+    vector<entry>* entries = nullptr;
+    if (glob) {
+        node* n = walk(key, false);
+        entries = n ? &n->entries : nullptr;
+    } else {
+        auto it = m_exact.find(key);
+        entries = it != m_exact.end() ? &it->second : nullptr;
+    }
+
+    if (entries == nullptr)
+        return;
+
+    size_t n = entries->size();
+    stl_remove_if(*entries, [owner](const entry& e) -> bool {
+        return e.owner == owner;
+    });
+
+    if (glob)
+        m_rules -= n - entries->size();
+    else if (entries->empty())
+        m_exact.erase(key);
+}
+
+const broker_index::entry* broker_index::find(const string& key,
+                                              const broker* only) const {
+    const entry* best = nullptr;
+
+    auto it = m_exact.find(key);
+    if (it != m_exact.end()) {
+        for (const entry& e : it->second)
+            if ((only == nullptr || e.owner == only) && better(e, best))
+                best = &e;
+    }
+
+    if (m_rules > 0)
+        match(m_root, split(key, SC_HIERARCHY_CHAR), 0, only, best);
+
+    return best;
+}
+
+void broker_index::update_ranks(const vector<broker*>& brokers) {
+    for (size_t i = 0; i < brokers.size(); i++)
+        brokers[i]->m_rank = i;
+}
+
+broker_index& broker_index::instance() {
+    static broker_index index;
+    return index;
+}
+
+static vector<broker*> g_brokers;
+
+// expanded ${...} variables, dropped whenever their key gets redefined
+static unordered_map<string, string> g_expansions;
+
 string broker::expand(const string& s) {
     string str = s;
     size_t pos = 0;
@@ -21,8 +243,14 @@ string broker::expand(const string& s) {
         VCML_REPORT_ON(end == str.npos, "missing '}' near '%s'", str.c_str());
 
         string val, key = str.substr(pos + 2, end - pos - 2);
-        if (!init(key, val))
-            VCML_REPORT("%s is not defined", key.c_str());
+        auto it = g_expansions.find(key);
+        if (it != g_expansions.end()) {
+            val = it->second;
+        } else {
+            if (!init(key, val))
+                VCML_REPORT("%s is not defined", key.c_str());
+            g_expansions[key] = val;
+        }
 
         str = strcat(str.substr(0, pos), val, str.substr(end + 1));
     }
@@ -30,66 +258,100 @@ string broker::expand(const string& s) {
     return trim(str);
 }
 
-static vector<broker*> g_brokers;
+void broker::insert(const string& key, const string& val, size_t uses) {
+    auto& entry = m_values[key];
+    entry = { val, uses };
+    broker_index::instance().insert(this, key, &entry);
+
+    if (is_glob(key))
+        g_expansions.clear();
+    else
+        g_expansions.erase(key);
+}
+
+broker::broker(const string& nm, bool insert_front):
+    m_name(nm), m_rank(0), m_dynamic(false), m_values() {
+    if (insert_front)
+        g_brokers.insert(g_brokers.begin(), this);
+    else
+        g_brokers.push_back(this);
+    broker_index::update_ranks(g_brokers);
+    g_expansions.clear();
 
-broker::broker(const string& nm, bool insert_front): m_name(nm), m_values() {
     define("app", mwr::progname(), 1);
     define("bin", mwr::dirname(mwr::progname()), 1);
     define("pwd", mwr::curr_dir(), 1);
     define("tmp", mwr::temp_dir(), 1);
     define("usr", mwr::username(), 1);
     define("pid", mwr::getpid(), 1);
-    if (insert_front)
-        g_brokers.insert(g_brokers.begin(), this);
-    else
-        g_brokers.push_back(this);
 }
 
 broker::~broker() {
+    for (const auto& value : m_values)
+        broker_index::instance().remove(this, value.first);
+
     stl_remove(g_brokers, this);
+    broker_index::update_ranks(g_brokers);
+    g_expansions.clear();
 }
 
 bool broker::lookup(const string& key, string& value) {
-    if (!stl_contains(m_values, key))
-        return false;
-
-    auto it = m_values.find(key);
-    if (it == m_values.end())
+    auto entry = broker_index::instance().find(key, this);
+    if (entry == nullptr)
         return false;
 
-    value = it->second.value;
-    it->second.uses++;
+    value = entry->val->value;
+    entry->val->uses++;
     return true;
 }
 
 bool broker::defines(const string& key) const {
-    return stl_contains(m_values, key);
+    return broker_index::instance().find(key, this) != nullptr;
+}
+
+void broker::undefine(const string& key) {
+    broker_index::instance().remove(this, key);
+    m_values.erase(key);
+
+    if (is_glob(key))
+        g_expansions.clear();
+    else
+        g_expansions.erase(key);
 }
 
 template <>
 broker* broker::init(const string& name, string& value) {
-    for (auto broker : g_brokers)
-        if (broker->lookup(name, value))
+    auto entry = broker_index::instance().find(name);
+    size_t rank = entry ? entry->owner->m_rank : g_brokers.size();
+
+    for (auto broker : g_brokers) {
+        if (broker->m_rank > rank)
+            break;
+        if (broker->m_dynamic && broker->lookup(name, value))
             return broker;
-    return nullptr;
+    }
+
+    if (entry == nullptr)
+        return nullptr;
+
+    value = entry->val->value;
+    entry->val->uses++;
+    return entry->owner;
 }
 
 vector<pair<string, broker*>> broker::collect_unused() {
-    vector<pair<string, broker*>> unused;
+    unordered_set<string> used;
     for (auto& brkr : g_brokers) {
         for (auto& value : brkr->m_values)
-            if (value.second.uses == 0)
-                unused.push_back({ value.first, brkr });
+            if (value.second.uses > 0)
+                used.insert(value.first);
     }
 
+    vector<pair<string, broker*>> unused;
     for (auto& brkr : g_brokers) {
-        for (auto& value : brkr->m_values) {
-            if (value.second.uses > 0) {
-                stl_remove_if(unused, [&](auto& entry) -> bool {
-                    return entry.first == value.first;
-                });
-            }
-        }
+        for (auto& value : brkr->m_values)
+            if (value.second.uses == 0 && !used.count(value.first))
+                unused.push_back({ value.first, brkr });
     }
 
     return unused;
@@ -10,10 +10,25 @@
 
 #include "vcml/properties/broker_env.h"
 
+#ifndef _WIN32
+extern char** environ;
+#endif
+
 namespace vcml {
 
-broker_env::broker_env(): broker("environment") {
-    // nothing to do
+static string env_name(const string& name) {
+    string nm = name;
+    std::replace(nm.begin(), nm.end(), SC_HIERARCHY_CHAR, '_');
+    return nm;
+}
+
+broker_env::broker_env(): broker("environment"), m_env() {
+    m_dynamic = true;
+    for (char** env = environ; env && *env; env++) {
+        const char* sep = strchr(*env, '=');
+        if (sep != nullptr)
+            m_env[string(*env, sep - *env)] = sep + 1;
+    }
 }
 
 broker_env::~broker_env() {
@@ -21,20 +36,15 @@ broker_env::~broker_env() {
 }
 
 bool broker_env::defines(const string& name) const {
-    string nm = name;
-    std::replace(nm.begin(), nm.end(), SC_HIERARCHY_CHAR, '_');
-    return mwr::getenv(name).has_value();
+    return stl_contains(m_env, env_name(name));
 }
 
 bool broker_env::lookup(const string& name, string& val) {
-    string nm = name;
-    std::replace(nm.begin(), nm.end(), SC_HIERARCHY_CHAR, '_');
-
-    auto env = mwr::getenv(nm);
-    if (!env)
+    auto it = m_env.find(env_name(name));
+    if (it == m_env.end())
         return false;
 
-    val = mwr::escape(env.value(), "");
+    val = mwr::escape(it->second, "");
     return true;
 }
 
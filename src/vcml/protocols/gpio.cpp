@@ -21,6 +21,22 @@ ostream& operator<<(ostream& os, const gpio_payload& tx) {
     return os;
 }
 
+static thread_local const gpio_origin* g_origin = nullptr;
+
+const gpio_origin* gpio_current_origin() {
+    return g_origin;
+}
+
+gpio_origin_scope::gpio_origin_scope(const gpio_origin& origin):
+    m_prev(g_origin) {
+    if (origin.is_valid())
+        g_origin = &origin;
+}
+
+gpio_origin_scope::~gpio_origin_scope() {
+    g_origin = m_prev;
+}
+
 gpio_base_initiator_socket::gpio_base_initiator_socket(const char* nm,
                                                        address_space as):
     gpio_base_initiator_socket_b(nm, as), m_stub(nullptr), m_adapter(nullptr) {
@@ -118,8 +134,20 @@ gpio_initiator_socket::gpio_initiator_socket(const char* nm, address_space as):
     gpio_base_initiator_socket(nm, as),
     m_host(dynamic_cast<gpio_host*>(hierarchy_top())),
     m_event(nullptr),
+    m_novec(),
+    m_dense(),
     m_state(),
     m_transport(this) {
+    m_novec.parent = this;
+    m_novec.vector = GPIO_NO_VECTOR;
+    m_novec.state = false;
+
+    for (size_t i = 0; i < GPIO_DENSE_VECTORS; i++) {
+        m_dense[i].parent = this;
+        m_dense[i].vector = i;
+        m_dense[i].state = false;
+    }
+
     bind(m_transport);
 }
 
@@ -138,13 +166,49 @@ const sc_event& gpio_initiator_socket::default_event() {
 }
 
 bool gpio_initiator_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    const gpio_state_tracker* tracker = lookup(vector);
+    return tracker ? tracker->state : false;
 }
 
 void gpio_initiator_socket::write(bool state, gpio_vector vector) {
     (*this)[vector] = state;
 }
 
+void gpio_initiator_socket::write(bool state,
+                                  const vector<gpio_vector>& vectors) {
+    vector<gpio_payload> txs;
+    txs.reserve(vectors.size());
+
+    for (gpio_vector vector : vectors) {
+        gpio_state_tracker& tracker = (*this)[vector];
+        if (tracker.state != state) {
+            tracker.state = state;
+            txs.push_back(tracker);
+        }
+    }
+
+    gpio_transport(txs.data(), txs.size());
+}
+
+void gpio_initiator_socket::write_mask(u64 mask, u64 state, gpio_vector base) {
+    gpio_payload txs[64];
+    size_t count = 0;
+
+    while (mask) {
+        unsigned int idx = ctz(mask);
+        mask &= mask - 1;
+
+        bool val = (state >> idx) & 1;
+        gpio_state_tracker& tracker = (*this)[base + idx];
+        if (tracker.state != val) {
+            tracker.state = val;
+            txs[count++] = tracker;
+        }
+    }
+
+    gpio_transport(txs, count);
+}
+
 void gpio_initiator_socket::raise(gpio_vector vector) {
     write(true, vector);
 }
@@ -180,8 +244,9 @@ gpio_initiator_socket& gpio_initiator_socket::operator^=(bool set) {
 
 gpio_initiator_socket::gpio_state_tracker& gpio_initiator_socket::operator[](
     gpio_vector vector) {
-    if (m_state.count(vector))
-        return m_state[vector];
+    gpio_state_tracker* tracker = lookup(vector);
+    if (tracker)
+        return *tracker;
 
     gpio_state_tracker state;
     state.parent = this;
@@ -191,7 +256,35 @@ gpio_initiator_socket::gpio_state_tracker& gpio_initiator_socket::operator[](
     return m_state[vector] = state;
 }
 
+gpio_initiator_socket::gpio_state_tracker* gpio_initiator_socket::lookup(
+    gpio_vector vector) {
+    if (vector == GPIO_NO_VECTOR)
+        return &m_novec;
+    if (vector < GPIO_DENSE_VECTORS)
+        return m_dense + vector;
+
+    auto it = m_state.find(vector);
+    return it != m_state.end() ? &it->second : nullptr;
+}
+
+const gpio_initiator_socket::gpio_state_tracker* gpio_initiator_socket::lookup(
+    gpio_vector vector) const {
+    if (vector == GPIO_NO_VECTOR)
+        return &m_novec;
+    if (vector < GPIO_DENSE_VECTORS)
+        return m_dense + vector;
+
+    auto it = m_state.find(vector);
+    return it != m_state.end() ? &it->second : nullptr;
+}
+
 void gpio_initiator_socket::gpio_transport(gpio_payload& tx) {
+    // raising a line without an origin makes this socket the origin
+    gpio_origin origin{ this, sc_time_stamp().value() };
+    if (!tx.state || g_origin)
+        origin.source = nullptr;
+    gpio_origin_scope scope(origin);
+
     trace_fw(tx);
     for (int i = 0; i < size(); i++)
         get_interface(i)->gpio_transport(tx);
@@ -200,10 +293,37 @@ void gpio_initiator_socket::gpio_transport(gpio_payload& tx) {
     trace_bw(tx);
 }
 
+void gpio_initiator_socket::gpio_transport(gpio_payload* txs, size_t count) {
+    if (count == 0)
+        return;
+
+    gpio_origin origin{ g_origin ? nullptr : this, sc_time_stamp().value() };
+    gpio_origin_scope scope(origin);
+
+    for (size_t n = 0; n < count; n++)
+        trace_fw(txs[n]);
+
+    for (int i = 0; i < size(); i++) {
+        gpio_fw_transport_if* target = get_interface(i);
+        for (size_t n = 0; n < count; n++)
+            target->gpio_transport(txs[n]);
+    }
+
+    if (m_event)
+        m_event->notify(SC_ZERO_TIME);
+
+    for (size_t n = 0; n < count; n++)
+        trace_bw(txs[n]);
+}
+
 gpio_target_socket::gpio_target_socket(const char* nm, address_space space):
     gpio_base_target_socket(nm, space),
     m_host(hierarchy_search<gpio_host>()),
     m_event(nullptr),
+    m_dense_valid(0),
+    m_dense_state(0),
+    m_novec(-1),
+    m_origin(),
     m_state(),
     m_initiator(nullptr),
     m_targets(),
@@ -243,7 +363,13 @@ void gpio_target_socket::complete_binding(gpio_base_initiator_socket& socket) {
 }
 
 bool gpio_target_socket::read(gpio_vector vector) const {
-    return m_state.count(vector) ? m_state.at(vector) : false;
+    if (vector == GPIO_NO_VECTOR)
+        return m_novec > 0;
+    if (vector < GPIO_DENSE_VECTORS)
+        return (m_dense_state >> vector) & 1;
+
+    auto it = m_state.find(vector);
+    return it != m_state.end() ? it->second : false;
 }
 
 bool gpio_target_socket::operator==(const gpio_target_socket& other) const {
@@ -254,10 +380,41 @@ bool gpio_target_socket::operator!=(const gpio_target_socket& other) const {
     return !(operator==(other));
 }
 
+bool gpio_target_socket::update_state(const gpio_payload& tx) {
+    if (tx.vector == GPIO_NO_VECTOR) {
+        if (m_novec == (int)tx.state)
+            return false;
+        m_novec = tx.state;
+        return true;
+    }
+
+    if (tx.vector < GPIO_DENSE_VECTORS) {
+        u64 mask = 1ull << tx.vector;
+        u64 bits = tx.state ? mask : 0;
+        if ((m_dense_valid & mask) && (m_dense_state & mask) == bits)
+            return false;
+        m_dense_valid |= mask;
+        m_dense_state = (m_dense_state & ~mask) | bits;
+        return true;
+    }
+
+    auto it = m_state.find(tx.vector);
+    if (it != m_state.end() && it->second == tx.state)
+        return false;
+
+    m_state[tx.vector] = tx.state;
+    return true;
+}
+
 void gpio_target_socket::gpio_transport_internal(gpio_payload& tx) {
     trace_fw(tx);
-    if (m_state.count(tx.vector) == 0 || m_state[tx.vector] != tx.state) {
-        m_state[tx.vector] = tx.state;
+    if (update_state(tx)) {
+        if (tx.state) {
+            const gpio_origin* origin = gpio_current_origin();
+            m_origin = origin ? *origin
+                              : gpio_origin{ nullptr, sc_time_stamp().value() };
+        }
+
         gpio_transport(tx);
         if (m_event)
             m_event->notify(SC_ZERO_TIME);
@@ -88,4 +88,158 @@ bool tlm_exmon::override_dmi(const tlm_generic_payload& tx, tlm_dmi& dmi) {
     return true;
 }
 
+atomic<bool> dmi_exmon::s_active(false);
+atomic<u64> dmi_exmon::s_lines[1ull << dmi_exmon::TABLE_BITS];
+
+template <typename T>
+static bool host_cas_as(u8* ptr, u64& expected, u64 desired) {
+    T exp = (T)expected;
+    bool ok = __atomic_compare_exchange_n((T*)ptr, &exp, (T)desired, false,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    expected = exp;
+    return ok;
+}
+
+template <typename T>
+static u64 bytes_to_u64(const void* data) {
+    T val;
+    memcpy(&val, data, sizeof(val));
+    return val;
+}
+
+template <typename T>
+static void u64_to_bytes(void* data, u64 val) {
+    T tmp = (T)val;
+    memcpy(data, &tmp, sizeof(tmp));
+}
+
+u64 dmi_exmon::host_load(const u8* ptr, unsigned int size) {
+    switch (size) {
+    case 1:
+        return __atomic_load_n((const u8*)ptr, __ATOMIC_ACQUIRE);
+    case 2:
+        return __atomic_load_n((const u16*)ptr, __ATOMIC_ACQUIRE);
+    case 4:
+        return __atomic_load_n((const u32*)ptr, __ATOMIC_ACQUIRE);
+    case 8:
+        return __atomic_load_n((const u64*)ptr, __ATOMIC_ACQUIRE);
+    default:
+        VCML_ERROR("invalid atomic access size: %u", size);
+    }
+}
+
+bool dmi_exmon::host_cas(u8* ptr, unsigned int size, u64& expected,
+                         u64 desired) {
+    switch (size) {
+    case 1:
+        return host_cas_as<u8>(ptr, expected, desired);
+    case 2:
+        return host_cas_as<u16>(ptr, expected, desired);
+    case 4:
+        return host_cas_as<u32>(ptr, expected, desired);
+    case 8:
+        return host_cas_as<u64>(ptr, expected, desired);
+    default:
+        VCML_ERROR("invalid atomic access size: %u", size);
+    }
+}
+
+// line versions are even while unlocked; an exclusive store makes its line
+// odd for the duration of the memory update so that concurrent exclusive
+// loads never observe an intermediate state, all other writers add two
+void dmi_exmon::load_exclusive(dmi_reservation& res, u8* ptr, void* data,
+                               unsigned int size) {
+    VCML_ERROR_ON(!can_access(ptr, size), "invalid exclusive access");
+
+    if (!is_active())
+        s_active = true;
+
+    atomic<u64>& ln = line(ptr);
+    u64 ver = ln.load(std::memory_order_acquire);
+    while (ver & 1) {
+        std::this_thread::yield();
+        ver = ln.load(std::memory_order_acquire);
+    }
+
+    res.ptr = ptr;
+    res.size = size;
+    res.version = ver;
+    res.data = host_load(ptr, size);
+
+    switch (size) {
+    case 1:
+        u64_to_bytes<u8>(data, res.data);
+        break;
+    case 2:
+        u64_to_bytes<u16>(data, res.data);
+        break;
+    case 4:
+        u64_to_bytes<u32>(data, res.data);
+        break;
+    default:
+        u64_to_bytes<u64>(data, res.data);
+        break;
+    }
+}
+
+bool dmi_exmon::store_exclusive(dmi_reservation& res, u8* ptr,
+                                const void* data, unsigned int size) {
+    bool valid = res.ptr == ptr && res.size == size;
+    u64 ver = res.version;
+    u64 expected = res.data;
+    clear_exclusive(res);
+
+    if (!valid)
+        return false;
+
+    u64 desired = 0;
+    switch (size) {
+    case 1:
+        desired = bytes_to_u64<u8>(data);
+        break;
+    case 2:
+        desired = bytes_to_u64<u16>(data);
+        break;
+    case 4:
+        desired = bytes_to_u64<u32>(data);
+        break;
+    default:
+        desired = bytes_to_u64<u64>(data);
+        break;
+    }
+
+    atomic<u64>& ln = line(ptr);
+    if (!ln.compare_exchange_strong(ver, ver + 1, std::memory_order_acq_rel))
+        return false;
+
+    bool ok = host_cas(ptr, size, expected, desired);
+    if (ok)
+        ln.fetch_add(1, std::memory_order_release);
+    else
+        ln.fetch_sub(1, std::memory_order_release);
+
+    return ok;
+}
+
+void dmi_exmon::clear_exclusive(dmi_reservation& res) {
+    res.ptr = nullptr;
+    res.size = 0;
+}
+
+void dmi_exmon::break_reservations(const u8* ptr, size_t size) {
+    if (!is_active() || size == 0)
+        return;
+
+    uintptr_t lo = (uintptr_t)ptr >> LINE_BITS;
+    uintptr_t hi = ((uintptr_t)ptr + size - 1) >> LINE_BITS;
+    if (hi - lo >= (1ull << TABLE_BITS)) {
+        for (atomic<u64>& ln : s_lines)
+            ln.fetch_add(2, std::memory_order_release);
+        return;
+    }
+
+    for (uintptr_t l = lo; l <= hi; l++)
+        line((const u8*)(l << LINE_BITS)).fetch_add(2);
+}
+
 } // namespace vcml
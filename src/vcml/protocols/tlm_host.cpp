@@ -99,12 +99,36 @@ sc_time tlm_host::local_time_stamp(sc_process_b* proc) {
     return sc_time_stamp() + local_time(proc);
 }
 
+static mutex g_quanta_mtx;
+static atomic<bool> g_quanta_used(false);
+static atomic<u64> g_quanta_epoch(0);
+static unordered_map<sc_process_b*, sc_time> g_quanta;
+
+static sc_time lookup_quantum(sc_process_b* proc) {
+    lock_guard<mutex> guard(g_quanta_mtx);
+    auto it = g_quanta.find(proc);
+    return it != g_quanta.end() ? it->second : SC_ZERO_TIME;
+}
+
 bool tlm_host::needs_sync(sc_process_b* proc) {
     if (!is_thread(proc))
         return false;
 
-    sc_time quantum = tlm::tlm_global_quantum::instance().get();
-    return local_time(proc) >= quantum;
+    sc_time& local = local_time(proc);
+    if (g_quanta_used) {
+        // process quanta are cached and only looked up again after changes
+        proc_data& data = m_processes[proc];
+        u64 epoch = g_quanta_epoch.load(std::memory_order_acquire);
+        if (data.quantum_epoch != epoch) {
+            data.quantum = lookup_quantum(proc);
+            data.quantum_epoch = epoch;
+        }
+
+        if (data.quantum != SC_ZERO_TIME)
+            return local >= data.quantum;
+    }
+
+    return local >= tlm::tlm_global_quantum::instance().get();
 }
 
 void tlm_host::sync(sc_process_b* proc) {
@@ -116,6 +140,26 @@ void tlm_host::sync(sc_process_b* proc) {
     offset = SC_ZERO_TIME;
 }
 
+sc_time tlm_host::process_quantum(sc_process_b* proc) {
+    if (g_quanta_used) {
+        sc_time quantum = lookup_quantum(proc);
+        if (quantum != SC_ZERO_TIME)
+            return quantum;
+    }
+
+    return tlm::tlm_global_quantum::instance().get();
+}
+
+void tlm_host::set_process_quantum(sc_process_b* proc, const sc_time& q) {
+    lock_guard<mutex> guard(g_quanta_mtx);
+    if (q == SC_ZERO_TIME)
+        g_quanta.erase(proc);
+    else
+        g_quanta[proc] = q;
+    g_quanta_used = !g_quanta.empty();
+    g_quanta_epoch.fetch_add(1, std::memory_order_release);
+}
+
 void tlm_host::map_dmi(const tlm_dmi& dmi) {
     for (auto socket : m_target_sockets)
         socket->map_dmi(dmi);
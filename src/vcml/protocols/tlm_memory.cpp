@@ -0,0 +1,105 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "vcml/protocols/tlm_memory.h"
+
+namespace vcml {
+
+// registry of shared memories, used to export them to other processes
+static mutex g_shared_mtx;
+static set<const tlm_memory*> g_shared_memories;
+
+void tlm_memory::register_shared() {
+    lock_guard<mutex> guard(g_shared_mtx);
+    g_shared_memories.insert(this);
+}
+
+void tlm_memory::unregister_shared() {
+    lock_guard<mutex> guard(g_shared_mtx);
+    g_shared_memories.erase(this);
+}
+
+const tlm_memory* tlm_memory::find_shared(const void* ptr) {
+    lock_guard<mutex> guard(g_shared_mtx);
+    for (const tlm_memory* mem : g_shared_memories) {
+        const u8* base = mem->data();
+        if (ptr >= base && ptr < base + mem->size())
+            return mem;
+    }
+
+    return nullptr;
+}
+
+// platform independent page tracking for lazy poisoning, the platform
+// specific parts (mapping, release) live in tlm_memory_{posix,win32}.cpp
+
+static size_t page_shift() {
+    static const size_t shift = ctz((u64)mwr::get_page_size());
+    return shift;
+}
+
+bool tlm_memory::is_pending(u64 offset) const {
+    if (m_npending == 0)
+        return false;
+
+    u64 page = offset >> page_shift();
+    return m_pending[page / 64] & (1ull << (page % 64));
+}
+
+void tlm_memory::poison(u8 val) {
+    if (data() == nullptr)
+        return;
+
+    release();
+
+    size_t npages = (size() + (1ull << page_shift()) - 1) >> page_shift();
+    m_poison = val;
+    m_pending.assign((npages + 63) / 64, 0);
+    m_npending = 0;
+
+    if (val == 0)
+        return;
+
+    std::fill(m_pending.begin(), m_pending.end(), ~0ull);
+    if (npages % 64)
+        m_pending.back() = (1ull << (npages % 64)) - 1;
+    m_npending = npages;
+}
+
+void tlm_memory::resolve(u64 start, u64 end, bool apply) {
+    if (m_npending == 0 || start > end || start >= size())
+        return;
+
+    const size_t shift = page_shift();
+    const u64 pgsz = 1ull << shift;
+
+    end = min<u64>(end, size() - 1);
+    for (u64 page = start >> shift; page <= end >> shift; page++) {
+        u64& word = m_pending[page / 64];
+        if (word == 0) {
+            page |= 63; // skip the entire word
+            continue;
+        }
+
+        u64 mask = 1ull << (page % 64);
+        if (!(word & mask))
+            continue;
+
+        word &= ~mask;
+        m_npending--;
+
+        if (apply) {
+            u64 offset = page << shift;
+            memset(data() + offset, m_poison, min(pgsz, size() - offset));
+        }
+    }
+}
+
+} // namespace vcml
@@ -9,14 +9,81 @@
  ******************************************************************************/
 
 #include "vcml/protocols/tlm_memory.h"
+#include "vcml/logging/logger.h"
 
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
 namespace vcml {
 
+constexpr size_t HUGE_PAGE_SIZE = 2 * MiB;
+
+#ifdef __linux__
+static bool numa_online_nodes(vector<unsigned long>& mask) {
+    ifstream file("/sys/devices/system/node/online");
+    string online;
+    if (!file || !std::getline(file, online))
+        return false;
+
+    const size_t bits = sizeof(unsigned long) * 8;
+    for (const string& part : split(online, ',')) {
+        unsigned int lo = 0, hi = 0;
+        int n = sscanf(part.c_str(), "%u-%u", &lo, &hi);
+        if (n < 1)
+            continue;
+        if (n == 1)
+            hi = lo;
+        for (unsigned int node = lo; node <= hi; node++) {
+            if (mask.size() <= node / bits)
+                mask.resize(node / bits + 1, 0);
+            mask[node / bits] |= 1ul << (node % bits);
+        }
+    }
+
+    return !mask.empty();
+}
+
+static bool numa_bind(void* base, size_t size, int node, bool interleave) {
+    // using the raw syscall avoids a dependency on libnuma
+    const int mpol_bind = 2;
+    const int mpol_interleave = 3;
+    const size_t bits = sizeof(unsigned long) * 8;
+
+    vector<unsigned long> mask;
+    if (interleave) {
+        if (!numa_online_nodes(mask))
+            return false;
+    } else {
+        mask.resize(node / bits + 1, 0);
+        mask[node / bits] |= 1ul << (node % bits);
+    }
+
+    int mode = interleave ? mpol_interleave : mpol_bind;
+    unsigned long maxnode = mask.size() * bits + 1;
+    return syscall(SYS_mbind, base, size, mode, mask.data(), maxnode, 0) == 0;
+}
+#endif
+
+static void prefault_pages(void* base, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(base, size, MADV_POPULATE_WRITE) == 0)
+        return;
+#endif
+
+    // rewrite one byte per page to fault it in without altering contents
+    // that another process may have already stored in shared memory
+    const size_t pgsz = mwr::get_page_size();
+    volatile u8* ptr = (volatile u8*)base;
+    for (size_t off = 0; off < size; off += pgsz)
+        ptr[off] = ptr[off];
+}
+
 int tlm_memory::init_shared(const string& shared, size_t size) {
     VCML_ERROR_ON(is_shared(), "shared memory already initialized");
     m_shared = shared;
@@ -48,7 +115,19 @@ int tlm_memory::init_shared(const string& shared, size_t size) {
 }
 
 tlm_memory::tlm_memory():
-    tlm_dmi(), m_handle(), m_base(), m_size(0), m_discard(false), m_shared() {
+    tlm_dmi(),
+    m_handle(),
+    m_base(),
+    m_size(0),
+    m_discard(false),
+    m_shared(),
+    m_poison(0),
+    m_npending(0),
+    m_pending(),
+    m_hugepages(HUGEPAGES_NONE),
+    m_prefault(false),
+    m_numa_node(-1),
+    m_numa_interleave(false) {
 }
 
 tlm_memory::tlm_memory(size_t size): tlm_memory() {
@@ -73,10 +152,19 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_shared(),
+    m_poison(other.m_poison),
+    m_npending(other.m_npending),
+    m_pending(std::move(other.m_pending)),
+    m_hugepages(other.m_hugepages),
+    m_prefault(other.m_prefault),
+    m_numa_node(other.m_numa_node),
+    m_numa_interleave(other.m_numa_interleave) {
     other.m_handle = nullptr;
     other.m_base = nullptr;
     other.m_size = 0;
+    other.m_npending = 0;
     other.free();
 }
 
@@ -103,8 +191,32 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     else
         flags |= MAP_PRIVATE | MAP_ANON;
 
-    m_base = mmap(0, m_size, perms, flags, fd, 0);
+    m_base = MAP_FAILED;
+
+    // shared memory objects cannot be backed by hugetlbfs, so shared and
+    // failed explicit huge page requests use transparent huge pages instead
+    if (m_hugepages == HUGEPAGES_EXPLICIT) {
+#ifdef MAP_HUGETLB
+        if (!is_shared()) {
+            const size_t mask = HUGE_PAGE_SIZE - 1;
+            size_t hsize = (m_size + mask) & ~mask;
+            m_base = mmap(0, hsize, perms, flags | MAP_HUGETLB, fd, 0);
+            if (m_base != MAP_FAILED)
+                m_size = hsize;
+        }
+#endif
+        if (m_base == MAP_FAILED)
+            m_hugepages = HUGEPAGES_TRANSPARENT;
+    }
+
+    if (m_base == MAP_FAILED)
+        m_base = mmap(0, m_size, perms, flags, fd, 0);
     VCML_ERROR_ON(m_base == MAP_FAILED, "mmap failed: %s", strerror(errno));
+
+    init_policy();
+    if (m_prefault)
+        prefault_pages(m_base, m_size);
+
     u8* ptr = (u8*)(((u64)m_base + extra) & ~extra);
     VCML_ERROR_ON(!is_aligned(ptr, al), "memory alignment failed");
 
@@ -113,9 +225,37 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     set_start_address(0);
     set_end_address(size - 1);
     allow_read_write();
+
+    if (is_shared())
+        register_shared();
+}
+
+void tlm_memory::init_policy() {
+    if (m_hugepages == HUGEPAGES_TRANSPARENT) {
+#ifdef MADV_HUGEPAGE
+        if (madvise(m_base, m_size, MADV_HUGEPAGE))
+            m_hugepages = HUGEPAGES_NONE;
+#else
+        m_hugepages = HUGEPAGES_NONE;
+#endif
+    }
+
+#ifdef __linux__
+    if (m_numa_interleave || m_numa_node >= 0) {
+        if (!numa_bind(m_base, m_size, m_numa_node, m_numa_interleave)) {
+            m_numa_node = -1;
+            m_numa_interleave = false;
+        }
+    }
+#else
+    m_numa_node = -1;
+    m_numa_interleave = false;
+#endif
 }
 
 void tlm_memory::free() {
+    unregister_shared();
+
     if (m_base != nullptr) {
         int ret = munmap(m_base, m_size);
         VCML_ERROR_ON(ret, "munmap failed: %d", ret);
@@ -127,10 +267,79 @@ void tlm_memory::free() {
     m_shared = "";
     m_base = nullptr;
     m_size = 0;
+    m_npending = 0;
+    m_pending.clear();
 
     tlm_dmi::init();
 }
 
+size_t tlm_memory::map_file(const string& path, u64 offset, u64 size) {
+    // shared memories must remain visible to all processes, so we cannot
+    // place a private file mapping on top of them
+    if (is_shared() || data() == nullptr || offset + size > this->size())
+        return 0;
+
+    u8* dest = data() + offset;
+    u64 pgsz = mwr::get_page_size();
+    if ((u64)dest & (pgsz - 1))
+        return 0;
+
+    // only whole pages are mapped, the caller must copy the remaining tail
+    size_t length = size & ~(pgsz - 1);
+    if (length == 0)
+        return 0;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+
+    int perms = PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_FIXED | MAP_NORESERVE;
+    void* addr = mmap(dest, length, perms, flags, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return 0;
+
+    resolve(offset, offset + length - 1, false);
+    return length;
+}
+
+void tlm_memory::release() {
+    if (is_shared()) {
+#ifdef MADV_REMOVE
+        // punches a hole into the shared memory object, so that all
+        // processes observe zeroes without us touching any pages
+        if (madvise(m_base, m_size, MADV_REMOVE) == 0)
+            return;
+#endif
+        memset(m_base, 0, m_size);
+        return;
+    }
+
+    // replacing the mapping drops all resident pages, including those of
+    // mapped image files; new pages read as zero upon their first access
+    int perms = PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_ANON | MAP_FIXED | MAP_NORESERVE;
+    void* addr = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (m_hugepages == HUGEPAGES_EXPLICIT) {
+        addr = mmap(m_base, m_size, perms, flags | MAP_HUGETLB, -1, 0);
+        if (addr == MAP_FAILED) {
+            log_warn("no explicit huge pages left, using transparent ones");
+            m_hugepages = HUGEPAGES_TRANSPARENT;
+        }
+    }
+#endif
+
+    if (addr == MAP_FAILED)
+        addr = mmap(m_base, m_size, perms, flags, -1, 0);
+    VCML_ERROR_ON(addr == MAP_FAILED, "mmap failed: %s", strerror(errno));
+
+    // the new mapping has lost its huge page advice and numa policy
+    init_policy();
+}
+
 tlm_response_status tlm_memory::fill(u8 data, bool debug) {
     if (!is_write_allowed() && !debug)
         return m_discard ? TLM_OK_RESPONSE : TLM_COMMAND_ERROR_RESPONSE;
@@ -147,6 +356,7 @@ tlm_response_status tlm_memory::read(const range& addr, void* dest,
     if (!debug && !is_read_allowed())
         return TLM_COMMAND_ERROR_RESPONSE;
 
+    touch(addr);
     memcpy(dest, data() + addr.start, addr.length());
     return TLM_OK_RESPONSE;
 }
@@ -164,6 +374,7 @@ tlm_response_status tlm_memory::write(const range& addr, const void* src,
             return TLM_COMMAND_ERROR_RESPONSE;
     }
 
+    touch(addr);
     memcpy(data() + addr.start, src, addr.length());
     return TLM_OK_RESPONSE;
 }
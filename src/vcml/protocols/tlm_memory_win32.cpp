@@ -48,7 +48,14 @@ tlm_memory::tlm_memory():
     m_base(nullptr),
     m_size(0),
     m_discard(false),
-    m_shared() {
+    m_shared(),
+    m_poison(0),
+    m_npending(0),
+    m_pending(),
+    m_hugepages(HUGEPAGES_NONE),
+    m_prefault(false),
+    m_numa_node(-1),
+    m_numa_interleave(false) {
 }
 
 tlm_memory::tlm_memory(size_t size): tlm_memory() {
@@ -73,10 +80,19 @@ tlm_memory::tlm_memory(tlm_memory&& other) noexcept:
     m_handle(other.m_handle),
     m_base(other.m_base),
     m_size(other.m_size),
-    m_discard(other.m_discard) {
+    m_discard(other.m_discard),
+    m_shared(),
+    m_poison(other.m_poison),
+    m_npending(other.m_npending),
+    m_pending(std::move(other.m_pending)),
+    m_hugepages(other.m_hugepages),
+    m_prefault(other.m_prefault),
+    m_numa_node(other.m_numa_node),
+    m_numa_interleave(other.m_numa_interleave) {
     other.m_handle = INVALID_HANDLE_VALUE;
     other.m_base = nullptr;
     other.m_size = 0;
+    other.m_npending = 0;
     other.free();
 }
 
@@ -99,6 +115,8 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
         init_shared(shared, m_size);
     }
 
+    init_policy();
+
     u8* ptr = (u8*)(((u64)m_base + extra) & ~extra);
     VCML_ERROR_ON(!is_aligned(ptr, al), "memory alignment failed");
 
@@ -107,9 +125,28 @@ void tlm_memory::init(const string& shared, size_t size, alignment al) {
     set_start_address(0);
     set_end_address(size - 1);
     allow_read_write();
+
+    if (is_shared())
+        register_shared();
+}
+
+void tlm_memory::init_policy() {
+    // large pages need extra privileges and numa binding is not supported
+    // here, so we only prefault if requested
+    m_hugepages = HUGEPAGES_NONE;
+    m_numa_node = -1;
+    m_numa_interleave = false;
+
+    if (m_prefault) {
+        volatile u8* ptr = (volatile u8*)m_base;
+        for (size_t off = 0; off < m_size; off += 4 * KiB)
+            ptr[off] = ptr[off];
+    }
 }
 
 void tlm_memory::free() {
+    unregister_shared();
+
     if (m_handle) {
         if (m_base)
             UnmapViewOfFile(m_base);
@@ -124,10 +161,28 @@ void tlm_memory::free() {
 
     m_shared = "";
     m_size = 0;
+    m_npending = 0;
+    m_pending.clear();
 
     tlm_dmi::init();
 }
 
+size_t tlm_memory::map_file(const string& path, u64 offset, u64 size) {
+    return 0; // not supported, callers fall back to copying
+}
+
+void tlm_memory::release() {
+    if (is_shared()) {
+        memset(m_base, 0, m_size);
+        return;
+    }
+
+    // decommitted pages read as zero once they are touched again
+    VirtualFree(m_base, m_size, MEM_DECOMMIT);
+    void* addr = VirtualAlloc(m_base, m_size, MEM_COMMIT, PAGE_READWRITE);
+    VCML_ERROR_ON(!addr, "VirtualAlloc failed: %u", GetLastError());
+}
+
 tlm_response_status tlm_memory::fill(u8 data, bool debug) {
     if (!is_write_allowed() && !debug)
         return m_discard ? TLM_OK_RESPONSE : TLM_COMMAND_ERROR_RESPONSE;
@@ -144,6 +199,7 @@ tlm_response_status tlm_memory::read(const range& addr, void* dest,
     if (!debug && !is_read_allowed())
         return TLM_COMMAND_ERROR_RESPONSE;
 
+    touch(addr);
     memcpy(dest, data() + addr.start, addr.length());
     return TLM_OK_RESPONSE;
 }
@@ -161,6 +217,7 @@ tlm_response_status tlm_memory::write(const range& addr, const void* src,
             return TLM_COMMAND_ERROR_RESPONSE;
     }
 
+    touch(addr);
     memcpy(data() + addr.start, src, addr.length());
     return TLM_OK_RESPONSE;
 }
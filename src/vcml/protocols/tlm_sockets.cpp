@@ -37,19 +37,22 @@ tlm_initiator_socket::tlm_initiator_socket(const char* nm,
     m_txd(),
     m_sbi(SBI_NONE),
     m_dmi_cache(),
+    m_excl(),
     m_stub(nullptr),
     m_host(hierarchy_search<tlm_host>()),
     m_parent(hierarchy_search<module>()),
     m_adapter(nullptr),
     trace_all(this, "trace", false),
     trace_errors(this, "trace_errors", false),
-    allow_dmi(this, "allow_dmi", true) {
+    allow_dmi(this, "allow_dmi", true),
+    allow_dmi_excl(this, "allow_dmi_excl", false) {
     VCML_ERROR_ON(!m_host, "socket '%s' declared outside tlm_host", nm);
     VCML_ERROR_ON(!m_parent, "socket '%s' declared outside module", nm);
 
     trace_all.inherit_default();
     trace_errors.inherit_default();
     allow_dmi.inherit_default();
+    allow_dmi_excl.inherit_default();
 
     m_host->register_socket(this);
 
@@ -172,27 +175,57 @@ unsigned int tlm_initiator_socket::send(tlm_generic_payload& tx,
 tlm_response_status tlm_initiator_socket::access_dmi(tlm_command cmd, u64 addr,
                                                      void* data,
                                                      unsigned int size,
-                                                     const tlm_sbi& info) {
-    if (info.is_nodmi || info.is_excl)
+                                                     const tlm_sbi& info,
+                                                     unsigned int* nbytes) {
+    if (info.is_nodmi || (info.is_excl && !allow_dmi_excl))
+        return TLM_INCOMPLETE_RESPONSE;
+
+    // exclusive stores must go the same way as their exclusive load
+    bool excl = info.is_excl;
+    if (excl && cmd == TLM_WRITE_COMMAND && !m_excl.is_valid())
         return TLM_INCOMPLETE_RESPONSE;
 
     tlm_dmi dmi;
-    tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
-    if (!dmi_cache().lookup(addr, size, elevate, dmi))
+    if (excl) {
+        range mem(addr, addr + size - 1);
+        if (!dmi_cache().lookup(mem, VCML_ACCESS_READ_WRITE, dmi))
+            return TLM_INCOMPLETE_RESPONSE;
+    } else {
+        tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
+        if (!dmi_cache().lookup(addr, size, elevate, dmi))
+            return TLM_INCOMPLETE_RESPONSE;
+    }
+
+    u8* ptr = dmi_get_ptr(dmi, addr);
+    if (excl && !dmi_exmon::can_access(ptr, size))
         return TLM_INCOMPLETE_RESPONSE;
 
     if (info.is_sync && !info.is_debug)
         m_host->sync();
 
+    unsigned int bytes = size;
     sc_time latency = SC_ZERO_TIME;
     if (cmd == TLM_READ_COMMAND) {
-        memcpy(data, dmi_get_ptr(dmi, addr), size);
+        if (excl)
+            dmi_exmon::load_exclusive(m_excl, ptr, data, size);
+        else
+            memcpy(data, ptr, size);
         latency += dmi.get_read_latency();
     } else if (cmd == TLM_WRITE_COMMAND) {
-        memcpy(dmi_get_ptr(dmi, addr), data, size);
+        if (excl) {
+            if (!dmi_exmon::store_exclusive(m_excl, ptr, data, size))
+                bytes = 0;
+        } else {
+            memcpy(ptr, data, size);
+            if (dmi_exmon::is_active())
+                dmi_exmon::break_reservations(ptr, size);
+        }
         latency += dmi.get_write_latency();
     }
 
+    if (nbytes != nullptr)
+        *nbytes = bytes;
+
     if (!info.is_debug) {
         m_host->local_time() += latency;
         if (info.is_sync)
@@ -212,13 +245,13 @@ tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
 
     // check if we are allowed to do a DMI access on that address
     if (cmd != TLM_IGNORE_COMMAND && allow_dmi) {
-        if (success(access_dmi(cmd, addr, data, size, info))) {
-            if (sz != nullptr)
-                *sz = size;
+        if (success(access_dmi(cmd, addr, data, size, info, sz)))
             return TLM_OK_RESPONSE;
-        }
     }
 
+    if (info.is_excl)
+        dmi_exmon::clear_exclusive(m_excl);
+
     // if DMI was not successful, send a regular transaction
     auto& tx = info.is_debug ? m_txd : allocate_payload();
     tx_setup(tx, cmd, addr, data, size);
@@ -238,6 +271,118 @@ tlm_response_status tlm_initiator_socket::access(tlm_command cmd, u64 addr,
     return rs;
 }
 
+void tlm_initiator_socket::complete_batch(tlm_batch_op* ops, size_t count,
+                                          tlm_response_status rs,
+                                          unsigned int bytes) {
+    for (size_t i = 0; i < count; i++) {
+        ops[i].resp = rs;
+        ops[i].bytes = min(ops[i].size, bytes);
+        bytes -= ops[i].bytes;
+    }
+}
+
+tlm_response_status tlm_initiator_socket::access_batch(tlm_batch_op* ops,
+                                                       size_t count,
+                                                       const tlm_sbi& info) {
+    VCML_ERROR_ON(info.is_excl, "exclusive accesses cannot be batched");
+    if (!info.is_debug && !is_thread())
+        VCML_ERROR("non-debug TLM access outside SC_THREAD forbidden");
+
+    if (!info.is_debug && (info.is_sync || m_host->needs_sync()))
+        m_host->sync();
+
+    // synchronize only once before and after the entire batch
+    tlm_sbi sbi(info);
+    sbi.is_sync = false;
+
+    tlm_response_status result = TLM_OK_RESPONSE;
+    tlm_generic_payload* tx = nullptr;
+    sc_time latency = SC_ZERO_TIME;
+    tlm_dmi dmi;
+    bool has_dmi = false;
+
+    size_t n = 0;
+    for (size_t i = 0; i < count; i = n) {
+        tlm_command cmd = ops[i].cmd;
+        u64 addr = ops[i].addr;
+        u8* data = (u8*)ops[i].data;
+        u64 size = ops[i].size;
+
+        for (n = i + 1; n < count; n++) {
+            if (ops[n].cmd != cmd || ops[n].addr != addr + size ||
+                ops[n].data != data + size || size + ops[n].size > UINT_MAX)
+                break;
+            size += ops[n].size;
+        }
+
+        if (size == 0) {
+            complete_batch(ops + i, n - i, TLM_OK_RESPONSE, 0);
+            continue;
+        }
+
+        // reuse the previous dmi region before consulting the dmi cache
+        if (allow_dmi && !info.is_nodmi && cmd != TLM_IGNORE_COMMAND) {
+            range mem(addr, addr + size - 1);
+            tlm_command elevate = info.is_debug ? TLM_READ_COMMAND : cmd;
+            vcml_access acs = tlm_command_to_access(elevate);
+            if (!has_dmi || !mem.inside(dmi) || !dmi_check_access(dmi, acs))
+                has_dmi = dmi_cache().lookup(mem, acs, dmi);
+
+            if (has_dmi) {
+                u8* ptr = dmi_get_ptr(dmi, addr);
+                if (cmd == TLM_READ_COMMAND) {
+                    memcpy(data, ptr, size);
+                    latency += dmi.get_read_latency();
+                } else {
+                    memcpy(ptr, data, size);
+                    if (dmi_exmon::is_active())
+                        dmi_exmon::break_reservations(ptr, size);
+                    latency += dmi.get_write_latency();
+                }
+
+                complete_batch(ops + i, n - i, TLM_OK_RESPONSE, size);
+                continue;
+            }
+        }
+
+        // transactions must observe the latency of preceding dmi accesses
+        if (!info.is_debug) {
+            m_host->local_time() += latency;
+            latency = SC_ZERO_TIME;
+        }
+
+        if (tx == nullptr)
+            tx = info.is_debug ? &m_txd : &allocate_payload();
+
+        tx_setup(*tx, cmd, addr, data, size);
+        unsigned int bytes = send(*tx, sbi);
+
+        // transport_dbg does not always change response status
+        tlm_response_status rs = tx->get_response_status();
+        if (rs == TLM_INCOMPLETE_RESPONSE && info.is_debug)
+            rs = TLM_OK_RESPONSE;
+
+        if (rs == TLM_INCOMPLETE_RESPONSE)
+            m_parent->log_warn("got incomplete response from 0x%016llx", addr);
+
+        if (failed(rs) && success(result))
+            result = rs;
+
+        complete_batch(ops + i, n - i, rs, bytes);
+
+        // the transaction may have invalidated our dmi region
+        has_dmi = false;
+    }
+
+    if (!info.is_debug) {
+        m_host->local_time() += latency;
+        if (info.is_sync || m_host->needs_sync())
+            m_host->sync();
+    }
+
+    return result;
+}
+
 void tlm_initiator_socket::stub(tlm_response_status r) {
     VCML_ERROR_ON(m_stub, "socket %s already stubbed", name());
     auto guard = get_hierarchy_scope();
@@ -271,6 +416,11 @@ void tlm_target_socket::b_transport(tlm_generic_payload& tx, sc_time& dt) {
 
     tlm_dmi dmi;
     if (allow_dmi && m_dmi_cache && m_dmi_cache->lookup(tx, dmi)) {
+        if (tx.is_write() && dmi_exmon::is_active()) {
+            u8* ptr = dmi_get_ptr(dmi, tx.get_address());
+            dmi_exmon::break_reservations(ptr, tx_size(tx));
+        }
+
         if (tx_is_excl(tx) && tx.is_read()) {
             u64 lo = tx.get_address();
             u64 hi = lo + tx_size(tx) - 1;
@@ -54,7 +54,26 @@ unordered_map<string, input*>& input::all_inputs() {
     return inputs;
 }
 
-input::input(const string& name): m_name(name), m_mutex(), m_events() {
+bool input::fetch_replay(input_event* ev) const {
+    // replayed events are delivered once the guest polls for them at or
+    // after the simulation time they were originally consumed at
+    u64 stamp;
+    if (!m_replay.peek(stamp) || stamp > sc_time_stamp().value())
+        return false;
+
+    if (ev == nullptr)
+        return true;
+
+    vector<u8> data;
+    m_replay.fetch(stamp, data);
+    VCML_ERROR_ON(data.size() != sizeof(*ev), "%s: invalid replay event",
+                  input_name());
+    memcpy(ev, data.data(), sizeof(*ev));
+    return true;
+}
+
+input::input(const string& name):
+    m_name(name), m_mutex(), m_events(), m_replay(name) {
     VCML_ERROR_ON(find(name), "input '%s' already exists", name.c_str());
     all_inputs()[name] = this;
 }
@@ -65,32 +84,41 @@ input::~input() {
 
 bool input::has_events() const {
     lock_guard<mutex> lock(m_mutex);
+    if (m_replay.is_replaying())
+        return fetch_replay(nullptr);
     return !m_events.empty();
 }
 
 bool input::pop_event(input_event& ev) {
     lock_guard<mutex> lock(m_mutex);
+    if (m_replay.is_replaying())
+        return fetch_replay(&ev);
+
     if (m_events.empty())
         return false;
 
     ev = m_events.front();
     m_events.pop();
+    m_replay.record(&ev, sizeof(ev));
     return true;
 }
 
 void input::notify_key(u32 symbol, bool down) {
     lock_guard<mutex> lock(m_mutex);
-    handle_key(symbol, down);
+    if (!m_replay.is_replaying())
+        handle_key(symbol, down);
 }
 
 void input::notify_btn(u32 button, bool down) {
     lock_guard<mutex> lock(m_mutex);
-    handle_btn(button, down);
+    if (!m_replay.is_replaying())
+        handle_btn(button, down);
 }
 
 void input::notify_pos(u32 x, u32 y) {
     lock_guard<mutex> lock(m_mutex);
-    handle_pos(x, y);
+    if (!m_replay.is_replaying())
+        handle_pos(x, y);
 }
 
 void keyboard::handle_key(u32 sym, bool down) {
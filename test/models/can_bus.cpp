@@ -0,0 +1,128 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+static can_frame make_frame(u32 msgid, size_t len, u8 flags = 0) {
+    can_frame frame{};
+    frame.msgid = msgid;
+    frame.dlc = len2dlc(len);
+    frame.flags = flags;
+    return frame;
+}
+
+class can_bus_bench : public test_base, public can_host
+{
+public:
+    struct delivery {
+        size_t node;
+        u32 id;
+        sc_time time;
+    };
+
+    vector<delivery> received;
+
+    can::bus bus;
+
+    can_initiator_array can_tx;
+    can_target_array can_rx;
+
+    can_bus_bench(const sc_module_name& nm):
+        test_base(nm),
+        can_host(),
+        received(),
+        bus("bus"),
+        can_tx("can_tx"),
+        can_rx("can_rx") {
+        bus.timed = true;
+        bus.bitrate = 500000;
+        bus.data_bitrate = 2000000;
+        for (size_t i = 0; i < 4; i++)
+            bus.bind(can_tx[i], can_rx[i]);
+    }
+
+    virtual void can_receive(const can_target_socket& socket,
+                             can_frame& frame) override {
+        received.push_back({ can_rx.index_of(socket), frame.msgid,
+                             sc_time_stamp() });
+    }
+
+    void test_duration() {
+        size_t data_bits = 0;
+        can_frame classic = make_frame(0x123, 8);
+        EXPECT_EQ(bus.frame_bits(classic, data_bits), 111u);
+        EXPECT_EQ(data_bits, 0u);
+        EXPECT_EQ(bus.frame_duration(classic), sc_time(222, SC_US));
+
+        can_frame fd = make_frame(0x123, 64, CANFD_FDF | CANFD_BRS);
+        EXPECT_EQ(bus.frame_bits(fd, data_bits), 29u);
+        EXPECT_EQ(data_bits, 543u);
+        EXPECT_EQ(bus.frame_duration(fd), sc_time(329.5, SC_US));
+    }
+
+    void test_arbitration_key() {
+        can_frame std_data = make_frame(0x100, 1u);
+        can_frame std_rtr = make_frame(0x100 | CAN_RTR, 0u);
+        can_frame ext_data = make_frame((0x100 << 18) | CAN_EFF, 1u);
+        can_frame lower = make_frame(0x0ff, 1u);
+
+        u32 k0 = can::bus::arbitration_key(std_data);
+        u32 k1 = can::bus::arbitration_key(std_rtr);
+        u32 k2 = can::bus::arbitration_key(ext_data);
+        u32 k3 = can::bus::arbitration_key(lower);
+
+        EXPECT_LT(k0, k1) << "data frames must win over remote frames";
+        EXPECT_LT(k1, k2) << "standard frames must win over extended ones";
+        EXPECT_LT(k3, k0) << "lower identifiers must win";
+    }
+
+    void test_arbitration() {
+        sc_time start = sc_time_stamp();
+        sc_time frame = sc_time(222, SC_US);
+
+        can_frame a = make_frame(0x200, 8u);
+        can_frame b = make_frame(0x100, 8u);
+        can_frame c = make_frame(0x300, 8u);
+        can_tx[0].send(a);
+        can_tx[1].send(b);
+        can_tx[2].send(c);
+        EXPECT_TRUE(received.empty()) << "frames delivered without delay";
+
+        wait(3 * frame);
+        wait(SC_ZERO_TIME);
+
+        ASSERT_EQ(received.size(), 9u);
+        for (size_t i = 0; i < 9; i++) {
+            u32 expect = i < 3 ? 0x100 : i < 6 ? 0x200 : 0x300;
+            EXPECT_EQ(received[i].id, expect) << "wrong order at " << i;
+            EXPECT_EQ(received[i].time, start + (double)(i / 3 + 1) * frame);
+        }
+
+        EXPECT_EQ(bus.stats(0).arb_lost, 1u);
+        EXPECT_EQ(bus.stats(1).arb_lost, 0u);
+        EXPECT_EQ(bus.stats(2).arb_lost, 2u);
+        EXPECT_EQ(bus.stats(3).rx_frames, 3u);
+        EXPECT_EQ(bus.stats(1).tx_bits, 111u);
+        EXPECT_EQ(bus.busy_time(), 3 * frame);
+        EXPECT_GT(bus.bus_load(), 0.0);
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+        test_duration();
+        test_arbitration_key();
+        test_arbitration();
+    }
+};
+
+TEST(can, bus) {
+    can_bus_bench bench("bench");
+    sc_core::sc_start();
+}
@@ -11,6 +11,10 @@
 #include "testing.h"
 
 enum lan9118_addr : u64 {
+    RX_DATA_FIFO = 0x00,
+    TX_DATA_FIFO = 0x20,
+    RX_STATUS_FIFO = 0x40,
+    TX_STATUS_FIFO = 0x48,
     CSR_ID_REV = 0x50,
     CSR_IRQ_CFG = 0x54,
     CSR_IRQ_STS = 0x58,
@@ -106,6 +110,53 @@ public:
         mac_write(MAC_MII_ACC, cmd);
     }
 
+    tlm_response_status stream(tlm_command cmd, u64 addr, void* data,
+                               unsigned int size) {
+        tlm_generic_payload tx;
+        tx_setup(tx, cmd, addr, data, size);
+        tx.set_streaming_width(4);
+        out.send(tx);
+        return tx.get_response_status();
+    }
+
+    void test_loopback(size_t npkts) {
+        mac_write(MAC_CR, 1u << 3 | 1u << 2); // TXEN | RXEN
+        phy_write(PHY_CR, 1u << 14);          // loopback
+        EXPECT_OK(out.writew(CSR_TX_CFG, 1u << 1)) << "cannot enable TX";
+
+        const u32 len = 128;
+        vector<u8> pkt(len), rcv(len + 4);
+        std::fill(pkt.begin(), pkt.begin() + 6, 0xff); // broadcast
+
+        for (size_t i = 0; i < npkts; i++) {
+            for (u32 j = 6; j < len; j++)
+                pkt[j] = (u8)(i + j);
+
+            u32 cmda = 1u << 13 | 1u << 12 | len; // FIRST | LAST
+            u32 cmdb = (u32)i << 16 | len;
+            ASSERT_OK(out.writew(TX_DATA_FIFO, cmda));
+            ASSERT_OK(out.writew(TX_DATA_FIFO, cmdb));
+            ASSERT_OK(stream(TLM_WRITE_COMMAND, TX_DATA_FIFO, pkt.data(), len));
+
+            wait(SC_ZERO_TIME);
+
+            u32 status = 0;
+            ASSERT_OK(out.readw(TX_STATUS_FIFO, status));
+            EXPECT_EQ(status >> 16, (u32)i & 0xffff) << "wrong packet tag";
+            ASSERT_OK(out.readw(RX_STATUS_FIFO, status));
+            ASSERT_EQ((status >> 16) & 0x3fff, len + 4) << "wrong length";
+
+            ASSERT_OK(stream(TLM_READ_COMMAND, RX_DATA_FIFO, rcv.data(),
+                             rcv.size()));
+            ASSERT_TRUE(std::equal(pkt.begin(), pkt.end(), rcv.begin()))
+                << "loopback data mismatch in packet " << i;
+        }
+
+        u32 data = 0;
+        EXPECT_OK(out.readw(CSR_RX_FIFO_INF, data));
+        EXPECT_EQ(data, 0u) << "RX FIFOs not drained";
+    }
+
     virtual void run_test() override {
         // test that interrupts are reset
         wait(SC_ZERO_TIME);
@@ -167,6 +218,10 @@ public:
         EXPECT_TRUE(irq.read()) << "interrupt did not get raised";
         check_irq(31);
         EXPECT_FALSE(irq.read()) << "interrupts did not get cleared";
+
+        // check burst access to data FIFOs via PHY loopback
+        EXPECT_OK(out.writew(CSR_IRQ_CFG, 0)) << "cannot disable IRQs";
+        test_loopback(4);
     }
 };
 
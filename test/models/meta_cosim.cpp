@@ -0,0 +1,158 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+// enough transactions to wrap around the ring buffers a couple of times
+const size_t NUM_ROUNDTRIPS = 100;
+
+// memory latency on the target side, 10 and 20 cycles at 100MHz
+const sc_time READ_LATENCY(100, SC_NS);
+const sc_time WRITE_LATENCY(200, SC_NS);
+
+// generous upper bound for the average host round trip time
+const u64 MAX_ROUNDTRIP_US = 1000;
+
+// runs in the child process and issues transactions towards the parent
+class cosim_initiator : public test_base
+{
+public:
+    meta::cosim cosim;
+    tlm_initiator_socket out;
+    gpio_initiator_socket irq;
+
+    cosim_initiator(const sc_module_name& nm):
+        test_base(nm), cosim("cosim"), out("out"), irq("irq") {
+        clk_bind(*this, "clk", cosim, "clk");
+        gpio_bind(*this, "rst", cosim, "rst");
+        out.bind(cosim.in);
+        irq.bind(cosim.gpio_in[0]);
+        cosim.out.stub();
+        cosim.eth_tx.stub();
+        cosim.eth_rx.stub();
+        cosim.can_tx.stub();
+        cosim.can_rx.stub();
+    }
+
+    virtual void run_test() override {
+        u32 data = 0;
+        EXPECT_OK(out.writew<u32>(0x10, 0x11223344, SBI_NODMI));
+        EXPECT_OK(out.readw<u32>(0x10, data, SBI_NODMI));
+        EXPECT_EQ(data, 0x11223344);
+        EXPECT_AE(out.readw<u32>(0x10000, data, SBI_NODMI));
+
+        u8 buffer[256];
+        for (size_t i = 0; i < sizeof(buffer); i++)
+            buffer[i] = (u8)i;
+        EXPECT_OK(out.write(0x100, buffer, sizeof(buffer), SBI_NODMI));
+        memset(buffer, 0, sizeof(buffer));
+        EXPECT_OK(out.read(0x100, buffer, sizeof(buffer), SBI_DEBUG));
+        for (size_t i = 0; i < sizeof(buffer); i++)
+            EXPECT_EQ(buffer[i], (u8)i);
+
+        u8* ptr = out.lookup_dmi_ptr(0x0, 0x1000, VCML_ACCESS_READ_WRITE);
+        ASSERT_NE(ptr, nullptr) << "shared memory not exported via DMI";
+        EXPECT_EQ(ptr[0x10], 0x44);
+        ptr[0x20] = 0xab;
+        EXPECT_OK(out.readw<u32>(0x20, data, SBI_NODMI));
+        EXPECT_EQ(data, 0xab);
+
+        for (u32 i = 0; i < NUM_ROUNDTRIPS; i++) {
+            memcpy(buffer, &i, sizeof(i));
+            EXPECT_OK(out.write(0x100, buffer, sizeof(buffer), SBI_NODMI));
+            EXPECT_OK(out.readw<u32>(0x100, data, SBI_NODMI));
+            EXPECT_EQ(data, i);
+        }
+
+        // the latency annotated by the remote memory must arrive here, while
+        // the host round trip stays well below the peer timeout
+        sc_time start = local_time_stamp();
+        u64 host = mwr::timestamp_us();
+        for (u32 i = 0; i < NUM_ROUNDTRIPS; i++) {
+            EXPECT_OK(out.writew<u32>(0x100, i, SBI_NODMI));
+            EXPECT_OK(out.readw<u32>(0x100, data, SBI_NODMI));
+        }
+
+        host = mwr::timestamp_us() - host;
+        sc_time latency = local_time_stamp() - start;
+        EXPECT_EQ(latency, (READ_LATENCY + WRITE_LATENCY) * NUM_ROUNDTRIPS);
+        EXPECT_LT(host / (2 * NUM_ROUNDTRIPS), MAX_ROUNDTRIP_US);
+
+        irq = true;
+        wait(10, SC_US);
+    }
+};
+
+// runs in the parent process and hosts the shared memory
+class cosim_target : public test_base
+{
+public:
+    meta::cosim cosim;
+    generic::memory mem;
+    gpio_target_socket irq;
+
+    cosim_target(const sc_module_name& nm):
+        test_base(nm), cosim("cosim"), mem("mem", 0x1000), irq("irq") {
+        clk_bind(*this, "clk", cosim, "clk");
+        clk_bind(*this, "clk", mem, "clk");
+        gpio_bind(*this, "rst", cosim, "rst");
+        gpio_bind(*this, "rst", mem, "rst");
+        cosim.out.bind(mem.in);
+        cosim.gpio_out[0].bind(irq);
+        cosim.in.stub();
+        cosim.eth_tx.stub();
+        cosim.eth_rx.stub();
+        cosim.can_tx.stub();
+        cosim.can_rx.stub();
+    }
+
+    virtual void run_test() override {
+        while (!cosim.peer_finished())
+            wait(1, SC_US);
+
+        // allow the sync thread to drain the remaining messages
+        wait(10, SC_US);
+
+        EXPECT_TRUE(irq.read());
+        EXPECT_EQ(mem[0x10], 0x44);
+        EXPECT_EQ(mem[0x20], 0xab);
+    }
+};
+
+TEST(meta_cosim, two_processes) {
+    string channel = mkstr("/vcml-cosim-test-%d", (int)getpid());
+    vcml::broker broker("test");
+    broker.define("test.cosim.channel", channel);
+    broker.define("test.cosim.ring_size", 4 * KiB);
+    broker.define("test.mem.shared", channel + "-mem");
+    broker.define("test.mem.read_latency", 10);
+    broker.define("test.mem.write_latency", 20);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0) << "fork failed: " << strerror(errno);
+    if (pid == 0) {
+        {
+            cosim_initiator test("test");
+            sc_core::sc_start();
+        }
+        _exit(HasFailure() ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+    cosim_target test("test");
+    sc_core::sc_start();
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class throttle_test : public test_base
+{
+public:
+    meta::throttle throttle;
+
+    throttle_test(const sc_module_name& nm):
+        test_base(nm), throttle("throttle") {
+        throttle.precise = true;
+        throttle.rtf = 1.0;
+        throttle.update_interval = sc_time(100.0, SC_US);
+    }
+
+    virtual void run_test() override {
+        wait(SC_ZERO_TIME);
+
+        u64 start = mwr::timestamp_us();
+        for (int i = 0; i < 500; i++)
+            wait(100.0, SC_US);
+        u64 elapsed = mwr::timestamp_us() - start;
+
+        // 50ms of simulation must not pass noticeably quicker on the host;
+        // there is no upper bound, since that depends on host load
+        EXPECT_GE(elapsed, 45000u);
+
+        const meta::throttle::stats& stats = throttle.get_stats();
+        EXPECT_GT(stats.intervals, 400u);
+        EXPECT_GT(stats.throttled, 0u);
+        EXPECT_GT(stats.total_sleep, SC_ZERO_TIME);
+        EXPECT_LE(stats.rtf_avg, 1.01);
+
+        // lag dropped on running out of burst credit remains in the total
+        if (stats.credit_drops == 0)
+            EXPECT_EQ(stats.total_drift, stats.drift);
+        else
+            EXPECT_GT(stats.total_drift, stats.drift);
+    }
+};
+
+TEST(throttle, precise) {
+    throttle_test test("test");
+    sc_core::sc_start();
+}
@@ -101,6 +101,41 @@ public:
         ASSERT_TRUE(irq_mtimer1.read()) << "IRQ_TIMER_1 not triggered";
     }
 
+    void test_polling() {
+        // poll mtime ahead of simulation time: reads must follow the local
+        // time without syncing until the next timer interrupt is due
+        const u64 n = 1000;
+        sc_time quantum = tlm_global_quantum::instance().get();
+        tlm_global_quantum::instance().set(clock_cycles(10 * n));
+
+        u64 start, mtime;
+        ASSERT_OK(out_mtimer.readw(0x7ff8, start)) << "cannot read mtime";
+        ASSERT_OK(out_mtimer.writew(0, start + n)) << "cannot write mtimecmp0";
+        wait(SC_ZERO_TIME);
+        ASSERT_FALSE(irq_mtimer0.read()) << "IRQ_TIMER_0 not cleared";
+
+        sc_time now = sc_time_stamp();
+        for (u64 i = 1; i < n; i++) {
+            local_time() += clock_cycle();
+            ASSERT_OK(out_mtimer.readw(0x7ff8, mtime)) << "cannot read mtime";
+            ASSERT_EQ(mtime, start + i) << "mtime does not follow local time";
+        }
+
+        ASSERT_EQ(sc_time_stamp(), now) << "polling mtime caused syncs";
+        ASSERT_FALSE(irq_mtimer0.read()) << "IRQ_TIMER_0 triggered early";
+
+        // reading beyond mtimecmp0 must sync to make the interrupt visible
+        local_time() += clock_cycle();
+        ASSERT_OK(out_mtimer.readw(0x7ff8, mtime)) << "cannot read mtime";
+        ASSERT_EQ(mtime, start + n) << "mtime does not follow local time";
+        ASSERT_EQ(sc_time_stamp(), now + clock_cycles(n)) << "no sync";
+        wait(SC_ZERO_TIME);
+        ASSERT_TRUE(irq_mtimer0.read()) << "IRQ_TIMER_0 not triggered";
+
+        ASSERT_OK(out_mtimer.writew(0, ~0ul)) << "cannot write mtimecmp0";
+        tlm_global_quantum::instance().set(quantum);
+    }
+
     void test_swi(tlm_initiator_socket& out, gpio_target_socket& irq0,
                   gpio_target_socket& irq1) {
         // test software generated interrupts
@@ -127,6 +162,9 @@ public:
         test_timer();
         wait(SC_ZERO_TIME);
 
+        test_polling();
+        wait(SC_ZERO_TIME);
+
         test_swi(out_mswi, irq_msw0, irq_msw1);
         wait(SC_ZERO_TIME);
 
@@ -0,0 +1,93 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class async_domain_test : public test_base
+{
+public:
+    atomic<int> active;
+    atomic<int> overlaps;
+    atomic<int> done;
+
+    atomic<u64> ticks;
+    atomic<int> races;
+
+    async_domain_test(const sc_module_name& nm):
+        test_base(nm),
+        active(0),
+        overlaps(0),
+        done(0),
+        ticks(0),
+        races(0) {
+        SC_HAS_PROCESS(async_domain_test);
+        SC_THREAD(thread_a);
+        SC_THREAD(thread_b);
+        SC_THREAD(thread_c);
+    }
+
+    void work() {
+        for (int i = 0; i < 10; i++) {
+            if (active++ > 0)
+                overlaps++;
+            mwr::usleep(100);
+            active--;
+
+            sc_release_domain();
+            sc_progress(sc_time(1, SC_MS));
+            sc_acquire_domain();
+        }
+    }
+
+    void thread_a() {
+        sc_async([&]() -> void { work(); }, -1, "domain");
+        done++;
+    }
+
+    void thread_b() {
+        sc_async([&]() -> void { work(); }, -1, "domain");
+        done++;
+    }
+
+    void thread_c() {
+        sc_async(
+            [&]() -> void {
+                for (int i = 0; i < 10; i++) {
+                    // SystemC must not advance while we hold our slice
+                    u64 before = ticks;
+                    mwr::usleep(100);
+                    if (ticks != before)
+                        races++;
+
+                    sc_release_domain();
+                    sc_progress(sc_time(1, SC_MS));
+                    sc_acquire_domain();
+                }
+            },
+            -1, "", true);
+        done++;
+    }
+
+    virtual void run_test() override {
+        while (done < 3) {
+            wait(100, SC_US);
+            ticks++;
+        }
+
+        EXPECT_EQ(overlaps, 0);
+        EXPECT_EQ(races, 0);
+        EXPECT_GE(sc_time_stamp(), sc_time(10, SC_MS));
+    }
+};
+
+TEST(async_domain, run) {
+    async_domain_test test("domain");
+    sc_core::sc_start();
+}
@@ -0,0 +1,122 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace ::testing;
+
+#include "vcml.h"
+
+template <typename... ARGS>
+static std::string render(const char* format, const ARGS&... args) {
+    std::vector<vcml::u8> buffer;
+    (vcml::binlog_encode(buffer, args), ...);
+    return vcml::binlog_render(format, buffer.data(), buffer.size());
+}
+
+TEST(binlog, render) {
+    EXPECT_EQ(render("no arguments"), "no arguments");
+    EXPECT_EQ(render("100%%"), "100%");
+    EXPECT_EQ(render("%d %i", -42, 7), "-42 7");
+    EXPECT_EQ(render("%u %lu %llu", 1u, 2ul, 3ull), "1 2 3");
+    EXPECT_EQ(render("0x%08x", 0xabcu), "0x00000abc");
+    EXPECT_EQ(render("0x%016llx", 0x1122334455667788ull),
+              "0x1122334455667788");
+    EXPECT_EQ(render("%zu bytes", (size_t)64), "64 bytes");
+    EXPECT_EQ(render("%hhu", (unsigned char)200), "200");
+    EXPECT_EQ(render("%c%c", 'o', 'k'), "ok");
+    EXPECT_EQ(render("%.2f", 3.14159), "3.14");
+    EXPECT_EQ(render("%s=%s", "key", "value"), "key=value");
+    EXPECT_EQ(render("[%-5s]", "ab"), "[ab   ]");
+    EXPECT_EQ(render("[%*d]", 4, 9), "[   9]");
+    EXPECT_EQ(render("%s", (const char*)nullptr), "(null)");
+    EXPECT_EQ(render("%d %d", 1), "1 <?>");
+}
+
+TEST(binlog, widths) {
+    EXPECT_EQ(render("%x", -1), "ffffffff");
+    EXPECT_EQ(render("%u", (short)-1), "4294967295");
+    EXPECT_EQ(render("%d", 0xffffffffu), "-1");
+    EXPECT_EQ(render("%llx", -1ll), "ffffffffffffffff");
+    EXPECT_EQ(render("%hhx", 0x1234), "34");
+    EXPECT_EQ(render("%hd", 70000), "4464");
+    EXPECT_EQ(render("%hhd", (unsigned char)200), "-56");
+    EXPECT_EQ(render("%d", (unsigned char)200), "200");
+    EXPECT_EQ(render("%d", true), "1");
+}
+
+TEST(binlog, strings) {
+    std::string temp = "temporary";
+    std::vector<vcml::u8> buffer;
+    vcml::binlog_encode(buffer, temp.c_str());
+    temp = "overwritten";
+    EXPECT_EQ(vcml::binlog_render("%s", buffer.data(), buffer.size()),
+              "temporary");
+
+    std::string huge(2 * vcml::BINLOG_MAX_STRLEN, 'x');
+    std::string msg = render("%s", huge.c_str());
+    EXPECT_EQ(msg.length(), vcml::BINLOG_MAX_STRLEN);
+}
+
+MATCHER_P(match_level, level, "matches level of log message") {
+    return !arg.lines.empty() && arg.level == level;
+}
+
+MATCHER_P(match_text, text, "matches log message text") {
+    return !arg.lines.empty() && arg.lines[0] == text;
+}
+
+class mock_publisher : public mwr::publisher
+{
+public:
+    mock_publisher(): mwr::publisher(vcml::LOG_ERROR, vcml::LOG_DEBUG) {}
+    MOCK_METHOD(void, publish, (const mwr::logmsg&), (override));
+};
+
+static int g_evaluated = 0;
+
+static int evaluate() {
+    return ++g_evaluated;
+}
+
+TEST(binlog, component) {
+    mock_publisher publisher;
+    vcml::component comp("mock");
+    comp.loglvl = vcml::LOG_INFO;
+
+    vcml::binlog_enable();
+
+    comp.log_debug("filtered %d", evaluate());
+    EXPECT_EQ(g_evaluated, 0);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(publisher, publish(match_text("message 1"))).Times(1);
+        EXPECT_CALL(publisher, publish(match_text("message 2"))).Times(1);
+        EXPECT_CALL(publisher, publish(match_text("warning 3"))).Times(1);
+    }
+
+    comp.log_info("message %d", 1);
+    comp.log_info("message %s", "2");
+    comp.log_warn("warning %d", 3);
+
+    vcml::binlog_flush();
+    Mock::VerifyAndClearExpectations(&publisher);
+
+    // more messages than fit into the ring at once
+    const int n = 10000;
+    EXPECT_CALL(publisher, publish(match_level(vcml::LOG_INFO))).Times(n);
+    for (int i = 0; i < n; i++)
+        comp.log_info("message %d of %d", i, n);
+
+    vcml::binlog_enable(false);
+    EXPECT_FALSE(vcml::binlog_enabled());
+}
@@ -39,3 +39,107 @@ TEST(broker, file) {
     EXPECT_DEF(broker, "loop.iter2", "2");
     EXPECT_UDF(broker, "loop.iter3");
 }
+
+TEST(broker, wildcards) {
+    broker low("low");
+    low.define("system.cpu0.async", "false");
+    low.define("system.**.trace", "true");
+    low.define("system.cpu?.rate", "1");
+    low.define("system.cpu*.rate", "2");
+    low.define("system.cpu*.name", "cpu");
+
+    broker high("high", true);
+    high.define("system.cpu*.async", "true");
+
+    string s;
+    EXPECT_EQ(broker::init("system.cpu0.async", s), &high);
+    EXPECT_EQ(s, "true");
+    EXPECT_EQ(broker::init("system.cpu1.trace", s), &low);
+    EXPECT_EQ(s, "true");
+    EXPECT_EQ(broker::init("system.trace", s), &low);
+    EXPECT_EQ(broker::init("system.bus.port0.trace", s), &low);
+    EXPECT_EQ(broker::init("system.cpu7.rate", s), &low);
+    EXPECT_EQ(s, "1");
+    EXPECT_EQ(broker::init("system.cpu12.rate", s), &low);
+    EXPECT_EQ(s, "2");
+    EXPECT_EQ(broker::init("system.cpu.x.async", s), nullptr);
+    EXPECT_EQ(broker::init("other.cpu0.async", s), nullptr);
+
+    EXPECT_DEF(low, "system.cpu0.async", "false");
+    EXPECT_UDF(low, "system.cpu1.async");
+
+    high.undefine("system.cpu*.async");
+    EXPECT_EQ(broker::init("system.cpu0.async", s), &low);
+    EXPECT_EQ(s, "false");
+
+    auto unused = broker::collect_unused();
+    auto is_unused = [&](const string& key) -> bool {
+        return std::any_of(unused.begin(), unused.end(),
+                           [&](auto& entry) { return entry.first == key; });
+    };
+
+    EXPECT_FALSE(is_unused("system.cpu*.rate"));
+    EXPECT_FALSE(is_unused("system.**.trace"));
+    EXPECT_TRUE(is_unused("system.cpu*.name"));
+}
+
+TEST(broker, expand) {
+    broker b("expand");
+    b.define("var", "abc");
+    b.define("key0", "${var}");
+    EXPECT_DEF(b, "key0", "abc");
+    b.define("var", "def");
+    b.define("key1", "${var}");
+    EXPECT_DEF(b, "key1", "def");
+}
+
+TEST(broker, index) {
+    broker cfg("cfg");
+    for (size_t i = 0; i < 1000; i += 10)
+        cfg.define(mkstr("system.periph%zu.reg0", i), i);
+    cfg.define("system.periph*.reg1", "glob");
+    cfg.define("system.periph5.reg1", "exact");
+    cfg.define("system.periph1?.reg2", "single");
+    cfg.define("system.**.reg3", "deep");
+
+    // exact keys take precedence over rules, rules only match their level
+    for (size_t i = 0; i < 1000; i++) {
+        for (size_t reg = 0; reg < 4; reg++) {
+            string expect;
+            switch (reg) {
+            case 0:
+                expect = i % 10 ? "" : mkstr("%zu", i);
+                break;
+            case 1:
+                expect = i == 5 ? "exact" : "glob";
+                break;
+            case 2:
+                expect = i >= 10 && i < 20 ? "single" : "";
+                break;
+            default:
+                expect = "deep";
+                break;
+            }
+
+            string val;
+            string name = mkstr("system.periph%zu.reg%zu", i, reg);
+            broker* found = broker::init(name, val);
+            if (expect.empty()) {
+                EXPECT_EQ(found, nullptr) << name;
+            } else {
+                EXPECT_EQ(found, &cfg) << name;
+                EXPECT_EQ(val, expect) << name;
+            }
+        }
+    }
+
+    string val;
+    EXPECT_EQ(broker::init("system.periph3.sub.reg1", val), nullptr);
+    EXPECT_EQ(broker::init("system.periph3.sub.reg3", val), &cfg);
+    EXPECT_EQ(val, "deep");
+
+    // removing an exact key makes the rule visible again
+    cfg.undefine("system.periph5.reg1");
+    EXPECT_EQ(broker::init("system.periph5.reg1", val), &cfg);
+    EXPECT_EQ(val, "glob");
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+using namespace ::vcml::debugging;
+
+class bbtarget : public target
+{
+protected:
+    virtual bool start_basic_block_trace() override { return true; }
+    virtual bool stop_basic_block_trace() override { return true; }
+
+public:
+    bbtarget(const string& name): target(name) {}
+    using target::notify_basic_block;
+};
+
+class bbsubscriber : public subscriber
+{
+public:
+    size_t batches = 0;
+    vector<basic_block> blocks;
+
+    virtual void notify_basic_block(target& tgt, u64 pc, size_t blksz,
+                                    size_t icount) override {
+        blocks.push_back({ pc, (u32)blksz, (u32)icount });
+    }
+
+    virtual void notify_basic_blocks(target& tgt, const basic_block* b,
+                                     size_t count) override {
+        batches++;
+        subscriber::notify_basic_blocks(tgt, b, count);
+    }
+};
+
+TEST(coverage, batching) {
+    bbtarget tgt("bbtarget_batching");
+    bbsubscriber subscr;
+    ASSERT_TRUE(tgt.trace_basic_blocks(&subscr));
+    EXPECT_TRUE(tgt.is_tracing_basic_blocks());
+
+    tgt.notify_basic_block(0x100, 8, 2);
+    EXPECT_EQ(subscr.blocks.size(), 1u);
+    EXPECT_EQ(subscr.batches, 0u);
+
+    tgt.set_basic_block_batch(4);
+    for (u64 i = 0; i < 6; i++)
+        tgt.notify_basic_block(0x200 + i * 0x10, 16, 4);
+    EXPECT_EQ(subscr.batches, 1u);
+    EXPECT_EQ(subscr.blocks.size(), 5u);
+
+    tgt.flush_basic_blocks();
+    EXPECT_EQ(subscr.batches, 2u);
+    ASSERT_EQ(subscr.blocks.size(), 7u);
+    EXPECT_EQ(subscr.blocks[6].pc, 0x250u);
+    EXPECT_EQ(subscr.blocks[6].size, 16u);
+    EXPECT_EQ(subscr.blocks[6].icount, 4u);
+
+    tgt.flush_basic_blocks();
+    EXPECT_EQ(subscr.batches, 2u);
+
+    EXPECT_TRUE(tgt.untrace_basic_blocks(&subscr));
+    EXPECT_FALSE(tgt.is_tracing_basic_blocks());
+}
+
+TEST(coverage, bitmap) {
+    bbtarget tgt("bbtarget_bitmap");
+    tgt.set_basic_block_batch(16);
+
+    coverage cov(tgt, 64 * KiB);
+    EXPECT_TRUE(tgt.is_tracing_basic_blocks());
+    EXPECT_FALSE(cov.is_shared());
+    EXPECT_EQ(cov.size(), 64 * KiB);
+    EXPECT_EQ(cov.count(), 0u);
+
+    // loop 0x1000 -> 0x1040 -> 0x1000 ... covers three distinct edges, the
+    // 256 iterations make the counters wrap, which must skip over zero
+    for (int i = 0; i < 256; i++) {
+        tgt.notify_basic_block(0x1000, 0x40, 16);
+        tgt.notify_basic_block(0x1040, 0x20, 8);
+    }
+
+    tgt.flush_basic_blocks();
+    EXPECT_EQ(cov.count(), 3u);
+
+    cov.reset();
+    EXPECT_EQ(cov.count(), 0u);
+
+    tgt.notify_basic_block(0x1000, 0x40, 16);
+    tgt.flush_basic_blocks();
+    EXPECT_EQ(cov.count(), 1u);
+}
+
+TEST(coverage, shared) {
+    bbtarget tgt("bbtarget_shared");
+    coverage cov(tgt, 4 * KiB, "/vcml-test-coverage");
+    EXPECT_TRUE(cov.is_shared());
+    EXPECT_STREQ(cov.shared_name(), "/vcml-test-coverage");
+
+    tgt.notify_basic_block(0x2000, 4, 1);
+    tgt.notify_basic_block(0x2004, 4, 1);
+    EXPECT_EQ(cov.count(), 2u);
+
+    cov.reset();
+    EXPECT_EQ(cov.count(), 0u);
+}
+
+TEST(coverage, bbtrace) {
+    char path[] = "/tmp/vcml-test-bbtrace-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+
+    const vector<basic_block> expect = {
+        { 0x80000000, 0x10, 4 },
+        { 0x80000010, 0x8, 2 },
+        { 0x80000000, 0x10, 4 },
+        { 0xffffffff80001000, 0x20, 8 },
+        { 0x400, 0x100000, 9999 },
+    };
+
+    {
+        bbtarget tgt("bbtarget_trace");
+        tgt.set_basic_block_batch(2);
+        bbtrace trace(tgt, path);
+        for (const basic_block& bb : expect)
+            tgt.notify_basic_block(bb.pc, bb.size, bb.icount);
+        tgt.flush_basic_blocks();
+        EXPECT_EQ(trace.blocks(), expect.size());
+    }
+
+    vector<basic_block> blocks;
+    ASSERT_TRUE(bbtrace::load(path, blocks));
+    ASSERT_EQ(blocks.size(), expect.size());
+    for (size_t i = 0; i < expect.size(); i++) {
+        EXPECT_EQ(blocks[i].pc, expect[i].pc) << "block " << i;
+        EXPECT_EQ(blocks[i].size, expect[i].size) << "block " << i;
+        EXPECT_EQ(blocks[i].icount, expect[i].icount) << "block " << i;
+    }
+
+    ::unlink(path);
+}
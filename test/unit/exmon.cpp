@@ -8,10 +8,7 @@
  *                                                                            *
  ******************************************************************************/
 
-#include <gtest/gtest.h>
-using namespace ::testing;
-
-#include "vcml.h"
+#include "testing.h"
 
 TEST(tlm_exmon, locking) {
     vcml::tlm_exmon mon;
@@ -114,3 +111,180 @@ TEST(tlm_exmon, dmi) {
     EXPECT_EQ(dmi.get_end_address(), -1);
     EXPECT_EQ(dmi.get_dmi_ptr(), (unsigned char*)400);
 }
+
+TEST(dmi_exmon, load_store) {
+    alignas(64) vcml::u8 mem[64] = {};
+    vcml::dmi_reservation res{};
+
+    vcml::u32 val = 0;
+    vcml::dmi_exmon::load_exclusive(res, mem, &val, sizeof(val));
+    EXPECT_TRUE(res.is_valid());
+    EXPECT_EQ(val, 0);
+
+    val = 0x11223344;
+    EXPECT_TRUE(vcml::dmi_exmon::store_exclusive(res, mem, &val, 4));
+    EXPECT_FALSE(res.is_valid());
+    EXPECT_EQ(*(vcml::u32*)mem, 0x11223344);
+
+    EXPECT_FALSE(vcml::dmi_exmon::store_exclusive(res, mem, &val, 4));
+
+    vcml::dmi_exmon::load_exclusive(res, mem, &val, sizeof(val));
+    vcml::dmi_exmon::break_reservations(mem + 8, 4);
+    EXPECT_FALSE(vcml::dmi_exmon::store_exclusive(res, mem, &val, 4));
+
+    vcml::dmi_exmon::load_exclusive(res, mem, &val, sizeof(val));
+    *(vcml::u32*)mem = 0; // plain store that bypasses the monitor
+    EXPECT_FALSE(vcml::dmi_exmon::store_exclusive(res, mem, &val, 4));
+
+    auto add3 = [](vcml::u64 v) { return v + 3; };
+    vcml::u64 old = vcml::dmi_exmon::atomic_rmw(mem + 8, 8, add3);
+    EXPECT_EQ(old, 0);
+    EXPECT_EQ(*(vcml::u64*)(mem + 8), 3);
+
+    EXPECT_FALSE(vcml::dmi_exmon::can_access(mem + 1, 4));
+    EXPECT_FALSE(vcml::dmi_exmon::can_access(mem, 3));
+    EXPECT_TRUE(vcml::dmi_exmon::can_access(mem + 4, 4));
+}
+
+class exmon_harness : public test_base
+{
+public:
+    static constexpr size_t NUM_CORES = 4;
+    static constexpr size_t NUM_ROUNDS = 1000;
+    static constexpr u64 LOCK = 0x40;
+
+    generic::bus bus;
+
+    tlm_initiator_array out;
+    tlm_target_socket in;
+
+    alignas(64) u8 mem[0x100];
+    size_t transactions;
+
+    exmon_harness(const sc_module_name& nm):
+        test_base(nm), bus("bus"), out("out"), in("in"), mem(),
+        transactions() {
+        clk_bind(*this, "clk", bus, "clk");
+        gpio_bind(*this, "rst", bus, "rst");
+
+        for (size_t cpu = 0; cpu < NUM_CORES; cpu++) {
+            out[cpu].set_cpuid(cpu);
+            bus.bind(out[cpu]);
+        }
+
+        bus.bind(in, 0, sizeof(mem) - 1);
+
+        tlm_dmi dmi;
+        dmi.set_dmi_ptr(mem);
+        dmi.set_start_address(0);
+        dmi.set_end_address(sizeof(mem) - 1);
+        dmi.allow_read_write();
+        in.map_dmi(dmi);
+    }
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        transactions++;
+        u8* ptr = mem + tx.get_address();
+        if (tx.is_read())
+            memcpy(tx.get_data_ptr(), ptr, tx.get_data_length());
+        if (tx.is_write())
+            memcpy(ptr, tx.get_data_ptr(), tx.get_data_length());
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    bool load_linked(size_t cpu, u32& val) {
+        unsigned int bytes = 0;
+        EXPECT_OK(out[cpu].readw(LOCK, val, SBI_EXCL, &bytes));
+        return bytes == sizeof(val);
+    }
+
+    bool store_conditional(size_t cpu, u32 val) {
+        unsigned int bytes = 0;
+        EXPECT_OK(out[cpu].writew(LOCK, val, SBI_EXCL, &bytes));
+        return bytes == sizeof(val);
+    }
+
+    void test_contention() {
+        // the first store to a reserved location wins, the other one fails
+        u32 val0 = ~0u, val1 = ~0u;
+        ASSERT_TRUE(load_linked(0, val0));
+        ASSERT_TRUE(load_linked(1, val1));
+        EXPECT_EQ(val0, 0u);
+        EXPECT_EQ(val1, 0u);
+        EXPECT_TRUE(store_conditional(1, 1));
+        EXPECT_FALSE(store_conditional(0, 1));
+        EXPECT_EQ(*(u32*)(mem + LOCK), 1u);
+
+        // regular writes break reservations held by other cores
+        ASSERT_TRUE(load_linked(0, val0));
+        EXPECT_OK(out[1].writew<u32>(LOCK, 0));
+        EXPECT_FALSE(store_conditional(0, 1));
+        EXPECT_EQ(*(u32*)(mem + LOCK), 0u);
+
+        // this also holds if the write does not change the value
+        ASSERT_TRUE(load_linked(0, val0));
+        EXPECT_EQ(val0, 0u);
+        EXPECT_OK(out[1].writew<u32>(LOCK, 0));
+        EXPECT_FALSE(store_conditional(0, 1));
+        EXPECT_EQ(*(u32*)(mem + LOCK), 0u);
+
+        // stores without a preceding exclusive load always fail
+        EXPECT_FALSE(store_conditional(2, 1));
+        EXPECT_EQ(*(u32*)(mem + LOCK), 0u);
+    }
+
+    size_t spinlock() {
+        // cores take turns acquiring and releasing the lock, returns the
+        // number of transactions that reached the target doing so
+        size_t counter = 0;
+        size_t start = transactions;
+        for (size_t i = 0; i < NUM_ROUNDS; i++) {
+            for (size_t cpu = 0; cpu < NUM_CORES; cpu++) {
+                u32 val = ~0u;
+                while (!load_linked(cpu, val) || val != 0 ||
+                       !store_conditional(cpu, 1)) {
+                    // spin
+                }
+
+                counter++;
+                EXPECT_OK(out[cpu].writew<u32>(LOCK, 0));
+            }
+        }
+
+        EXPECT_EQ(counter, NUM_CORES * NUM_ROUNDS);
+        EXPECT_EQ(*(u32*)(mem + LOCK), 0u);
+        return transactions - start;
+    }
+
+    void set_dmi_excl(bool allow) {
+        for (size_t cpu = 0; cpu < NUM_CORES; cpu++) {
+            out[cpu].allow_dmi_excl = allow;
+
+            // regular reads fetch dmi pointers for all cores
+            u32 val;
+            EXPECT_OK(out[cpu].readw(LOCK, val));
+            EXPECT_NE(out[cpu].lookup_dmi_ptr(LOCK, sizeof(val)), nullptr);
+        }
+    }
+
+    virtual void run_test() override {
+        // exclusive accesses directly on the dmi pointers of the cores
+        set_dmi_excl(true);
+        test_contention();
+        EXPECT_EQ(spinlock(), 0u) << "dmi exclusive access sent transactions";
+        EXPECT_TRUE(dmi_exmon::is_active());
+
+        // the transaction-level monitor needs the target for each ll/sc
+        set_dmi_excl(false);
+        test_contention();
+        EXPECT_GE(spinlock(), 2 * NUM_CORES * NUM_ROUNDS);
+    }
+};
+
+TEST(dmi_exmon, spinlock) {
+    exmon_harness test("spinlock");
+    sc_core::sc_start();
+}
@@ -119,6 +119,22 @@ public:
         EXPECT_TRUE(in[0]);
         EXPECT_TRUE(in[1]);
 
+        // raising sockets become the origin of the interrupt
+        EXPECT_EQ(in[0].origin().source, &out);
+        EXPECT_EQ(in[1].origin().source, &out);
+        EXPECT_EQ(in[0].origin().stamp, sc_time_stamp().value());
+        EXPECT_EQ(gpio_current_origin(), nullptr);
+
+        {
+            gpio_origin origin{ &out2, 42 };
+            gpio_origin_scope scope(origin);
+            EXPECT_EQ(gpio_current_origin(), &origin);
+            gpio_origin_scope invalid(gpio_origin{});
+            EXPECT_EQ(gpio_current_origin(), &origin);
+        }
+
+        EXPECT_EQ(gpio_current_origin(), nullptr);
+
         EXPECT_CALL(*this,
                     gpio_notify(gpio_s("in[0]"), false, GPIO_NO_VECTOR));
         EXPECT_CALL(*this,
@@ -141,6 +157,34 @@ public:
         EXPECT_FALSE(in[0].read(TEST_VECTOR));
         EXPECT_FALSE(in[1].read(TEST_VECTOR));
 
+        // test vectored writes
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), true, 1));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), true, 1));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), true, 100));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), true, 100));
+        out.write(true, { 1, 100, 1 });
+        EXPECT_TRUE(out.read(1));
+        EXPECT_TRUE(out.read(100));
+        EXPECT_TRUE(in[0][1]);
+        EXPECT_TRUE(in[1][100]);
+
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), true, 0));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), true, 0));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), false, 1));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), false, 1));
+        out.write_mask(0b111, 0b001, 0);
+        EXPECT_TRUE(in[0][0]);
+        EXPECT_FALSE(in[0][1]);
+        EXPECT_FALSE(in[0][2]);
+
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), false, 0));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), false, 0));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), false, 100));
+        EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), false, 100));
+        out.write(false, { 0, 100 });
+        EXPECT_FALSE(in[1][0]);
+        EXPECT_FALSE(in[1][100]);
+
         // test default events
         EXPECT_CALL(*this, gpio_notify(gpio_s("in[0]"), true, GPIO_NO_VECTOR));
         EXPECT_CALL(*this, gpio_notify(gpio_s("in[1]"), true, GPIO_NO_VECTOR));
@@ -10,6 +10,9 @@
 
 #include "testing.h"
 
+#include <unistd.h>
+#include <random>
+
 using namespace vcml;
 
 TEST(memory, alignment) {
@@ -112,3 +115,165 @@ TEST(memory, sharing_wrong_size) {
     EXPECT_DEATH({ tlm_memory b(name, size * 2); }, "unexpected size");
     EXPECT_DEATH({ tlm_memory b(name, size / 2); }, "unexpected size");
 }
+
+TEST(memory, map_file) {
+    const size_t pgsz = mwr::get_page_size();
+    const size_t size = 3 * pgsz + 100;
+
+    char path[] = "/tmp/vcml-test-map-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0) << "cannot create temporary file";
+    vector<u8> image(size);
+    for (size_t i = 0; i < size; i++)
+        image[i] = (u8)(i * 7);
+    ASSERT_EQ(::write(fd, image.data(), size), (ssize_t)size);
+    ::close(fd);
+
+    tlm_memory mem(8 * pgsz);
+    mem.fill(0xee);
+
+    EXPECT_EQ(mem.map_file(path, 1, size), 0) << "mapped unaligned offset";
+    size_t mapped = mem.map_file(path, pgsz, size);
+    EXPECT_EQ(mapped, 3 * pgsz);
+    memcpy(mem.data() + pgsz + mapped, image.data() + mapped, size - mapped);
+
+    for (size_t i = 0; i < size; i++)
+        ASSERT_EQ(mem[pgsz + i], image[i]) << "mismatch at position " << i;
+    EXPECT_EQ(mem[0], 0xee);
+    EXPECT_EQ(mem[pgsz + size], 0xee);
+
+    // writes must only be visible in memory, never in the file
+    mem[pgsz] = ~image[0];
+    ifstream file(path, std::ios::binary);
+    u8 head = 0;
+    file.read((char*)&head, 1);
+    EXPECT_EQ(head, image[0]) << "memory write reached the image file";
+
+    ::unlink(path);
+}
+
+TEST(memory, lazy_poison) {
+    const size_t pgsz = mwr::get_page_size();
+    tlm_memory mem(4 * pgsz + 8);
+
+    mem.fill(0x11);
+    mem.poison(0xaa);
+    EXPECT_TRUE(mem.has_pending());
+    EXPECT_EQ(mem[0], 0xaa);
+    EXPECT_EQ(mem[4 * pgsz + 7], 0xaa);
+
+    u32 data = 0;
+    EXPECT_OK(mem.write(pgsz, 0x12345678u));
+    EXPECT_OK(mem.read(pgsz, data));
+    EXPECT_EQ(data, 0x12345678u);
+    EXPECT_FALSE(mem.is_pending(pgsz));
+    EXPECT_EQ(mem.data()[pgsz + 4], 0xaa) << "page not poisoned on access";
+    EXPECT_TRUE(mem.is_pending(2 * pgsz));
+
+    mem.touch({ 0, mem.size() - 1 });
+    EXPECT_FALSE(mem.has_pending());
+    for (size_t i = 0; i < mem.size(); i++) {
+        if (i < pgsz || i >= pgsz + 4)
+            ASSERT_EQ(mem.data()[i], 0xaa) << "mismatch at position " << i;
+    }
+
+    mem.clear();
+    EXPECT_FALSE(mem.has_pending());
+    for (size_t i = 0; i < mem.size(); i++)
+        ASSERT_EQ(mem.data()[i], 0) << "mismatch at position " << i;
+}
+
+static size_t resident_bytes(size_t base = 0) {
+    size_t total = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr)
+        return 0;
+    if (fscanf(statm, "%zu %zu", &total, &resident) != 2)
+        resident = 0;
+    fclose(statm);
+    resident *= mwr::get_page_size();
+    return resident > base ? resident - base : 0;
+}
+
+TEST(memory, lazy_poison_release) {
+    // poisoning must give the backing pages back instead of writing them
+    const size_t pgsz = mwr::get_page_size();
+    const size_t size = 64 * pgsz;
+    tlm_memory mem(size);
+
+    size_t rss = resident_bytes();
+    mem.fill(0x55);
+    size_t rss_fill = resident_bytes(rss);
+    EXPECT_GE(rss_fill, size / 2);
+
+    mem.poison(0xaa);
+    size_t rss_poison = resident_bytes(rss);
+    EXPECT_LT(rss_poison, rss_fill);
+    for (size_t off = 0; off < size; off += pgsz)
+        EXPECT_TRUE(mem.is_pending(off)) << "page at " << off;
+
+    EXPECT_EQ(mem[size / 2], 0xaa);
+    EXPECT_EQ(mem.data()[size / 2 + 1], 0xaa);
+
+    mem.clear();
+    EXPECT_FALSE(mem.has_pending());
+    EXPECT_EQ(mem.data()[size - 1], 0);
+}
+
+// writes pseudo-random words all over the memory and reads them back, so
+// that every page gets touched at least once with its final backing store
+static void check_random_access(tlm_memory& mem, size_t accesses) {
+    const size_t nwords = mem.size() / sizeof(u64);
+    const size_t stride = mwr::get_page_size() / sizeof(u64);
+    std::mt19937_64 rng(1);
+
+    for (size_t i = 0; i < nwords; i += stride)
+        ASSERT_OK(mem.write(i * sizeof(u64), (u64)i));
+
+    for (size_t i = 0; i < accesses; i++) {
+        size_t idx = rng() % nwords;
+        ASSERT_OK(mem.write(idx * sizeof(u64), (u64)idx));
+    }
+
+    rng.seed(1);
+    for (size_t i = 0; i < accesses; i++) {
+        size_t idx = rng() % nwords;
+        u64 data = 0;
+        ASSERT_OK(mem.read(idx * sizeof(u64), data));
+        ASSERT_EQ(data, idx) << "mismatch at word " << idx;
+    }
+}
+
+TEST(memory, hugepages) {
+    // large enough to hold two huge pages, small enough for any test host
+    const size_t size = 4 * MiB;
+    const size_t accesses = 4096;
+
+    tlm_memory normal;
+    normal.set_prefault();
+    normal.init(size, VCML_ALIGN_NONE);
+    EXPECT_EQ(normal.hugepages(), tlm_memory::HUGEPAGES_NONE);
+    EXPECT_FALSE(normal.numa_bound());
+    check_random_access(normal, accesses);
+
+    // transparent huge pages may be unavailable, but never become explicit
+    tlm_memory transparent;
+    transparent.set_prefault();
+    transparent.set_hugepages(tlm_memory::HUGEPAGES_TRANSPARENT);
+    transparent.init(size, VCML_ALIGN_NONE);
+    EXPECT_NE(transparent.hugepages(), tlm_memory::HUGEPAGES_EXPLICIT);
+    check_random_access(transparent, accesses);
+
+    // explicit huge pages fall back if the host has none reserved
+    tlm_memory explicit_pages;
+    explicit_pages.set_prefault();
+    explicit_pages.set_hugepages(tlm_memory::HUGEPAGES_EXPLICIT);
+    explicit_pages.init(size, VCML_ALIGN_NONE);
+    EXPECT_GE(explicit_pages.size(), size);
+    check_random_access(explicit_pages, accesses);
+
+    tlm_memory interleaved;
+    interleaved.set_numa_interleave();
+    interleaved.init(size, VCML_ALIGN_NONE);
+    check_random_access(interleaved, accesses);
+}
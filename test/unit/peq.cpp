@@ -54,6 +54,25 @@ public:
         queue.wait(val);
         EXPECT_EQ(val, 6);
         EXPECT_EQ(sc_time_stamp(), sc_time(5.0, SC_SEC));
+
+        // cancel drops a payload from all groups, others keep their order
+        queue.notify(7, 1.0, SC_SEC);
+        queue.notify(8, 1.0, SC_SEC);
+        queue.notify(9, 1.0, SC_SEC);
+        queue.notify(7, 2.0, SC_SEC);
+        queue.notify(7, 3.0, SC_SEC);
+        queue.cancel(7);
+
+        queue.wait(val);
+        EXPECT_EQ(val, 8);
+        EXPECT_EQ(sc_time_stamp(), sc_time(6.0, SC_SEC));
+
+        // payloads already due can still be cancelled
+        queue.cancel(9);
+        queue.notify(10, 1.0, SC_SEC);
+        queue.wait(val);
+        EXPECT_EQ(val, 10);
+        EXPECT_EQ(sc_time_stamp(), sc_time(7.0, SC_SEC));
     }
 };
 
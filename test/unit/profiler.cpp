@@ -0,0 +1,77 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+using namespace ::vcml::debugging;
+
+static stackframe frame(const symbol* sym) {
+    stackframe f;
+    f.program_counter = sym ? sym->virt_addr() : 0;
+    f.frame_pointer = 0;
+    f.sym = sym;
+    return f;
+}
+
+TEST(profiler, sampling) {
+    symbol fn_main("main", SYMKIND_FUNCTION, ENDIAN_LITTLE, 64, 0x100, 0x100);
+    symbol fn_work("work", SYMKIND_FUNCTION, ENDIAN_LITTLE, 64, 0x200, 0x200);
+    symbol fn_copy("copy", SYMKIND_FUNCTION, ENDIAN_LITTLE, 64, 0x300, 0x300);
+
+    profiler prof;
+    EXPECT_EQ(prof.samples(), 0u);
+
+    // frames are passed innermost first
+    prof.sample({ frame(&fn_copy), frame(&fn_work), frame(&fn_main) }, 3);
+    prof.sample({ frame(&fn_work), frame(&fn_main) });
+    prof.sample({ frame(&fn_work), frame(&fn_work), frame(&fn_main) });
+    prof.sample({ frame(nullptr) }, 0);
+    prof.sample({});
+
+    EXPECT_EQ(prof.samples(), 5u);
+
+    auto top = prof.top(10);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0].name, "copy");
+    EXPECT_EQ(top[0].self, 3u);
+    EXPECT_EQ(top[0].total, 3u);
+    EXPECT_EQ(top[1].name, "work");
+    EXPECT_EQ(top[1].self, 2u);
+    EXPECT_EQ(top[1].total, 5u);
+    EXPECT_EQ(top[2].name, "main");
+    EXPECT_EQ(top[2].self, 0u);
+    EXPECT_EQ(top[2].total, 5u);
+
+    EXPECT_EQ(prof.top(1).size(), 1u);
+
+    stringstream ss;
+    prof.write_folded(ss);
+    string folded = ss.str();
+    EXPECT_NE(folded.find("main;work;copy 3\n"), string::npos);
+    EXPECT_NE(folded.find("main;work 1\n"), string::npos);
+    EXPECT_NE(folded.find("main;work;work 1\n"), string::npos);
+
+    prof.reset();
+    EXPECT_EQ(prof.samples(), 0u);
+    EXPECT_TRUE(prof.top(10).empty());
+}
+
+TEST(profiler, unknown) {
+    profiler prof;
+    prof.sample({ frame(nullptr) }, 2);
+
+    stringstream ss;
+    prof.write_folded(ss);
+    EXPECT_EQ(ss.str(), "[unknown] 2\n");
+
+    stringstream top;
+    prof.write_top(top, 5);
+    EXPECT_NE(top.str().find("[unknown]"), string::npos);
+    EXPECT_NE(top.str().find("100.00%"), string::npos);
+}
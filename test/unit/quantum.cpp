@@ -0,0 +1,117 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class quantum_cpu : public processor
+{
+public:
+    u64 cycles;
+    bool io_bound;
+
+    quantum_cpu(const sc_module_name& nm):
+        processor(nm, "mock"), cycles(0), io_bound(false) {
+        quantum_adaptive = true;
+        quantum_max = sc_time(8, SC_US);
+    }
+
+    virtual u64 cycle_count() const override { return cycles; }
+
+    virtual void simulate(size_t n) override {
+        if (!io_bound) {
+            cycles += n;
+            return;
+        }
+
+        // emulate a peripheral forcing us to sync halfway through
+        cycles += n / 2;
+        sync();
+        cycles += n - n / 2;
+    }
+};
+
+class quantum_test : public test_base
+{
+public:
+    quantum_cpu cpu;
+    gpio_initiator_socket irq_out;
+
+    quantum_test(const sc_module_name& nm):
+        test_base(nm), cpu("cpu"), irq_out("irq_out") {
+        tlm_global_quantum::instance().set(sc_time(1, SC_US));
+        rst.bind(cpu.rst);
+        clk.bind(cpu.clk);
+        irq_out.bind(cpu.irq[0]);
+    }
+
+    virtual void run_test() override {
+        const sc_time us(1, SC_US);
+        const quantum_stats& stats = cpu.get_quantum_stats();
+
+        // compute-bound cores should grow their quantum up to its maximum
+        wait(100 * us);
+        EXPECT_EQ(cpu.current_quantum(), 8 * us);
+        EXPECT_EQ(stats.grown, 3u);
+        EXPECT_EQ(stats.shrunk, 0u);
+        EXPECT_GT(stats.windows, 0u);
+
+        // sync-bound cores should fall back to the minimum quantum
+        cpu.io_bound = true;
+        wait(100 * us);
+        EXPECT_EQ(cpu.current_quantum(), us);
+        EXPECT_EQ(stats.shrunk, 3u);
+        EXPECT_GT(stats.syncs, 0u);
+
+        // interrupt latency targets bound the quantum
+        cpu.io_bound = false;
+        cpu.irq_latency = 4 * us;
+        wait(100 * us);
+        EXPECT_EQ(cpu.current_quantum(), 4 * us);
+
+        irq_out = true;
+        wait(10 * us);
+        irq_out = false;
+        EXPECT_LE(stats.irq_latency_max, 4 * us);
+
+        // latencies are attributed to the socket that raised the line
+        irq_histogram hist;
+        ASSERT_TRUE(cpu.get_irq_histogram(irq_out, hist));
+        EXPECT_EQ(hist.count, 1u);
+        EXPECT_EQ(hist.longest, stats.irq_latency_max);
+        EXPECT_EQ(cpu.get_irq_histogram().count, 1u);
+        EXPECT_FALSE(cpu.get_irq_histogram(cpu, hist));
+    }
+};
+
+TEST(processor, irq_histogram) {
+    irq_histogram hist;
+    hist.record(SC_ZERO_TIME);
+    hist.record(sc_time(1, SC_NS));
+    hist.record(sc_time(3, SC_NS));
+    hist.record(sc_time(1, SC_US));
+    hist.record(sc_time(1, SC_SEC) * 1e6);
+
+    EXPECT_EQ(hist.count, 5u);
+    EXPECT_EQ(hist.buckets[0], 1u);
+    EXPECT_EQ(hist.buckets[1], 1u);
+    EXPECT_EQ(hist.buckets[2], 1u);
+    EXPECT_EQ(hist.buckets[10], 1u);
+    EXPECT_EQ(hist.buckets[irq_histogram::NBUCKETS - 1], 1u);
+    EXPECT_EQ(hist.longest, sc_time(1, SC_SEC) * 1e6);
+
+    stringstream ss;
+    hist.write(ss, "test");
+    EXPECT_TRUE(starts_with(ss.str(), "test: 5 interrupts"));
+}
+
+TEST(processor, quantum) {
+    quantum_test test("test");
+    sc_core::sc_start();
+}
@@ -753,3 +753,98 @@ TEST(registers, minmaxsize) {
     EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 0);
     EXPECT_EQ(mock.test_reg, 0xaabbccdd);
 }
+
+class test_peripheral_shadow : public peripheral
+{
+public:
+    tlm_target_socket in;
+
+    reg<u32> id;
+    reg<u32> cfg;
+    reg<u32> ctrl;
+
+    void write_ctrl(u32 val) {
+        ctrl = val;
+        cfg = ~val;
+    }
+
+    test_peripheral_shadow(const sc_module_name& nm, endianess e):
+        peripheral(nm, e, 1, 10),
+        in("in"),
+        id("id", 0x0, 0x11223344),
+        cfg("cfg", 0x4, 0),
+        ctrl("ctrl", 0x8, 0) {
+        id.allow_read_only();
+        cfg.allow_read_write();
+        ctrl.allow_read_write();
+        ctrl.on_write(&test_peripheral_shadow::write_ctrl);
+        clk.stub(100 * MHz);
+        rst.stub();
+        map_shadow(range(0x0, 0x7));
+    }
+};
+
+TEST(registers, shadow) {
+    test_peripheral_shadow mock("shadow", ENDIAN_LITTLE);
+    mock.reset();
+
+    tlm_dmi dmi;
+    tlm_dmi_cache& cache = mock.in.dmi_cache();
+    EXPECT_FALSE(cache.lookup(range(0, 3), VCML_ACCESS_WRITE, dmi));
+    EXPECT_FALSE(cache.lookup(range(8, 11), VCML_ACCESS_READ, dmi));
+    EXPECT_TRUE(cache.lookup(range(0, 7), VCML_ACCESS_READ, dmi));
+    EXPECT_EQ(dmi.get_start_address(), 0u);
+    EXPECT_EQ(dmi.get_end_address(), 7u);
+
+    const u32* shadow = (const u32*)dmi.get_dmi_ptr();
+    EXPECT_EQ(shadow[0], 0x11223344u);
+    EXPECT_EQ(shadow[1], 0u);
+
+    // writes into the shadow range must update the shadow
+    u32 data = 0xf0f0f0f0;
+    tlm_generic_payload tx;
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x4, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(shadow[1], 0xf0f0f0f0u);
+
+    // reads and writes outside of the shadow range do not refresh it
+    tx_setup(tx, TLM_WRITE_COMMAND, 0x8, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(mock.cfg, 0x0f0f0f0fu);
+    EXPECT_EQ(shadow[1], 0xf0f0f0f0u);
+    tx_setup(tx, TLM_READ_COMMAND, 0x4, &data, sizeof(data));
+    EXPECT_EQ(mock.transport(tx, SBI_NONE, VCML_AS_DEFAULT), 4);
+    EXPECT_EQ(shadow[1], 0xf0f0f0f0u);
+
+    // such changes must be published manually
+    mock.update_shadows();
+    EXPECT_EQ(shadow[1], 0x0f0f0f0fu);
+}
+
+TEST(registers, shadow_big_endian) {
+    test_peripheral_shadow mock("shadow_be", ENDIAN_BIG);
+    mock.reset();
+
+    tlm_dmi dmi;
+    EXPECT_TRUE(mock.in.dmi_cache().lookup(range(0, 3), VCML_ACCESS_READ, dmi));
+    EXPECT_EQ(dmi.get_dmi_ptr()[0], 0x11);
+    EXPECT_EQ(dmi.get_dmi_ptr()[3], 0x44);
+}
+
+class test_peripheral_noshadow : public peripheral
+{
+public:
+    reg<u32> status;
+
+    test_peripheral_noshadow(const sc_module_name& nm):
+        peripheral(nm), status("status", 0x0, 0) {
+        status.allow_read_only();
+        status.on_read([]() -> u32 { return 42; });
+        map_shadow(range(0x0, 0x3));
+    }
+};
+
+TEST(registers, shadow_callbacks) {
+    EXPECT_DEATH({ test_peripheral_noshadow mock("noshadow"); },
+                 "cannot be shadowed");
+}
@@ -0,0 +1,110 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+
+static string replay_log_path(const string& name) {
+    return mkstr("%s/vcml_%s_%d.rpl", mwr::temp_dir().c_str(), name.c_str(),
+                 (int)mwr::getpid());
+}
+
+TEST(replay, channels) {
+    string path = replay_log_path("channels");
+    const u8 a[] = { 1, 2, 3 };
+    const u8 b[] = { 4 };
+
+    {
+        replay_channel ch1("ch1");
+        replay_channel ch2("ch2");
+        EXPECT_FALSE(ch1.is_active());
+        EXPECT_DEATH(replay_channel dup("ch1"), "already exists");
+
+        replay_record(path);
+        EXPECT_EQ(replay_get_mode(), REPLAY_RECORD);
+        EXPECT_TRUE(ch1.is_recording());
+        ch1.record(10, a, sizeof(a));
+        ch2.record(20, b, sizeof(b));
+        ch1.record(300, b, sizeof(b));
+        EXPECT_DEATH(ch1.record(299, a, sizeof(a)), "went backwards");
+        replay_finish();
+        EXPECT_EQ(replay_get_mode(), REPLAY_OFF);
+    }
+
+    {
+        replay_playback(path);
+        EXPECT_EQ(replay_get_mode(), REPLAY_PLAYBACK);
+
+        u64 stamp;
+        vector<u8> data;
+        replay_channel ch1("ch1");
+        replay_channel ch2("ch2");
+        replay_channel ch3("ch3");
+        EXPECT_TRUE(ch1.is_replaying());
+
+        ASSERT_TRUE(ch1.peek(stamp));
+        EXPECT_EQ(stamp, 10u);
+        ASSERT_TRUE(ch1.fetch(stamp, data));
+        EXPECT_EQ(stamp, 10u);
+        EXPECT_EQ(data, vector<u8>(a, a + sizeof(a)));
+        ASSERT_TRUE(ch1.fetch(stamp, data));
+        EXPECT_EQ(stamp, 300u);
+        EXPECT_EQ(data, vector<u8>(b, b + sizeof(b)));
+        EXPECT_FALSE(ch1.fetch(stamp, data));
+
+        ASSERT_TRUE(ch2.fetch(stamp, data));
+        EXPECT_EQ(stamp, 20u);
+        EXPECT_EQ(data, vector<u8>(b, b + sizeof(b)));
+
+        EXPECT_FALSE(ch3.peek(stamp));
+        replay_finish();
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(replay, input) {
+    string path = replay_log_path("input");
+    ui::input_event ev;
+
+    replay_record(path);
+    {
+        ui::keyboard kbd("replay_kbd");
+        kbd.notify_key(ui::KEY_A, true);
+        kbd.notify_key(ui::KEY_A, false);
+        for (int i = 0; i < 4; i++)
+            ASSERT_TRUE(kbd.pop_event(ev));
+        EXPECT_FALSE(kbd.pop_event(ev));
+    }
+    replay_finish();
+
+    replay_playback(path);
+    {
+        ui::keyboard kbd("replay_kbd");
+        kbd.notify_key(ui::KEY_B, true); // host input is ignored during replay
+
+        ASSERT_TRUE(kbd.has_events());
+        ASSERT_TRUE(kbd.pop_event(ev));
+        EXPECT_TRUE(ev.is_key());
+        EXPECT_EQ(ev.code, ui::KEY_A);
+        EXPECT_EQ(ev.state, 1);
+        ASSERT_TRUE(kbd.pop_event(ev));
+        EXPECT_TRUE(ev.is_syn());
+        ASSERT_TRUE(kbd.pop_event(ev));
+        EXPECT_EQ(ev.code, ui::KEY_A);
+        EXPECT_EQ(ev.state, 0);
+        ASSERT_TRUE(kbd.pop_event(ev));
+        EXPECT_TRUE(ev.is_syn());
+        EXPECT_FALSE(kbd.pop_event(ev));
+        EXPECT_FALSE(kbd.has_events());
+    }
+    replay_finish();
+
+    std::remove(path.c_str());
+}
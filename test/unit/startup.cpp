@@ -0,0 +1,105 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2022 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <testing.h>
+using namespace ::vcml::debugging;
+
+static const startup_entry* find_entry(const vector<startup_entry>& entries,
+                                       const string& name) {
+    for (const startup_entry& entry : entries)
+        if (entry.name == name)
+            return &entry;
+    return nullptr;
+}
+
+TEST(startup, disabled) {
+    EXPECT_FALSE(startup_profiler::enabled());
+    { startup_scope scope("nothing", "test"); }
+    EXPECT_EQ(find_entry(startup_profiler::instance().entries(), "nothing"),
+              nullptr);
+}
+
+TEST(startup, profile) {
+    startup_profiler& profiler = startup_profiler::instance();
+    profiler.enable();
+    ASSERT_TRUE(startup_profiler::enabled());
+
+    {
+        startup_scope outer("outer", "test", "details");
+        {
+            startup_scope inner("inner", "test");
+            mwr::usleep(2000);
+        }
+
+        mwr::usleep(1000);
+        outer.rename("renamed");
+    }
+
+    profiler.checkpoint("first", "callback");
+    mwr::usleep(1000);
+    profiler.checkpoint("second", "callback");
+    { startup_scope nested("nested", "test"); }
+
+    vcml::model empty("empty", "empty");
+
+    std::thread([&profiler]() {
+        double start = mwr::timestamp();
+        mwr::usleep(1000);
+        profiler.record("worker", "background", start);
+    }).join();
+
+    profiler.finish();
+    EXPECT_FALSE(startup_profiler::enabled());
+
+    vector<startup_entry> entries = profiler.entries();
+    const startup_entry* outer = find_entry(entries, "renamed");
+    const startup_entry* inner = find_entry(entries, "inner");
+    ASSERT_NE(outer, nullptr);
+    ASSERT_NE(inner, nullptr);
+    EXPECT_EQ(outer->detail, "details");
+    EXPECT_GE(inner->total, 0.002);
+    EXPECT_GE(outer->total, inner->total + 0.001);
+    EXPECT_DOUBLE_EQ(outer->self, outer->total - inner->total);
+    EXPECT_DOUBLE_EQ(inner->self, inner->total);
+
+    const startup_entry* first = find_entry(entries, "first");
+    const startup_entry* second = find_entry(entries, "second");
+    const startup_entry* nested = find_entry(entries, "nested");
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_NE(nested, nullptr);
+    EXPECT_GE(first->total, 0.001);
+    EXPECT_LE(first->start + first->total, second->start);
+    EXPECT_GE(second->total, nested->total);
+
+    const startup_entry* model = find_entry(entries, "empty");
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model->phase, "construct");
+    EXPECT_EQ(model->detail, "empty");
+
+    const startup_entry* worker = find_entry(entries, "worker");
+    ASSERT_NE(worker, nullptr);
+    EXPECT_TRUE(worker->background);
+    EXPECT_FALSE(model->background);
+    EXPECT_GE(worker->total, 0.001);
+    EXPECT_DOUBLE_EQ(worker->self, worker->total);
+
+    stringstream report;
+    profiler.write_report(report, 3);
+    EXPECT_TRUE(starts_with(report.str(), "startup profile"));
+    EXPECT_NE(report.str().find("inner"), string::npos);
+    EXPECT_EQ(report.str().find("ms  background"), string::npos);
+
+    stringstream trace;
+    profiler.write_trace(trace);
+    EXPECT_TRUE(starts_with(trace.str(), "{\"traceEvents\":["));
+    EXPECT_NE(trace.str().find("\"name\":\"renamed\""), string::npos);
+    EXPECT_NE(trace.str().find("\"cat\":\"construct\""), string::npos);
+}
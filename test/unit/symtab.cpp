@@ -210,3 +210,55 @@ TEST(symtab, find_with_offset) {
         }
     }
 }
+
+TEST(symtab, shared_elf) {
+    string path = get_resource_path("elf.elf");
+    shared_ptr<symfile> file = symfile::open(path);
+    EXPECT_EQ(symfile::open(path), file);
+
+    symtab eager;
+    eager.insert({ "local", SYMKIND_FUNCTION, ENDIAN_LITTLE, 4, ~7ull, 0 });
+    EXPECT_GT(eager.load_elf(path), 0);
+    EXPECT_TRUE(file->is_ready());
+
+    symtab a, b;
+    a.load_elf_async(path);
+    b.load_elf_async(path);
+    EXPECT_EQ(a.count_functions(), file->functions().size());
+    EXPECT_EQ(a.count_objects(), file->objects().size());
+    EXPECT_EQ(eager.count(), a.count() + 1);
+
+    const symbol* func = a.find_function("func_c");
+    ASSERT_NE(func, nullptr);
+    EXPECT_EQ(b.find_function("func_c"), func);
+    EXPECT_EQ(eager.find_function("func_c"), func);
+    EXPECT_EQ(a.find_function(func->virt_addr() + 1), func);
+    EXPECT_EQ(a.find_object("func_c"), nullptr);
+    EXPECT_STREQ(eager.find_function(~5ull)->name(), "local");
+
+    const symbol* obj = b.find_symbol("global_b");
+    ASSERT_NE(obj, nullptr);
+    EXPECT_TRUE(obj->is_object());
+    EXPECT_EQ(b.find_object(obj->virt_addr() + obj->size() - 1), obj);
+
+    for (const symbol& sym : a.functions()) {
+        const symbol* found = file->find_function(sym.virt_addr());
+        EXPECT_EQ(a.find_function(sym.virt_addr()), found);
+    }
+
+    a.clear();
+    EXPECT_TRUE(a.empty());
+    EXPECT_FALSE(b.empty());
+}
+
+TEST(symtab, broken_elf) {
+    string path = get_resource_path("elf.c");
+    symtab syms;
+    syms.load_elf_async(path);
+
+    shared_ptr<symfile> file = symfile::open(path);
+    EXPECT_FALSE(file->error().empty());
+    EXPECT_EQ(file->count(), 0u);
+    EXPECT_TRUE(syms.empty());
+    EXPECT_EQ(syms.find_function("func_c"), nullptr);
+}
@@ -0,0 +1,169 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <random>
+#include "testing.h"
+
+struct wheel_entry : timewheel::node {
+    size_t id;
+};
+
+TEST(timewheel, basic) {
+    timewheel wheel;
+    wheel_entry a, b, c;
+    a.id = 1;
+    b.id = 2;
+    c.id = 3;
+
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.next_timeout(), ~0ull);
+
+    wheel.insert(&a, 100);
+    wheel.insert(&b, 5);
+    wheel.insert(&c, 1ull << 40);
+    EXPECT_EQ(wheel.count(), 3);
+    EXPECT_TRUE(a.is_scheduled());
+    EXPECT_EQ(wheel.next_timeout(), 5);
+
+    vector<timewheel::node*> expired;
+    wheel.advance(4, expired);
+    EXPECT_TRUE(expired.empty());
+    EXPECT_EQ(wheel.now(), 4);
+
+    wheel.advance(100, expired);
+    ASSERT_EQ(expired.size(), 2);
+    EXPECT_EQ(expired[0], &b);
+    EXPECT_EQ(expired[1], &a);
+    EXPECT_FALSE(a.is_scheduled());
+    EXPECT_EQ(wheel.next_timeout(), 1ull << 40);
+
+    wheel.remove(&c);
+    EXPECT_FALSE(c.is_scheduled());
+    EXPECT_TRUE(wheel.empty());
+
+    // timeouts in the past are clamped to the current time
+    wheel.insert(&a, 50);
+    EXPECT_EQ(a.timeout, 100);
+    EXPECT_EQ(wheel.next_timeout(), 100);
+}
+
+TEST(timewheel, random) {
+    const size_t n = 10000;
+    timewheel wheel;
+    vector<wheel_entry> entries(n);
+    std::multimap<u64, size_t> reference;
+    std::mt19937_64 rng(42);
+
+    for (size_t i = 0; i < n; i++) {
+        u64 timeout = rng() % (1ull << (rng() % 48));
+        entries[i].id = i;
+        wheel.insert(&entries[i], timeout);
+        reference.emplace(timeout, i);
+    }
+
+    // cancel every fifth entry
+    for (size_t i = 0; i < n; i += 5) {
+        wheel.remove(&entries[i]);
+        auto range = reference.equal_range(entries[i].timeout);
+        for (auto it = range.first; it != range.second; it++) {
+            if (it->second == i) {
+                reference.erase(it);
+                break;
+            }
+        }
+    }
+
+    EXPECT_EQ(wheel.count(), reference.size());
+
+    u64 now = 0;
+    while (!reference.empty()) {
+        ASSERT_EQ(wheel.next_timeout(), reference.begin()->first);
+        now += rng() % (1ull << (rng() % 40));
+
+        vector<timewheel::node*> expired;
+        wheel.advance(now, expired);
+
+        u64 last = 0;
+        for (auto* node : expired) {
+            auto* entry = static_cast<wheel_entry*>(node);
+            EXPECT_LE(entry->timeout, now);
+            EXPECT_GE(entry->timeout, last);
+            last = entry->timeout;
+
+            auto range = reference.equal_range(entry->timeout);
+            auto it = std::find_if(range.first, range.second, [&](auto& e) {
+                return e.second == entry->id;
+            });
+
+            ASSERT_NE(it, range.second) << "unexpected entry " << entry->id;
+            reference.erase(it);
+        }
+
+        if (!reference.empty())
+            EXPECT_GT(reference.begin()->first, now);
+    }
+
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(timewheel, ordering) {
+    const size_t n = 10000;
+    const u64 range = 1000000;
+    std::mt19937_64 rng(1);
+
+    timewheel wheel;
+    vector<wheel_entry> entries(n);
+    std::multimap<u64, size_t> reference;
+    for (size_t i = 0; i < n; i++) {
+        entries[i].id = i;
+        wheel.insert(&entries[i], rng() % range);
+        reference.emplace(entries[i].timeout, i);
+    }
+
+    // rescheduling moves entries instead of adding them a second time
+    for (size_t i = 1; i < n; i += 4) {
+        auto it = reference.equal_range(entries[i].timeout).first;
+        while (it->second != i)
+            it++;
+        reference.erase(it);
+        wheel.insert(&entries[i], rng() % range);
+        reference.emplace(entries[i].timeout, i);
+    }
+
+    for (size_t i = 0; i < n; i += 2) {
+        auto it = reference.equal_range(entries[i].timeout).first;
+        while (it->second != i)
+            it++;
+        reference.erase(it);
+        wheel.remove(&entries[i]);
+    }
+
+    ASSERT_EQ(wheel.count(), n / 2);
+
+    // expiring in coarse steps must yield the same order as the multimap,
+    // except for entries that share a timeout
+    vector<timewheel::node*> expired;
+    for (u64 now = 0; !wheel.empty(); now += range / 1000) {
+        size_t first = expired.size();
+        wheel.advance(now, expired);
+        for (size_t i = first; i < expired.size(); i++)
+            EXPECT_LE(expired[i]->timeout, now);
+        EXPECT_GT(wheel.next_timeout(), now);
+    }
+
+    ASSERT_EQ(expired.size(), reference.size());
+    auto it = reference.begin();
+    for (size_t i = 0; i < expired.size(); i++, it++) {
+        auto* entry = static_cast<wheel_entry*>(expired[i]);
+        EXPECT_EQ(entry->timeout, it->first) << "at position " << i;
+        EXPECT_EQ(entry->id % 2, 1u) << "cancelled entry " << entry->id;
+        EXPECT_FALSE(entry->is_scheduled());
+    }
+}
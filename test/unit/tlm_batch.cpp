@@ -0,0 +1,144 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 MachineWare GmbH                                        *
+ * All Rights Reserved                                                        *
+ *                                                                            *
+ * This is work is licensed under the terms described in the LICENSE file     *
+ * found in the root directory of this source tree.                           *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "testing.h"
+
+class tlm_batch_harness : public test_base
+{
+public:
+    tlm_initiator_socket out;
+    tlm_target_socket in;
+
+    alignas(8) u8 mem[0x100];
+    vector<range> transactions;
+
+    tlm_batch_harness(const sc_module_name& nm):
+        test_base(nm), out("out"), in("in"), mem(), transactions() {
+        out.bind(in);
+    }
+
+    virtual unsigned int transport(tlm_target_socket& socket,
+                                   tlm_generic_payload& tx,
+                                   const tlm_sbi& sideband) override {
+        transactions.push_back(tx);
+        if (tx.get_address() + tx.get_data_length() > sizeof(mem)) {
+            tx.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
+            return 0;
+        }
+
+        u8* ptr = mem + tx.get_address();
+        if (tx.is_read())
+            memcpy(tx.get_data_ptr(), ptr, tx.get_data_length());
+        if (tx.is_write())
+            memcpy(ptr, tx.get_data_ptr(), tx.get_data_length());
+
+        tx.set_response_status(TLM_OK_RESPONSE);
+        return tx.get_data_length();
+    }
+
+    virtual void run_test() override {
+        u32 buf[4] = { 1, 2, 3, 4 };
+        u32 other = 5;
+
+        // contiguous operations are packed into a single transaction
+        vector<tlm_batch_op> ops = {
+            { TLM_WRITE_COMMAND, 0x10, buf + 0, 4 },
+            { TLM_WRITE_COMMAND, 0x14, buf + 1, 4 },
+            { TLM_WRITE_COMMAND, 0x18, buf + 2, 8 },
+            { TLM_WRITE_COMMAND, 0x40, &other, 4 },
+            { TLM_WRITE_COMMAND, 0xfe, &other, 4 },
+        };
+
+        EXPECT_AE(out.access_batch(ops));
+        ASSERT_EQ(transactions.size(), 3u);
+        EXPECT_EQ(transactions[0], range(0x10, 0x1f));
+        EXPECT_EQ(transactions[1], range(0x40, 0x43));
+        EXPECT_EQ(transactions[2], range(0xfe, 0x101));
+        for (size_t i = 0; i < 4; i++) {
+            EXPECT_OK(ops[i].resp);
+            EXPECT_EQ(ops[i].bytes, ops[i].size);
+        }
+
+        EXPECT_AE(ops[4].resp);
+        EXPECT_EQ(ops[4].bytes, 0u);
+        EXPECT_EQ(memcmp(mem + 0x10, buf, sizeof(buf)), 0);
+
+        // dmi backed operations use memcpy and annotate their latency once
+        tlm_dmi dmi;
+        dmi.set_dmi_ptr(mem);
+        dmi.set_start_address(0);
+        dmi.set_end_address(sizeof(mem) - 1);
+        dmi.allow_read_write();
+        dmi.set_read_latency(sc_time(10, SC_NS));
+        out.map_dmi(dmi);
+
+        transactions.clear();
+        u32 data[4] = {};
+        ops = {
+            { TLM_READ_COMMAND, 0x10, data + 0, 8 },
+            { TLM_READ_COMMAND, 0x40, data + 2, 4 },
+            { TLM_READ_COMMAND, 0x14, data + 3, 4 },
+        };
+
+        sc_time before = local_time();
+        EXPECT_OK(out.access_batch(ops));
+        EXPECT_TRUE(transactions.empty());
+        EXPECT_EQ(local_time() - before, sc_time(30, SC_NS));
+        EXPECT_EQ(data[0], 1u);
+        EXPECT_EQ(data[1], 2u);
+        EXPECT_EQ(data[2], 5u);
+        EXPECT_EQ(data[3], 2u);
+        for (const tlm_batch_op& op : ops)
+            EXPECT_EQ(op.bytes, op.size);
+
+        // dmi backed writes break exclusive reservations of other cores,
+        // even if they leave the reserved value unchanged
+        u32 val = ~0u;
+        dmi_reservation res{};
+        dmi_exmon::load_exclusive(res, mem + 0x20, &val, sizeof(val));
+        EXPECT_EQ(val, 0u);
+
+        transactions.clear();
+        u32 wdata[2] = { 0, 8 };
+        ops = {
+            { TLM_WRITE_COMMAND, 0x20, wdata + 0, 4 },
+            { TLM_WRITE_COMMAND, 0x24, wdata + 1, 4 },
+        };
+
+        EXPECT_OK(out.access_batch(ops));
+        EXPECT_TRUE(transactions.empty());
+        EXPECT_EQ(memcmp(mem + 0x20, wdata, sizeof(wdata)), 0);
+        for (const tlm_batch_op& op : ops)
+            EXPECT_EQ(op.bytes, op.size);
+
+        val = 1;
+        EXPECT_FALSE(dmi_exmon::store_exclusive(res, mem + 0x20, &val, 4));
+        EXPECT_EQ(mem[0x20], 0u);
+
+        // operations outside of dmi fall back to transactions
+        ops = {
+            { TLM_READ_COMMAND, 0x40, data + 0, 4 },
+            { TLM_READ_COMMAND, 0xfc, data + 1, 8 },
+        };
+
+        EXPECT_AE(out.access_batch(ops));
+        EXPECT_OK(ops[0].resp);
+        EXPECT_AE(ops[1].resp);
+        ASSERT_EQ(transactions.size(), 1u);
+        EXPECT_EQ(transactions[0], range(0xfc, 0x103));
+
+        EXPECT_DEATH(out.access_batch(ops, SBI_EXCL), "cannot be batched");
+    }
+};
+
+TEST(tlm, batch) {
+    tlm_batch_harness test("batch");
+    sc_core::sc_start();
+}